@@ -0,0 +1,204 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "car.h"
+#include "trackmap.h"
+#include "workerpool.h"
+
+namespace
+{
+    // Ray marching in 1 pixel steps, as before the distance transform.
+    double distanceToEdgePixelSteps(const TrackMap& map, const Eigen::Vector2d &pos, const Eigen::Vector2d &direction)
+    {
+        Eigen::Vector2d d = direction.normalized();
+        Eigen::Vector2d end = pos;
+        while( map.isPositionValid(end) > 0 )
+            end = end + d;
+
+        return (end-pos).norm();
+    }
+
+    // Ring shaped track with a few pillars.
+    Eigen::MatrixXi createRingTrack()
+    {
+        Eigen::MatrixXi map(600,800);
+        map.fill(0);
+        for( int m = 0; m < map.rows(); m++ )
+        {
+            for( int n = 0; n < map.cols(); n++ )
+            {
+                const double dx = (n - 400) / 380.0;
+                const double dy = (m - 300) / 280.0;
+                const double r = std::sqrt(dx*dx + dy*dy);
+                if( r < 1.0 && r > 0.55 && ( (m / 40 + n / 40) % 7 != 0 ) )
+                    map(m,n) = 1;
+            }
+        }
+        return map;
+    }
+
+    // Random start positions on the track and random directions.
+    void createRays(const TrackMap& map, const size_t& nbrOfRays, const unsigned int& seed,
+                    std::vector<Eigen::Vector2d>& positions, std::vector<Eigen::Vector2d>& directions)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> px(0, map.getMap().cols() - 1), py(0, map.getMap().rows() - 1), ang(0, 2*M_PI);
+        positions.clear();
+        directions.clear();
+        while( positions.size() < nbrOfRays )
+        {
+            Eigen::Vector2d p(px(gen), py(gen));
+            if( map.isPositionValid(p) > 0 )
+            {
+                const double a = ang(gen);
+                positions.push_back(p);
+                directions.push_back(Eigen::Vector2d(std::cos(a), std::sin(a)));
+            }
+        }
+    }
+}
+
+// Ray casting on a track: marching in 1 pixel steps compared to sphere tracing
+// with the step lengths of the distance transform.
+TEST(TrackMapBenchmark, PixelStepsVsSphereTracing)
+{
+    std::shared_ptr<TrackMap> tmap( new TrackMap(createRingTrack()) );
+    Car car;
+    car.setMap(tmap);
+
+    std::vector<Eigen::Vector2d> positions, directions;
+    createRays(*tmap, 20000, 1, positions, directions);
+
+    double checksum = 0.0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( size_t k = 0; k < positions.size(); k++ )
+        checksum += distanceToEdgePixelSteps(*tmap, positions[k], directions[k]);
+    const double tPixelSteps = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    start = std::chrono::steady_clock::now();
+    for( size_t k = 0; k < positions.size(); k++ )
+        checksum -= car.distanceToEdge(positions[k], directions[k]);
+    const double tSphereTracing = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    std::cout << "pixel steps: " << positions.size() / tPixelSteps << " rays/s" << std::endl;
+    std::cout << "sphere tracing: " << positions.size() / tSphereTracing << " rays/s (" << tPixelSteps / tSphereTracing << "x)" << std::endl;
+
+    // keeps the results alive, each ray differs by less than a step
+    ASSERT_LT( std::abs(checksum), double(positions.size()) );
+}
+
+// Distance transform of a 4K track, computed in the calling thread and on a worker pool.
+TEST(TrackMapBenchmark, LargeMapDistanceTransform)
+{
+    Eigen::MatrixXi map(2160, 3840);
+    map.fill(1);
+    for( int m = 0; m < map.rows(); m += 97 )
+        map.row(m).segment(m % 500, 2000).setZero();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Eigen::MatrixXf single = TrackMap::computeEuclideanDistanceTransform(map);
+    const double tSingle = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+    WorkerPool pool(4);
+    start = std::chrono::steady_clock::now();
+    Eigen::MatrixXf parallel = TrackMap::computeEuclideanDistanceTransform(map, &pool);
+    const double tParallel = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+    std::cout << "4K distance transform: " << tSingle << " ms (1 thread), " << tParallel << " ms (4 threads)" << std::endl;
+
+    ASSERT_TRUE( single == parallel );
+}
+
+// Moving obstacle on a 1920x1080 track: rebuilding the whole dynamic map per frame
+// compared to moving a dynamic obstacle, which updates the dirty tiles only.
+TEST(TrackMapBenchmark, DynamicMapVsDynamicObstacle)
+{
+    Eigen::MatrixXi map(1080, 1920);
+    map.fill(1);
+    map.topRows(100).setZero();
+    map.bottomRows(100).setZero();
+
+    TrackMap tmap(map);
+
+    const int frames = 20;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( int k = 0; k < frames; k++ )
+    {
+        Eigen::MatrixXi dyn = tmap.createAllValidMap();
+        dyn.block(300 + k, 650, 100, 30).setZero();
+        tmap.setDynamicMap(dyn);
+    }
+    const double tFull = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    tmap.clearDynamicMap();
+
+    const size_t id = tmap.addDynamicRect(300, 650, 100, 30);
+    start = std::chrono::steady_clock::now();
+    for( int k = 0; k < frames; k++ )
+        ASSERT_TRUE( tmap.moveDynamicObstacle(id, 300 + k, 650) );
+    const double tDirty = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    std::cout << "dynamic map: " << tFull / frames * 1000.0 << " ms per frame" << std::endl;
+    std::cout << "dynamic obstacle: " << tDirty / frames * 1000.0 << " ms per frame (" << tFull / tDirty << "x)" << std::endl;
+}
+
+// Sensor rays of a car: one distanceToEdge call per ray, which casts a single
+// ray, compared to castRays marching all 7 rays of a car position in lanes.
+TEST(TrackMapBenchmark, DistanceToEdgeVsCastRays)
+{
+    std::shared_ptr<TrackMap> tmap( new TrackMap(createRingTrack()) );
+    Car car;
+    car.setMap(tmap);
+
+    std::vector<Eigen::Vector2d> starts, dirs;
+    createRays(*tmap, 7 * 3000, 2, starts, dirs);
+
+    const long nbrOfRays = long( starts.size() );
+    Eigen::Matrix2Xd positions(2, nbrOfRays), directions(2, nbrOfRays);
+    for( long k = 0; k < nbrOfRays; k++ )
+    {
+        positions.col(k) = starts[size_t(k / 7 * 7)]; // 7 rays per position
+        directions.col(k) = dirs[size_t(k)];
+    }
+
+    Eigen::VectorXd single(nbrOfRays), batched(nbrOfRays);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( long r = 0; r < nbrOfRays; r++ )
+        single(r) = car.distanceToEdge(positions.col(r), directions.col(r));
+    const double tSingle = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    start = std::chrono::steady_clock::now();
+    for( long r = 0; r < nbrOfRays; r += 7 )
+        tmap->castRays(positions.middleCols(r, 7), directions.middleCols(r, 7), batched.segment(r, 7));
+    const double tBatched = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    std::cout << "distanceToEdge: " << nbrOfRays / tSingle << " rays/s" << std::endl;
+    std::cout << "castRays, 7 lanes: " << nbrOfRays / tBatched << " rays/s (" << tSingle / tBatched << "x)" << std::endl;
+
+    ASSERT_TRUE( single.isApprox(batched, 1e-9) );
+}
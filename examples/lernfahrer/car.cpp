@@ -7,20 +7,20 @@
 #include <Eigen/Geometry>
 
 Car::Car(): m_rotationToOriginal(0.0), m_mapSet(false), m_droveDistance(0.0),
-    m_formerDistance(0.0), m_accumulatedRotation(0.0), m_carSize{4}
+    m_formerDistance(0.0), m_accumulatedRotation(0.0), m_lastSuicideCheck(0.0), m_carSize{4}
 {
     setSpeed( 0.0 );
     setPosition( Eigen::Vector2d(0.0, 0.0));
     setAcceleration(0.0);
     setDirection(Eigen::Vector2d(1.0, 0.0));
     setRotationSpeed(0.0);
+    m_nextSpeed = 0.0;
+    m_nextPosition = Eigen::Vector2d(0.0, 0.0);
 
     setMeasureAngles( {-80, -50.0, -15.0, 0.0, 15.0, 50.0, 80} );
 
     std::vector<unsigned int> map = {8,4,2};
     m_network = NetworkPtr( new Network(map) );
-
-    m_killer.start();
 }
 
 Car::~Car()
@@ -70,7 +70,12 @@ void Car::setDirection(const Eigen::Vector2d &direction)
     m_rotationToOriginal = computeAngleBetweenVectors(Eigen::Vector2d(1.0,0.0), m_direction);
 }
 
-void Car::update()
+bool Car::supportsSenseAct() const
+{
+    return true;
+}
+
+void Car::sense( Eigen::Ref<NNMatrix> input )
 {
     double animTime = getTimeSinceLastUpdate();
 
@@ -78,7 +83,6 @@ void Car::update()
     double thisRotation =  m_rotationSpeedRad * animTime;
     Eigen::Rotation2D<double> r( thisRotation );
     m_direction = r.toRotationMatrix() * m_direction;
-    Eigen::Vector2d(1.0,0.0);
     m_rotationToOriginal = computeAngleBetweenVectors(Eigen::Vector2d(1.0,0.0), m_direction);
 
     // adjust speed
@@ -95,12 +99,43 @@ void Car::update()
     m_accumulatedRotation += std::abs(thisRotation);
 
     // important: measure distances before navigate and post move collision
-    m_measuredDistances = measureDistances();
-    navigate();
+    measureDistances();
+
+    // decide what to do next
+    const long nbrOfDistances = m_measuredDistances.rows();
+    input.topRows( nbrOfDistances ) = m_measuredDistances.col(0).cast<NNScalar>();
+    input( nbrOfDistances, 0 ) = m_speed; // additional input for speed
+
+    // normalize input -> all values are positive -> scale them on a range -1 to +1
+    const NNScalar maxValInput = input.maxCoeff();
+    input = (input * (NNScalar(2.0)/maxValInput)).array() - NNScalar(1.0);
+
+    // applied in actuate, after navigating
+    m_nextSpeed = newSpeed;
+    m_nextPosition = newPosition;
+}
+
+void Car::actuate( const Eigen::Ref<const NNMatrix>& nnOut )
+{
+    double maxRotationSpeed = 720.0;
+    double maxAcceleration = 100.0;
+
+    // scale output from 0 - 1 to -1 to +1
+    double speedActivation = (nnOut(0,0) - 0.5) * 2;
+    double rotationActivation = (nnOut(1,0) - 0.5) * 2;
+    setAcceleration(maxAcceleration*speedActivation);
+    setRotationSpeed(maxRotationSpeed*rotationActivation);
+
+    // simulation time -> works with a fixed time step too
+    if( getAge() - m_lastSuicideCheck > 1.0 )
+    {
+        considerSuicide();
+        m_lastSuicideCheck = getAge();
+    }
 
     // update
-    m_speed = newSpeed;
-    m_position = newPosition;
+    m_speed = m_nextSpeed;
+    m_position = m_nextPosition;
 }
 
 double Car::getFitness()
@@ -188,19 +223,10 @@ double Car::distanceToEdge(const Eigen::Vector2d &pos, const Eigen::Vector2d &di
         return 0.0;
 
     Eigen::Vector2d d = direction.normalized();
-    Eigen::Vector2d end = pos;
-
-    bool goOn = true;
-
-    int minDistToEdge = m_map->isPositionValid(end);
-
-    while(minDistToEdge  > 0)
-    {
-        end = end + (d * minDistToEdge);
-        minDistToEdge = m_map->isPositionValid(end);
-    }
+    Eigen::Matrix<double, 1, 1> dist;
+    m_map->castRays(pos, d, dist);
 
-    return (end-pos).norm();
+    return dist(0);
 }
 
 const std::vector<double> &Car::getMeasureAngles() const
@@ -211,30 +237,42 @@ const std::vector<double> &Car::getMeasureAngles() const
 void Car::setMeasureAngles(const std::vector<double> &measureAngles)
 {
     m_measureAngles = measureAngles;
-}
 
-Eigen::MatrixXd Car::measureDistances() const
-{
-    // distance, xP, yP
-    Eigen::MatrixXd angs( m_measureAngles.size(), 3);
-    for( size_t k = 0; k < m_measureAngles.size(); k++ )
+    const long nbrOfAngles = long( m_measureAngles.size() );
+    m_measureCosSin.resize( 2, nbrOfAngles );
+    for( long k = 0; k < nbrOfAngles; k++ )
     {
-        double aRad = -(M_PI / 180.0 * m_measureAngles[k]);
-        Eigen::Rotation2D<double> r( aRad );
-        Eigen::Vector2d measureDir = r.toRotationMatrix() * m_direction;
+        double aRad = -(M_PI / 180.0 * m_measureAngles[size_t(k)]);
+        m_measureCosSin(0,k) = std::cos(aRad);
+        m_measureCosSin(1,k) = std::sin(aRad);
+    }
 
-        double dist = distanceToEdge(getPosition(),measureDir);
+    m_rayPositions.resize( 2, nbrOfAngles );
+    m_rayDirections.resize( 2, nbrOfAngles );
+    m_rayDistances.resize( nbrOfAngles );
+}
 
-        Eigen::Vector2d edgePos = getPosition() + measureDir * dist;
-        angs(k,0) = dist;
-        angs(k,1) = edgePos(0);
-        angs(k,2) = edgePos(1);
-    }
+void Car::measureDistances()
+{
+    // rotate the direction by each measure angle -> all rays are cast at once
+    const Eigen::Index nbrOfAngles = m_measureCosSin.cols();
+    m_rayPositions.colwise() = getPosition();
+    m_rayDirections.row(0) = m_measureCosSin.row(0) * m_direction(0) - m_measureCosSin.row(1) * m_direction(1);
+    m_rayDirections.row(1) = m_measureCosSin.row(1) * m_direction(0) + m_measureCosSin.row(0) * m_direction(1);
+    m_rayDirections.colwise().normalize();
+
+    if( m_mapSet )
+        m_map->castRays( m_rayPositions, m_rayDirections, m_rayDistances );
+    else
+        m_rayDistances.setZero();
 
-    return angs;
+    // distance, xP, yP -> no allocation once sized
+    m_measuredDistances.resize( nbrOfAngles, 3 );
+    m_measuredDistances.col(0) = m_rayDistances;
+    m_measuredDistances.rightCols(2) = ( m_rayPositions + m_rayDirections * m_rayDistances.asDiagonal() ).transpose();
 }
 
-Eigen::MatrixXd Car::getMeasuredDistances() const
+const Eigen::MatrixXd& Car::getMeasuredDistances() const
 {
     return m_measuredDistances;
 }
@@ -255,33 +293,3 @@ void Car::considerSuicide()
         m_alive = false;
     }
 }
-
-void Car::navigate()
-{
-    // decide what to do next
-    Eigen::MatrixXd nnInput = m_measuredDistances.col(0);
-    nnInput.conservativeResize(m_measuredDistances.rows()+1, 1); // additional input for speed
-    nnInput(nnInput.rows()-1,0) = m_speed;
-
-    // normalize input -> all values are positive -> scale them on a range -1 to +1
-    double maxValInput = nnInput.maxCoeff();
-    nnInput = (nnInput * 2.0/maxValInput).array() - 1.0;
-
-    m_network->feedForward(nnInput);
-    Eigen::MatrixXd nnOut = m_network->getOutputActivation();
-
-    double maxRotationSpeed = 720.0;
-    double maxAcceleration = 100.0;
-
-    // scale output from 0 - 1 to -1 to +1
-    double speedActivation = (nnOut(0,0) - 0.5) * 2;
-    double rotationActivation = (nnOut(1,0) - 0.5) * 2;
-    setAcceleration(maxAcceleration*speedActivation);
-    setRotationSpeed(maxRotationSpeed*rotationActivation);
-
-    if( m_killer.elapsed() > 1000 )
-    {
-        considerSuicide();
-        m_killer.restart();
-    }
-}
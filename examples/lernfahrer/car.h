@@ -4,7 +4,6 @@
 #include "simulation.h"
 #include "trackmap.h"
 
-#include <QTime>
 #include <Eigen/Dense>
 #include <chrono>
 
@@ -58,16 +57,28 @@ public:
 
     void setMeasureAngles(const std::vector<double>& measureAngles);
 
-    Eigen::MatrixXd getMeasuredDistances() const;
+    /**
+     * Measured distances of the last step, one row per measure angle:
+     * distance, x and y of the edge position.
+     */
+    const Eigen::MatrixXd& getMeasuredDistances() const;
+
+    bool supportsSenseAct() const override;
+
+    /**
+     * Moves the car and measures the distances to the track edges, which
+     * are the network input.
+     * @param input Normalized distances and speed.
+     */
+    void sense( Eigen::Ref<NNMatrix> input ) override;
 
 
 private:
-    void update() override;
+    void actuate( const Eigen::Ref<const NNMatrix>& output ) override;
     Eigen::Vector2d handleCollision(const Eigen::Vector2d& from, const Eigen::Vector2d& to);
     void handlePostMoveCollision();
-    Eigen::MatrixXd measureDistances() const;
+    void measureDistances();
     void considerSuicide();
-    void navigate();
 
 
 private:
@@ -75,6 +86,8 @@ private:
     Eigen::Vector2d m_position;
     double m_acceleration;
     double m_speed;
+    double m_nextSpeed;
+    Eigen::Vector2d m_nextPosition;
     double m_rotationSpeed;
     double m_rotationSpeedRad;
     double m_rotationToOriginal;
@@ -83,12 +96,16 @@ private:
     bool m_mapSet;
 
     std::vector<double> m_measureAngles;
+    Eigen::Matrix2Xd m_measureCosSin;   // cos and sin of each measure angle
+    Eigen::Matrix2Xd m_rayPositions;    // buffers of the sensor rays
+    Eigen::Matrix2Xd m_rayDirections;
+    Eigen::VectorXd m_rayDistances;
     Eigen::MatrixXd m_measuredDistances;
 
     double m_droveDistance;
     double m_accumulatedRotation;
 
-    QTime m_killer;
+    double m_lastSuicideCheck; // age in seconds
     double m_formerDistance;
 
     double m_carSize;
@@ -41,6 +41,22 @@ SimulationPtr CarFactory::createCrossover(SimulationPtr a, SimulationPtr b, doub
     return crs;
 }
 
+SimulationPtr CarFactory::createFromGenome( Population& population, const size_t& idx )
+{
+    for( size_t l = 1; l <= population.getNumberOfLayers(); l++ )
+        population.biases(l).row(idx).setZero();
+
+    SimulationPtr crs = createRandomSimulation();
+    crs->setNetwork(population.createNetwork(idx));
+    return crs;
+}
+
+bool CarFactory::isThreadSafe() const
+{
+    // cars only share the read-only map
+    return true;
+}
+
 void CarFactory::setAllBiasToZero(NetworkPtr net)
 {
     for( unsigned int i = 0; i < net->getNumberOfLayer(); i++ )
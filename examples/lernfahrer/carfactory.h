@@ -21,6 +21,10 @@ public:
 
     SimulationPtr createCrossover( SimulationPtr a, SimulationPtr b, double mutationRate) override;
 
+    SimulationPtr createFromGenome( Population& population, const size_t& idx ) override;
+
+    bool isThreadSafe() const override;
+
     SimulationPtr copy( SimulationPtr a ) override;
 
 private:
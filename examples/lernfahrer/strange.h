@@ -18,6 +18,7 @@ public:
 private:
     Eigen::MatrixXi m_originalMap;
     double m_anim;
+    size_t m_obstacle;
 };
 
 
@@ -70,6 +70,30 @@ TEST(Car, MoveConstVelocity)
     delete c;
 }
 
+TEST(Car, MoveFixedTimeStep)
+{
+    auto c = new Car();
+    c->setFixedTimeStep(0.25);
+
+    c->setSpeed(10);
+    c->setDirection(Eigen::Vector2d(1,0));
+    c->setPosition(Eigen::Vector2d(0,0));
+    Eigen::MatrixXi map(100,100);
+    map.fill(1);
+
+    std::shared_ptr<TrackMap> tmap( new TrackMap(map) );
+    c->setMap(tmap);
+
+    // no waiting: the simulated time advances by the time step
+    ASSERT_DOUBLE_EQ(c->getTimeSinceLastUpdate(), 0.25);
+    c->doStep();
+    ASSERT_NEAR(c->getPosition()(0), 2.5, 1e-9);
+    ASSERT_NEAR(c->getPosition()(1), 0.0, 1e-9);
+    ASSERT_DOUBLE_EQ(c->getAge(), 0.25);
+
+    delete c;
+}
+
 TEST(Car, Accelerate)
 {
     auto c = new Car();
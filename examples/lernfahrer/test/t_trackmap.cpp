@@ -0,0 +1,359 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include "car.h"
+#include "trackmap.h"
+#include "workerpool.h"
+
+TEST(TrackMap, EuclideanDistanceTransform)
+{
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> obst(0, 19);
+
+    Eigen::MatrixXi map(23, 31);
+    for( Eigen::Index k = 0; k < map.size(); k++ )
+        map(k) = obst(gen) == 0 ? 0 : 1;
+
+    Eigen::MatrixXf edt = TrackMap::computeEuclideanDistanceTransform(map);
+
+    // brute force, the pixels just outside of the map are obstacles
+    for( int m = 0; m < map.rows(); m++ )
+    {
+        for( int n = 0; n < map.cols(); n++ )
+        {
+            double best = std::numeric_limits<double>::max();
+            for( int i = -1; i <= map.rows(); i++ )
+            {
+                for( int j = -1; j <= map.cols(); j++ )
+                {
+                    const bool outside = i < 0 || j < 0 || i >= map.rows() || j >= map.cols();
+                    if( outside || map(i,j) == 0 )
+                        best = std::min( best, std::sqrt( double((i-m)*(i-m) + (j-n)*(j-n)) ) );
+                }
+            }
+
+            ASSERT_NEAR( edt(m,n), best, 1e-5 );
+        }
+    }
+}
+
+TEST(TrackMap, DynamicMap)
+{
+    Eigen::MatrixXi map(50,50);
+    map.fill(1);
+    TrackMap tmap(map);
+
+    Eigen::Vector2d pos(25,25);
+    const int freeStep = tmap.isPositionValid(pos);
+    ASSERT_GT(freeStep, 20);
+
+    Eigen::MatrixXi dyn = tmap.createAllValidMap();
+    dyn(25,30) = 0;
+    tmap.setDynamicMap(dyn);
+    ASSERT_EQ(tmap.isPositionValid(pos), 3); // 5 - sqrt(2)
+    ASSERT_EQ(tmap.isPositionValid(Eigen::Vector2d(30,25)), 0);
+
+    tmap.clearDynamicMap();
+    ASSERT_EQ(tmap.isPositionValid(pos), freeStep);
+}
+
+TEST(TrackMap, DynamicObstacles)
+{
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> obst(0, 199), row(-20, 119), col(-20, 169);
+
+    Eigen::MatrixXi map(120, 170);
+    for( Eigen::Index k = 0; k < map.size(); k++ )
+        map(k) = obst(gen) == 0 ? 0 : 1;
+
+    TrackMap tmap(map, 1);
+    TrackMap reference(map, 1);
+
+    Eigen::MatrixXi cross = Eigen::MatrixXi::Ones(9, 7);
+    cross.row(4).setZero();
+    cross.col(3).setZero();
+
+    // sprite, row, col -> replayed on a dynamic map of the reference
+    std::vector<std::tuple<Eigen::MatrixXi, int, int>> obstacles;
+    obstacles.push_back( std::make_tuple(Eigen::MatrixXi::Zero(30, 10), 10, 20) );
+    obstacles.push_back( std::make_tuple(Eigen::MatrixXi::Zero(5, 40), 60, 100) );
+    obstacles.push_back( std::make_tuple(cross, 90, 30) );
+
+    std::vector<size_t> ids;
+    ids.push_back( tmap.addDynamicRect(10, 20, 30, 10) );
+    ids.push_back( tmap.addDynamicRect(60, 100, 5, 40) );
+    ids.push_back( tmap.addDynamicObstacle(cross, 90, 30) );
+    ASSERT_EQ( tmap.getNbrOfDynamicObstacles(), size_t(3) );
+
+    ASSERT_FALSE( tmap.moveDynamicObstacle(17, 0, 0) );
+    ASSERT_FALSE( tmap.removeDynamicObstacle(17) );
+
+    for( int k = 0; k < 30; k++ )
+    {
+        if( k == 20 )
+        {
+            ASSERT_TRUE( tmap.removeDynamicObstacle(ids[1]) );
+            ids.erase( ids.begin() + 1 );
+            obstacles.erase( obstacles.begin() + 1 );
+        }
+        else
+        {
+            const size_t idx = size_t(k) % ids.size();
+            std::get<1>(obstacles[idx]) = row(gen);
+            std::get<2>(obstacles[idx]) = col(gen);
+            ASSERT_TRUE( tmap.moveDynamicObstacle(ids[idx], std::get<1>(obstacles[idx]), std::get<2>(obstacles[idx])) );
+        }
+
+        Eigen::MatrixXi dyn = reference.createAllValidMap();
+        for( const auto& o : obstacles )
+        {
+            const Eigen::MatrixXi& sprite = std::get<0>(o);
+            for( int m = 0; m < sprite.rows(); m++ )
+            {
+                for( int n = 0; n < sprite.cols(); n++ )
+                {
+                    const int r = std::get<1>(o) + m;
+                    const int c = std::get<2>(o) + n;
+                    if( sprite(m,n) == 0 && r >= 0 && c >= 0 && r < dyn.rows() && c < dyn.cols() )
+                        dyn(r,c) = 0;
+                }
+            }
+        }
+        reference.setDynamicMap(dyn);
+
+        // step lengths are limited while dynamic obstacles are present
+        const int maxStep = int( std::floor(TrackMap::DynamicReach - M_SQRT2) );
+        for( int m = 0; m < map.rows(); m++ )
+        {
+            for( int n = 0; n < map.cols(); n++ )
+            {
+                const Eigen::Vector2d pos(n, m);
+                ASSERT_EQ( tmap.isPositionValid(pos), std::min(reference.isPositionValid(pos), maxStep) );
+            }
+        }
+    }
+
+    // without dynamic obstacles, the step lengths are the ones of the track
+    ASSERT_TRUE( tmap.removeDynamicObstacle(ids[0]) );
+    ASSERT_TRUE( tmap.removeDynamicObstacle(ids[1]) );
+    reference.clearDynamicMap();
+    for( int m = 0; m < map.rows(); m++ )
+        for( int n = 0; n < map.cols(); n++ )
+            ASSERT_EQ( tmap.isPositionValid(Eigen::Vector2d(n, m)), reference.isPositionValid(Eigen::Vector2d(n, m)) );
+}
+
+TEST(TrackMap, DynamicObstacleUpdate)
+{
+    Eigen::MatrixXi map(180, 240);
+    map.fill(1);
+    map.topRows(20).setZero();
+    map.bottomRows(20).setZero();
+
+    TrackMap tmap(map, 1);
+    TrackMap reference(map, 1);
+    const size_t id = tmap.addDynamicRect(30, 100, 100, 30);
+
+    // moving obstacle, like in the Strange track
+    const int maxStep = int( std::floor(TrackMap::DynamicReach - M_SQRT2) );
+    for( int k = 0; k < 20; k++ )
+    {
+        ASSERT_TRUE( tmap.moveDynamicObstacle(id, 30 + k, 100) );
+
+        Eigen::MatrixXi dyn = reference.createAllValidMap();
+        dyn.block(30 + k, 100, 100, 30).setZero();
+        reference.setDynamicMap(dyn);
+
+        for( int m = 0; m < map.rows(); m++ )
+        {
+            for( int n = 0; n < map.cols(); n++ )
+            {
+                const Eigen::Vector2d pos(n, m);
+                ASSERT_EQ( tmap.isPositionValid(pos), std::min(reference.isPositionValid(pos), maxStep) );
+            }
+        }
+    }
+
+    ASSERT_EQ( tmap.isPositionValid(Eigen::Vector2d(110, 100)), 0 );
+    ASSERT_EQ( tmap.isPositionValid(Eigen::Vector2d(145, 100)), 14 ); // 16 - sqrt(2)
+}
+
+TEST(TrackMap, TiledStorage)
+{
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> obst(0, 9);
+
+    // not a multiple of the tile size
+    Eigen::MatrixXi map(75, 133);
+    for( Eigen::Index k = 0; k < map.size(); k++ )
+        map(k) = obst(gen) == 0 ? 0 : 1 + obst(gen);
+
+    TrackMap tmap(map, 1);
+    ASSERT_TRUE( tmap.getMap() == ( map.array() != 0 ).cast<int>().matrix() );
+
+    // step lengths from the distance transform
+    Eigen::MatrixXf dist = TrackMap::computeEuclideanDistanceTransform(map);
+    for( int m = 0; m < map.rows(); m++ )
+    {
+        for( int n = 0; n < map.cols(); n++ )
+        {
+            const int expected = dist(m,n) <= 0.0f ? 0 : std::max(1, int(std::floor(dist(m,n) - M_SQRT2)));
+            ASSERT_EQ( tmap.isPositionValid(Eigen::Vector2d(n, m)), expected );
+        }
+    }
+
+    // steps saturate
+    Eigen::MatrixXi open = Eigen::MatrixXi::Ones(1000, 1000);
+    TrackMap large(open, 1);
+    ASSERT_EQ( large.isPositionValid(Eigen::Vector2d(500, 500)), int(TrackMap::MaxStep) );
+    ASSERT_EQ( large.isPositionValid(Eigen::Vector2d(10, 500)), 9 ); // 11 - sqrt(2)
+
+    // 1 bit occupancy and two 8 bit step maps per pixel
+    ASSERT_EQ( large.getMemoryFootprint(), size_t(1024 * 1024 / 8 + 2 * 1024 * 1024) );
+    Eigen::MatrixXi dyn = large.createAllValidMap();
+    dyn(500, 520) = 0;
+    large.setDynamicMap(dyn);
+    ASSERT_EQ( large.isPositionValid(Eigen::Vector2d(500, 500)), 18 ); // 20 - sqrt(2)
+    ASSERT_EQ( large.getMemoryFootprint(), size_t(2 * 1024 * 1024 / 8 + 2 * 1024 * 1024) );
+    large.clearDynamicMap();
+    ASSERT_EQ( large.isPositionValid(Eigen::Vector2d(500, 500)), int(TrackMap::MaxStep) );
+}
+
+TEST(TrackMap, ParallelDistanceTransform)
+{
+    // more columns and rows than the workers claim at once
+    Eigen::MatrixXi map(216, 384);
+    map.fill(1);
+    for( int m = 0; m < map.rows(); m += 9 )
+        map.row(m).segment(m % 50, 200).setZero();
+
+    Eigen::MatrixXf single = TrackMap::computeEuclideanDistanceTransform(map);
+
+    WorkerPool pool(4);
+    Eigen::MatrixXf parallel = TrackMap::computeEuclideanDistanceTransform(map, &pool);
+
+    ASSERT_TRUE( single == parallel );
+    ASSERT_EQ( single(0,0), 0.0f ); // wall
+    ASSERT_EQ( single(0,300), 1.0f );
+    ASSERT_EQ( single(1,10), 1.0f );  // below the first wall
+}
+
+namespace
+{
+    // Ray marching in 1 pixel steps, as before the distance transform.
+    double distanceToEdgePixelSteps(const TrackMap& map, const Eigen::Vector2d &pos, const Eigen::Vector2d &direction)
+    {
+        Eigen::Vector2d d = direction.normalized();
+        Eigen::Vector2d end = pos;
+        while( map.isPositionValid(end) > 0 )
+            end = end + d;
+
+        return (end-pos).norm();
+    }
+
+    // Ring shaped track with a few pillars.
+    Eigen::MatrixXi createRingTrack()
+    {
+        Eigen::MatrixXi map(600,800);
+        map.fill(0);
+        for( int m = 0; m < map.rows(); m++ )
+        {
+            for( int n = 0; n < map.cols(); n++ )
+            {
+                const double dx = (n - 400) / 380.0;
+                const double dy = (m - 300) / 280.0;
+                const double r = std::sqrt(dx*dx + dy*dy);
+                if( r < 1.0 && r > 0.55 && ( (m / 40 + n / 40) % 7 != 0 ) )
+                    map(m,n) = 1;
+            }
+        }
+        return map;
+    }
+}
+
+TEST(TrackMap, SphereTracing)
+{
+    std::shared_ptr<TrackMap> tmap( new TrackMap(createRingTrack()) );
+    Car car;
+    car.setMap(tmap);
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> px(0, 799), py(0, 599), ang(0, 2*M_PI);
+    size_t nbrOfRays = 0;
+    while( nbrOfRays < 2000 )
+    {
+        Eigen::Vector2d p(px(gen), py(gen));
+        if( tmap->isPositionValid(p) == 0 )
+            continue;
+
+        const double a = ang(gen);
+        const Eigen::Vector2d d(std::cos(a), std::sin(a));
+
+        // both stop within the last step into the obstacle
+        ASSERT_NEAR(distanceToEdgePixelSteps(*tmap, p, d), car.distanceToEdge(p, d), 1.0);
+        nbrOfRays++;
+    }
+}
+
+TEST(TrackMap, CastRays)
+{
+    std::shared_ptr<TrackMap> tmap( new TrackMap(createRingTrack()) );
+    Car car;
+    car.setMap(tmap);
+
+    // 7 sensor rays per car position
+    const long nbrOfRays = 7 * 300;
+    Eigen::Matrix2Xd positions(2, nbrOfRays), directions(2, nbrOfRays);
+
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<double> px(0, 799), py(0, 599), ang(0, 2*M_PI);
+    long k = 0;
+    while( k < nbrOfRays )
+    {
+        Eigen::Vector2d p(px(gen), py(gen));
+        if( tmap->isPositionValid(p) == 0 )
+            continue;
+
+        for( int s = 0; s < 7; s++, k++ )
+        {
+            const double a = ang(gen);
+            positions.col(k) = p;
+            directions.col(k) = Eigen::Vector2d(std::cos(a), std::sin(a));
+        }
+    }
+
+    Eigen::VectorXd batched(nbrOfRays);
+    for( long r = 0; r < nbrOfRays; r += 7 )
+        tmap->castRays(positions.middleCols(r, 7), directions.middleCols(r, 7), batched.segment(r, 7));
+
+    for( long r = 0; r < nbrOfRays; r++ )
+        ASSERT_NEAR(car.distanceToEdge(positions.col(r), directions.col(r)), batched(r), 1e-9);
+
+    // all rays at once, e.g. the same sensor of many cars
+    Eigen::VectorXd all(nbrOfRays);
+    tmap->castRays(positions, directions, all);
+    ASSERT_TRUE(all == batched);
+}
@@ -0,0 +1,162 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef EIDNN_TILEDMAP_H
+#define EIDNN_TILEDMAP_H
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 2D map stored in tiles of 32 x 32 values. Within a tile, the values are
+ * row by row. Neighbouring pixels in both directions are therefore mostly
+ * in the same few cache lines, which suits rays marching in any direction.
+ */
+template <typename T>
+class TiledMap
+{
+public:
+    static const int TileBits = 5;
+    static const int TileSize = 1 << TileBits;
+
+    TiledMap() : m_rows(0), m_cols(0), m_tilesPerRow(0) {}
+
+    TiledMap(int rows, int cols, T value = T(0))
+    {
+        resize(rows, cols, value);
+    }
+
+    void resize(int rows, int cols, T value = T(0))
+    {
+        m_rows = rows;
+        m_cols = cols;
+        m_tilesPerRow = size_t( ( cols + TileSize - 1 ) >> TileBits );
+        const size_t tilesPerCol = size_t( ( rows + TileSize - 1 ) >> TileBits );
+        m_data.assign( m_tilesPerRow * tilesPerCol * TileSize * TileSize, value );
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+
+    T operator()(int row, int col) const { return m_data[index(row, col)]; }
+    T& operator()(int row, int col) { return m_data[index(row, col)]; }
+
+    /**
+     * Limits all values to maxValue.
+     */
+    void clampMax(T maxValue)
+    {
+        for( T& v : m_data )
+            v = std::min( v, maxValue );
+    }
+
+    /**
+     * Allocated bytes.
+     */
+    size_t getMemoryFootprint() const { return m_data.size() * sizeof(T); }
+
+private:
+    size_t index(int row, int col) const
+    {
+        const size_t tile = size_t( row >> TileBits ) * m_tilesPerRow + size_t( col >> TileBits );
+        return ( tile << ( 2 * TileBits ) ) | size_t( ( row & ( TileSize - 1 ) ) << TileBits ) | size_t( col & ( TileSize - 1 ) );
+    }
+
+private:
+    int m_rows;
+    int m_cols;
+    size_t m_tilesPerRow;
+    std::vector<T> m_data;
+};
+
+/**
+ * Occupancy plane with 1 bit per pixel, tiled like TiledMap: one 32 bit
+ * word per row of a 32 x 32 tile. A set bit is a free pixel.
+ */
+class TiledBitMap
+{
+public:
+    static const int TileBits = 5;
+    static const int TileSize = 1 << TileBits;
+
+    TiledBitMap() : m_rows(0), m_cols(0), m_tilesPerRow(0) {}
+
+    /**
+     * Constructor
+     * @param map Map, pixels with value 0 are not set.
+     */
+    explicit TiledBitMap(const Eigen::MatrixXi& map)
+    {
+        m_rows = int( map.rows() );
+        m_cols = int( map.cols() );
+        m_tilesPerRow = size_t( ( m_cols + TileSize - 1 ) >> TileBits );
+        const size_t tilesPerCol = size_t( ( m_rows + TileSize - 1 ) >> TileBits );
+        m_words.assign( m_tilesPerRow * tilesPerCol * TileSize, 0u );
+
+        for( int n = 0; n < m_cols; n++ )
+            for( int m = 0; m < m_rows; m++ )
+                if( map(m, n) != 0 )
+                    m_words[word(m, n)] |= bit(n);
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+
+    bool operator()(int row, int col) const { return ( m_words[word(row, col)] & bit(col) ) != 0; }
+
+    /**
+     * Unpacked map, 1 = set, 0 = not set.
+     */
+    Eigen::MatrixXi toMatrix() const
+    {
+        Eigen::MatrixXi map( m_rows, m_cols );
+        for( int n = 0; n < m_cols; n++ )
+            for( int m = 0; m < m_rows; m++ )
+                map(m, n) = (*this)(m, n) ? 1 : 0;
+        return map;
+    }
+
+    /**
+     * Allocated bytes.
+     */
+    size_t getMemoryFootprint() const { return m_words.size() * sizeof(uint32_t); }
+
+private:
+    size_t word(int row, int col) const
+    {
+        const size_t tile = size_t( row >> TileBits ) * m_tilesPerRow + size_t( col >> TileBits );
+        return ( tile << TileBits ) | size_t( row & ( TileSize - 1 ) );
+    }
+
+    static uint32_t bit(int col) { return uint32_t(1) << ( col & ( TileSize - 1 ) ); }
+
+private:
+    int m_rows;
+    int m_cols;
+    size_t m_tilesPerRow;
+    std::vector<uint32_t> m_words;
+};
+
+#endif //EIDNN_TILEDMAP_H
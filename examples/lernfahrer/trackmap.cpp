@@ -3,13 +3,41 @@
 //
 
 #include "trackmap.h"
+#include "workerpool.h"
 
 #include <iostream>
+#include <limits>
+#include <cmath>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 
+static_assert( TrackMap::TileSize == TiledMap<uint8_t>::TileSize, "dirty tiles match the storage tiles" );
 
-TrackMap::TrackMap(const Eigen::MatrixXi& map): m_dynamicMapSet(false)
+namespace
 {
-    m_map = map; //computeDistanceMap( map );
+    // A position maps to the pixel at its rounded up coordinates, so it is less than
+    // sqrt(2) away from it. Advancing by the pixel distance - sqrt(2) never enters an
+    // obstacle pixel. Close to obstacles, the ray is marched pixel by pixel.
+    // Saturated at TrackMap::MaxStep.
+    int stepLength( const float& dist )
+    {
+        if( dist <= 0.0f )
+            return 0;
+        if( dist >= float( TrackMap::MaxStep ) + 2.0f )
+            return TrackMap::MaxStep;
+        return std::max( 1, int( std::floor( dist - float( M_SQRT2 ) ) ) );
+    }
+}
+
+TrackMap::TrackMap(const Eigen::MatrixXi& map, unsigned int nbrOfThreads): m_dynamicMapSet(false), m_nextObstacleId(0)
+{
+    if( nbrOfThreads == 0 )
+        nbrOfThreads = std::max( std::thread::hardware_concurrency(), 1u );
+    m_workerPool.reset( new WorkerPool( nbrOfThreads ) );
+
+    resetMap( map );
 }
 
 TrackMap::~TrackMap()
@@ -19,145 +47,391 @@ TrackMap::~TrackMap()
 
 void TrackMap::resetMap(const Eigen::MatrixXi &map)
 {
-    m_map = computeDistanceMap( map );
+    m_map = TiledBitMap( map );
+    m_staticStepMap = computeStepMap( map );
+    updateStepMap();
 }
 
-const Eigen::MatrixXi &TrackMap::getMap() const
+Eigen::MatrixXi TrackMap::getMap() const
 {
-    return m_map;
+    return m_map.toMatrix();
 }
 
 int TrackMap::isPositionValid(const Eigen::Vector2d &pos) const
 {
-    int r = isPositionValid(m_map, pos);
+    return stepAt(pos(0), pos(1));
+}
 
-    if( r!=0 && m_dynamicMapSet )
-        r = std::min(r, isPositionValid(m_dynamicMap, pos));
+inline int TrackMap::stepAt(const double& x, const double& y) const
+{
+    if(x < 0.0 ||  x > m_stepMap.cols()-1 || y < 0.0 ||  y > m_stepMap.rows()-1)
+        return 0;
 
-    return r;
+    return m_stepMap( Eigen::Index( std::ceil(y) ), Eigen::Index( std::ceil(x) ) );
 }
 
-int TrackMap::isPositionValid(const Eigen::MatrixXi& map, const Eigen::Vector2d &pos) const
+void TrackMap::castRays(const Eigen::Ref<const Eigen::Matrix2Xd>& positions, const Eigen::Ref<const Eigen::Matrix2Xd>& directions,
+                        Eigen::Ref<Eigen::VectorXd> distances) const
 {
-    if(pos(0) < 0.0 ||  pos(0) > map.cols()-1 || pos(1) < 0.0 ||  pos(1) > map.rows()-1)
-        return 0;
+    const Eigen::Index nbrOfRays = positions.cols();
+
+    for( Eigen::Index first = 0; first < nbrOfRays; first += RayLanes )
+    {
+        const int lanes = int( std::min( Eigen::Index( RayLanes ), nbrOfRays - first ) );
+
+        double x[RayLanes], y[RayLanes];
+        int step[RayLanes];
+        for( int k = 0; k < lanes; k++ )
+        {
+            x[k] = positions( 0, first + k );
+            y[k] = positions( 1, first + k );
+        }
 
-    return map( std::ceil(pos(1)) , std::ceil(pos(0)));
+        // A finished ray has step length 0 and stays where it is. Its lane is
+        // marched along until all rays of the lanes are finished.
+        bool goOn = true;
+        while( goOn )
+        {
+            goOn = false;
+            for( int k = 0; k < lanes; k++ )
+            {
+                step[k] = stepAt( x[k], y[k] );
+                goOn = goOn || step[k] > 0;
+            }
+
+            for( int k = 0; k < lanes; k++ )
+            {
+                x[k] = x[k] + directions( 0, first + k ) * step[k];
+                y[k] = y[k] + directions( 1, first + k ) * step[k];
+            }
+        }
+
+        for( int k = 0; k < lanes; k++ )
+            distances( first + k ) = Eigen::Vector2d( x[k] - positions( 0, first + k ), y[k] - positions( 1, first + k ) ).norm();
+    }
 }
 
 void TrackMap::setDynamicMap(const Eigen::MatrixXi &map)
 {
     m_dynamicMapSet = true;
-    m_dynamicMap = map;
+    m_dynamicMap = TiledBitMap( map );
+    updateStepMap();
 }
 
 void TrackMap::clearDynamicMap()
 {
     m_dynamicMapSet = false;
+    m_dynamicMap = TiledBitMap();
+    updateStepMap();
 }
 
-Eigen::MatrixXi TrackMap::createAllValidMap() const
+void TrackMap::updateStepMap()
 {
-    return Eigen::MatrixXi::Ones(m_map.rows(), m_map.cols());
+    m_dirtyTiles.clear();
+
+    if( !hasDynamicMap() && m_obstacles.empty() )
+    {
+        m_stepMap = m_staticStepMap;
+        return;
+    }
+
+    m_stepMap = computeStepMap( rasterize( { 0, 0, int( m_map.rows() ), int( m_map.cols() ) } ) );
+
+    if( !m_obstacles.empty() )
+        m_stepMap.clampMax( uint8_t( stepLength( float( DynamicReach ) ) ) );
 }
 
-Eigen::MatrixXi TrackMap::computeDistanceMap( const Eigen::MatrixXi& map ) const
+bool TrackMap::hasDynamicMap() const
+{
+    return m_dynamicMapSet && m_dynamicMap.rows() == m_map.rows() && m_dynamicMap.cols() == m_map.cols();
+}
+
+Eigen::MatrixXi TrackMap::rasterize( const Rect& r ) const
 {
-    Eigen::MatrixXi dMap = map;
+    const int rows = r.bottom - r.top;
+    const int cols = r.right - r.left;
+
+    const bool dynamicMap = hasDynamicMap();
 
-    for( size_t m = 0; m < dMap.rows(); m++ )
+    Eigen::MatrixXi mask( rows, cols );
+    for( int n = 0; n < cols; n++ )
+        for( int m = 0; m < rows; m++ )
+            mask( m, n ) = m_map( r.top + m, r.left + n ) && ( !dynamicMap || m_dynamicMap( r.top + m, r.left + n ) ) ? 1 : 0;
+
+    for( const auto& entry : m_obstacles )
     {
-        for( size_t n = 0; n < dMap.cols(); n++ )
-        {
+        const DynamicObstacle& o = entry.second;
+        const int top = std::max( r.top, o.row );
+        const int left = std::max( r.left, o.col );
+        const int bottom = std::min( r.bottom, o.row + int( o.sprite.rows() ) );
+        const int right = std::min( r.right, o.col + int( o.sprite.cols() ) );
+
+        for( int n = left; n < right; n++ )
+            for( int m = top; m < bottom; m++ )
+                if( o.sprite( m - o.row, n - o.col ) == 0 )
+                    mask( m - r.top, n - r.left ) = 0;
+    }
 
-            if(m==2 && n==1 )
-                int k = 0;
+    return mask;
+}
 
-            if( mapPositionValue(m,n, dMap) > 0 )
-            {
-                // get initial surrounding info
-                int iMax, iMin;
-                getKnownSuroundingMapDistances(m,n,dMap,iMin,iMax);
+size_t TrackMap::addDynamicObstacle(const Eigen::MatrixXi& sprite, int row, int col)
+{
+    // Without dynamic obstacles, step lengths are not limited. The current ones are
+    // exact, so limiting them is enough to start with.
+    if( m_obstacles.empty() )
+        m_stepMap.clampMax( uint8_t( stepLength( float( DynamicReach ) ) ) );
 
-                if( iMin == 0 )
-                {
-                    dMap(m,n) = 1;
-                    continue;
-                }
+    const size_t id = m_nextObstacleId++;
+    m_obstacles[id] = { sprite, row, col };
 
-                // the max different among neighbours can be 2 -> if so, the current distance is in between.
-                if( iMax - iMin == 2 )
-                {
-                    dMap(m, n) = iMin + 1;
-                    continue;
-                }
+    markDirty( m_obstacles[id] );
+    updateDirtyTiles();
 
+    return id;
+}
 
-                // otherwise, we have to search in the right down region for a collision
+size_t TrackMap::addDynamicRect(int row, int col, int height, int width)
+{
+    return addDynamicObstacle( Eigen::MatrixXi::Zero( height, width ), row, col );
+}
 
-                int r = iMax;
-                while( true )
-                {
-                    bool collision = false;
-
-                    // lower h line
-                    for (int i = -r; i <= r && !collision; i++)
-                        collision = collision || (mapPositionValue(m + r, n + i, dMap) == 0);
-
-                    // left v line
-                    for (int i = 1; i <= r && !collision; i++)
-                        collision = collision || (mapPositionValue(m + i, n - r, dMap) == 0);
-
-                    // right v line
-                    for (int i = -r; i <= r && !collision; i++)
-                        collision = collision || (mapPositionValue(m + i, n + r, dMap) == 0);
-
-                    if (!collision)
-                    {
-                        r = r + 1;
-                        break;
-                    }
-                    else
-                    {
-                        r = r - 1;
-                    }
-                }
+bool TrackMap::moveDynamicObstacle(size_t id, int row, int col)
+{
+    auto it = m_obstacles.find( id );
+    if( it == m_obstacles.end() )
+    {
+        std::cout << "Error: no dynamic obstacle with id " << id << std::endl;
+        return false;
+    }
 
-                dMap(m, n) = r;
+    if( it->second.row == row && it->second.col == col )
+        return true;
 
-            }
-            else
+    markDirty( it->second );
+    it->second.row = row;
+    it->second.col = col;
+    markDirty( it->second );
+    updateDirtyTiles();
+
+    return true;
+}
+
+bool TrackMap::removeDynamicObstacle(size_t id)
+{
+    auto it = m_obstacles.find( id );
+    if( it == m_obstacles.end() )
+    {
+        std::cout << "Error: no dynamic obstacle with id " << id << std::endl;
+        return false;
+    }
+
+    const DynamicObstacle removed = it->second;
+    m_obstacles.erase( it );
+
+    if( m_obstacles.empty() )
+    {
+        // step lengths are not limited anymore
+        updateStepMap();
+    }
+    else
+    {
+        markDirty( removed );
+        updateDirtyTiles();
+    }
+
+    return true;
+}
+
+size_t TrackMap::getNbrOfDynamicObstacles() const
+{
+    return m_obstacles.size();
+}
+
+void TrackMap::markDirty( const DynamicObstacle& obstacle )
+{
+    const int rows = int( m_map.rows() );
+    const int cols = int( m_map.cols() );
+
+    const int top = std::max( 0, obstacle.row - DynamicReach );
+    const int left = std::max( 0, obstacle.col - DynamicReach );
+    const int bottom = std::min( rows, obstacle.row + int( obstacle.sprite.rows() ) + DynamicReach );
+    const int right = std::min( cols, obstacle.col + int( obstacle.sprite.cols() ) + DynamicReach );
+
+    if( top >= bottom || left >= right )
+        return;
+
+    m_dirtyTiles.push_back( { top / TileSize, left / TileSize,
+                              ( bottom + TileSize - 1 ) / TileSize, ( right + TileSize - 1 ) / TileSize } );
+}
+
+void TrackMap::updateDirtyTiles()
+{
+    // merge overlapping tile rectangles -> each tile is computed once
+    bool merged = true;
+    while( merged )
+    {
+        merged = false;
+        for( size_t i = 0; i < m_dirtyTiles.size() && !merged; i++ )
+        {
+            for( size_t j = i + 1; j < m_dirtyTiles.size() && !merged; j++ )
             {
-                dMap(m, n) = 0;
+                Rect& a = m_dirtyTiles[i];
+                const Rect& b = m_dirtyTiles[j];
+                if( a.top < b.bottom && b.top < a.bottom && a.left < b.right && b.left < a.right )
+                {
+                    a = { std::min( a.top, b.top ), std::min( a.left, b.left ),
+                          std::max( a.bottom, b.bottom ), std::max( a.right, b.right ) };
+                    m_dirtyTiles.erase( m_dirtyTiles.begin() + long( j ) );
+                    merged = true;
+                }
             }
         }
     }
 
-    return dMap;
+    const int rows = int( m_map.rows() );
+    const int cols = int( m_map.cols() );
+    const float reach = float( DynamicReach );
+
+    for( const Rect& t : m_dirtyTiles )
+    {
+        const Rect pixels = { t.top * TileSize, t.left * TileSize,
+                              std::min( rows, t.bottom * TileSize ), std::min( cols, t.right * TileSize ) };
+
+        // The window reaches DynamicReach beyond the tiles. Its outside counts as obstacle,
+        // which is more than DynamicReach away from the tile pixels -> within the tiles,
+        // distances up to DynamicReach are exact.
+        const Rect window = { std::max( 0, pixels.top - DynamicReach ), std::max( 0, pixels.left - DynamicReach ),
+                              std::min( rows, pixels.bottom + DynamicReach ), std::min( cols, pixels.right + DynamicReach ) };
+
+        const Eigen::MatrixXf dist = computeEuclideanDistanceTransform( rasterize( window ) );
+
+        for( int n = pixels.left; n < pixels.right; n++ )
+            for( int m = pixels.top; m < pixels.bottom; m++ )
+                m_stepMap( m, n ) = uint8_t( stepLength( std::min( dist( m - window.top, n - window.left ), reach ) ) );
+    }
+
+    m_dirtyTiles.clear();
 }
 
-int TrackMap::mapPositionValue(size_t m, size_t n, const Eigen::MatrixXi &map) const
+Eigen::MatrixXi TrackMap::createAllValidMap() const
 {
-    if(n < 0 ||  n > map.cols()-1 || m < 0 ||  m > map.rows()-1 )
-        return 0;
+    return Eigen::MatrixXi::Ones(m_map.rows(), m_map.cols());
+}
+
+size_t TrackMap::getMemoryFootprint() const
+{
+    return m_map.getMemoryFootprint() + m_dynamicMap.getMemoryFootprint() +
+           m_staticStepMap.getMemoryFootprint() + m_stepMap.getMemoryFootprint();
+}
+
+Eigen::MatrixXi TrackMap::computeDistanceMap( const Eigen::MatrixXi& map ) const
+{
+    // distances are not negative -> truncation rounds down
+    return computeEuclideanDistanceTransform( map, m_workerPool.get() ).cast<int>();
+}
+
+TiledMap<uint8_t> TrackMap::computeStepMap( const Eigen::MatrixXi& map ) const
+{
+    Eigen::MatrixXf dist = computeEuclideanDistanceTransform( map, m_workerPool.get() );
+    TiledMap<uint8_t> steps( int( map.rows() ), int( map.cols() ) );
 
-    return map( m , n );
+    for( int n = 0; n < int( map.cols() ); n++ )
+        for( int m = 0; m < int( map.rows() ); m++ )
+            steps( m, n ) = uint8_t( stepLength( dist( m, n ) ) );
+
+    return steps;
 }
 
-void TrackMap::getKnownSuroundingMapDistances(size_t m, size_t n, const Eigen::MatrixXi& map, int &min, int &max) const
+namespace
 {
-    min = std::numeric_limits<int>::max();
-    max = std::numeric_limits<int>::min();
+    // larger than any squared distance, but finite -> no inf - inf
+    const float FarAway = 1e20f;
+
+    // Squared distance transform of a 1D sampled function f (Felzenszwalb and Huttenlocher).
+    // v and z are buffers of size n and n + 1.
+    void distanceTransform1D( const float* f, const int& n, const int& fStride, float* d, const int& dStride, int* v, float* z )
+    {
+        int k = 0;
+        v[0] = 0;
+        z[0] = -std::numeric_limits<float>::infinity();
+        z[1] = std::numeric_limits<float>::infinity();
+
+        for( int q = 1; q < n; q++ )
+        {
+            const float fq = f[q * fStride] + float(q) * float(q);
+            float s = ( fq - ( f[v[k] * fStride] + float(v[k]) * float(v[k]) ) ) / float( 2 * ( q - v[k] ) );
+            while( s <= z[k] )
+            {
+                k--;
+                s = ( fq - ( f[v[k] * fStride] + float(v[k]) * float(v[k]) ) ) / float( 2 * ( q - v[k] ) );
+            }
+
+            k++;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = std::numeric_limits<float>::infinity();
+        }
+
+        k = 0;
+        for( int q = 0; q < n; q++ )
+        {
+            while( z[k + 1] < float(q) )
+                k++;
+
+            const float dq = float( q - v[k] );
+            d[q * dStride] = std::min( dq * dq + f[v[k] * fStride], FarAway );
+        }
+    }
+
+    // Applies distanceTransform1D on all columns of in, distributed over the pool.
+    void distanceTransformColumns( const Eigen::MatrixXf& in, Eigen::MatrixXf& out, WorkerPool* pool )
+    {
+        const int rows = int( in.rows() );
+        const int cols = int( in.cols() );
+        const int chunkSize = 16;
+        std::atomic<int> nextColumn( 0 );
+
+        std::function<void(const unsigned int&)> job = [&]( const unsigned int& )
+        {
+            std::vector<int> v( rows );
+            std::vector<float> z( rows + 1 );
+
+            for(;;)
+            {
+                const int start = nextColumn.fetch_add( chunkSize );
+                if( start >= cols )
+                    break;
+
+                for( int c = start; c < std::min( start + chunkSize, cols ); c++ )
+                    distanceTransform1D( in.col(c).data(), rows, 1, out.col(c).data(), 1, v.data(), z.data() );
+            }
+        };
+
+        if( pool != nullptr )
+            pool->run( job );
+        else
+            job( 0 );
+    }
+}
+
+Eigen::MatrixXf TrackMap::computeEuclideanDistanceTransform( const Eigen::MatrixXi& map, WorkerPool* pool )
+{
+    // map with a frame of obstacles -> the outside of the map counts as obstacle
+    const int rows = int( map.rows() ) + 2;
+    const int cols = int( map.cols() ) + 2;
+
+    Eigen::MatrixXf f = Eigen::MatrixXf::Zero( rows, cols );
+    f.block( 1, 1, map.rows(), map.cols() ) = ( map.array() != 0 ).select( Eigen::MatrixXf::Constant( map.rows(), map.cols(), FarAway ), 0.0f );
 
-    int mP = mapPositionValue(m-1,n-1, map);
-    min = std::min( min, mP);
-    max = std::max( max, mP);
+    // along the columns, then along the rows -> transposed, so both passes run on contiguous columns
+    Eigen::MatrixXf colPass( rows, cols );
+    distanceTransformColumns( f, colPass, pool );
 
-    mP = mapPositionValue(m-1,n, map);
-    min = std::min( min, mP);
-    max = std::max( max, mP);
+    f = colPass.transpose();
+    Eigen::MatrixXf rowPass( cols, rows );
+    distanceTransformColumns( f, rowPass, pool );
 
-    mP = mapPositionValue(m-1,n+1, map);
-    min = std::min( min, mP);
-    max = std::max( max, mP);
+    // exact sqrt -> the distances of pixel centers are exact integers where they should be
+    return rowPass.transpose().block( 1, 1, map.rows(), map.cols() ).unaryExpr( []( const float& d ) { return std::sqrt( d ); } );
 }
@@ -5,39 +5,199 @@
 #ifndef EIDNN_TRACKMAP_H
 #define EIDNN_TRACKMAP_H
 
-#include <Eigen/Dense>
+#include "tiledmap.h"
 
+#include <Eigen/Dense>
+#include <map>
+#include <memory>
+#include <vector>
+
+class WorkerPool;
+
+/**
+ * Map of a track: pixels with value 0 are obstacles, all others are free.
+ * On load, and whenever the dynamic map changes, an exact Euclidean distance
+ * transform of the free pixels is computed. isPositionValid() returns a step
+ * length, which can be advanced from a position in any direction without
+ * passing an obstacle -> rays are sphere traced.
+ * Moving obstacles are either set as a whole dynamic map, or as dynamic obstacles.
+ * A dynamic obstacle only updates the tiles of the step map close to the pixels
+ * it covered before and after a change.
+ * The track and the dynamic map are kept as 1 bit occupancy planes, the step
+ * lengths as 8 bit values saturated at MaxStep. All are stored in 32 x 32 tiles.
+ */
 class TrackMap
 {
 public:
-    TrackMap(const Eigen::MatrixXi& map);
+    /**
+     * Constructor
+     * @param map Track map, 0 = obstacle.
+     * @param nbrOfThreads Threads used to compute the distance transform. 0 = number of cores.
+     */
+    TrackMap(const Eigen::MatrixXi& map, unsigned int nbrOfThreads = 0);
     virtual ~TrackMap();
 
     void resetMap(const Eigen::MatrixXi& map);
-    const Eigen::MatrixXi& getMap() const;
 
+    /**
+     * Track map, unpacked from the occupancy plane.
+     * @return Map with 0 = obstacle, 1 = free.
+     */
+    Eigen::MatrixXi getMap() const;
+
+    /**
+     * Sets additional obstacles (pixels with value 0), e.g. moving ones.
+     * @param map Map with the same size as the track map.
+     */
     void setDynamicMap(const Eigen::MatrixXi& map);
     void clearDynamicMap();
 
+    /**
+     * Adds a moving obstacle. While dynamic obstacles are present, step lengths are
+     * limited to DynamicReach - sqrt(2) pixels, so that a change only affects the
+     * step map within DynamicReach pixels.
+     * @param sprite Shape of the obstacle, pixels with value 0 are obstacles.
+     * @param row Row of the top left corner. It may be partly outside of the map.
+     * @param col Column of the top left corner.
+     * @return Id of the obstacle.
+     */
+    size_t addDynamicObstacle(const Eigen::MatrixXi& sprite, int row, int col);
+
+    /**
+     * Adds a rectangular moving obstacle.
+     * @return Id of the obstacle.
+     */
+    size_t addDynamicRect(int row, int col, int height, int width);
+
+    /**
+     * Moves a dynamic obstacle.
+     * @param id Id of the obstacle.
+     * @param row Row of the top left corner.
+     * @param col Column of the top left corner.
+     * @return False if there is no such obstacle.
+     */
+    bool moveDynamicObstacle(size_t id, int row, int col);
+
+    /**
+     * Removes a dynamic obstacle.
+     * @param id Id of the obstacle.
+     * @return False if there is no such obstacle.
+     */
+    bool removeDynamicObstacle(size_t id);
+
+    size_t getNbrOfDynamicObstacles() const;
+
+    /**
+     * Checks a position against the track and the dynamic map.
+     * @param pos Position (x,y).
+     * @return 0 if the position is not valid. Otherwise a safe step length
+     *         in pixels, at least 1.
+     */
     int isPositionValid(const Eigen::Vector2d &pos) const;
 
+    /**
+     * Sphere traces rays until they reach an invalid position. The rays are
+     * marched in lanes of RayLanes rays side by side, which interleaves their
+     * step map lookups.
+     * @param positions Start positions (x,y), one column per ray.
+     * @param directions Normalized directions, one column per ray.
+     * @param distances Output: distance from the start to the first invalid position of each ray.
+     *                  Needs to have as many rows as there are rays.
+     */
+    void castRays(const Eigen::Ref<const Eigen::Matrix2Xd>& positions, const Eigen::Ref<const Eigen::Matrix2Xd>& directions,
+                  Eigen::Ref<Eigen::VectorXd> distances) const;
+
     Eigen::MatrixXi createAllValidMap() const;
 
+    /**
+     * Bytes allocated for the occupancy planes and the step maps.
+     */
+    size_t getMemoryFootprint() const;
+
+    /**
+     * Distance of each pixel to the closest obstacle or to the outside of the map,
+     * rounded down. Obstacles have distance 0.
+     * @param map Map.
+     * @return Distance map.
+     */
     Eigen::MatrixXi computeDistanceMap( const Eigen::MatrixXi& map ) const;
 
+    /**
+     * Exact Euclidean distance of each pixel to the closest obstacle pixel. The
+     * pixels just outside of the map count as obstacles. Computed in linear time
+     * with the algorithm of Felzenszwalb and Huttenlocher: a pass over the columns,
+     * and a pass over the rows. The columns, respectively rows, are distributed
+     * over the workers of the pool.
+     * @param map Map.
+     * @param pool Worker pool, or nullptr to compute in the calling thread.
+     * @return Distances in pixels.
+     */
+    static Eigen::MatrixXf computeEuclideanDistanceTransform( const Eigen::MatrixXi& map, WorkerPool* pool = nullptr );
+
+
+    // Edge length of the step map tiles, which are updated on a dynamic obstacle change.
+    static const int TileSize = 32;
+
+    // Distance in pixels, up to which dynamic obstacles are considered in the step map.
+    static const int DynamicReach = 32;
+
+    // Number of rays marched side by side in castRays.
+    static const int RayLanes = 8;
+
+    // Step lengths saturate at this value.
+    static const int MaxStep = 255;
+
 
 private:
 
-    int isPositionValid(const Eigen::MatrixXi& map, const Eigen::Vector2d &pos) const;
+    struct DynamicObstacle
+    {
+        Eigen::MatrixXi sprite;
+        int row;
+        int col;
+    };
 
-    int mapPositionValue(size_t m, size_t n, const Eigen::MatrixXi& map) const;
+    // Pixel or tile rectangle, bottom and right are exclusive.
+    struct Rect
+    {
+        int top;
+        int left;
+        int bottom;
+        int right;
+    };
 
-    void getKnownSuroundingMapDistances( size_t m, size_t n, const Eigen::MatrixXi& map,  int& min, int& max ) const;
+    // Step length at position (x,y)
+    int stepAt(const double& x, const double& y) const;
 
+    // Safe step lengths from the distance transform of the obstacles in map.
+    TiledMap<uint8_t> computeStepMap( const Eigen::MatrixXi& map ) const;
 
-    Eigen::MatrixXi m_map;
-    Eigen::MatrixXi m_dynamicMap;
+    void updateStepMap();
+
+    bool hasDynamicMap() const;
+
+    // Obstacles of the track, the dynamic map and the dynamic obstacles within the rectangle r.
+    Eigen::MatrixXi rasterize( const Rect& r ) const;
+
+    // Marks the tiles within DynamicReach of the pixels covered by an obstacle.
+    void markDirty( const DynamicObstacle& obstacle );
+
+    // Recomputes the step map of the dirty tiles.
+    void updateDirtyTiles();
+
+
+    TiledBitMap m_map;
+    TiledBitMap m_dynamicMap;
     bool m_dynamicMapSet;
+
+    TiledMap<uint8_t> m_staticStepMap;  // step lengths of m_map
+    TiledMap<uint8_t> m_stepMap;        // step lengths of m_map, m_dynamicMap and m_obstacles
+
+    std::map<size_t, DynamicObstacle> m_obstacles;
+    size_t m_nextObstacleId;
+    std::vector<Rect> m_dirtyTiles;
+
+    std::unique_ptr<WorkerPool> m_workerPool;
 };
 
 
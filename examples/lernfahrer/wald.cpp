@@ -7,6 +7,8 @@
 Wald::Wald(const QString &name, const QString &rscPath) : Track(name, rscPath), m_anim(0.0)
 {
     m_originalMap = createMap(getTrackImg());
+    m_obstacleA = m_trackMap->addDynamicRect(330, 90, 40, 40);
+    m_obstacleB = m_trackMap->addDynamicRect(370, 100, 20, 20);
 }
 
 Wald::~Wald()
@@ -18,20 +20,15 @@ void Wald::draw(QPainter *painter, const std::vector<SimulationPtr > &simRes)
 {
     drawMap(painter);
 
-    // draw moving obstacle
-    Eigen::MatrixXi newDynMap = m_trackMap->createAllValidMap();
-
+    // draw moving obstacle -> only the map tiles around it are updated
     size_t obstStartPosX = 90;
     size_t obstStartPosY = 330;
     size_t movingDist = 20;
 
     size_t obstaclePos = std::sin(m_anim) * movingDist/2.0 + obstStartPosX;
     m_anim = m_anim + 0.03;
-    addDynamicSquare(painter, newDynMap, obstaclePos, obstStartPosY, 40, 40);
-    addDynamicSquare(painter, newDynMap, obstaclePos+10, obstStartPosY+40, 20, 20);
-
-    m_trackMap->setDynamicMap(newDynMap);
-
+    drawDynamicSquare(painter, m_obstacleA, obstaclePos, obstStartPosY, 40, 40);
+    drawDynamicSquare(painter, m_obstacleB, obstaclePos+10, obstStartPosY+40, 20, 20);
 
     drawAllCars(painter, simRes);
 }
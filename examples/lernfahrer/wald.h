@@ -17,6 +17,8 @@ public:
 private:
     Eigen::MatrixXi m_originalMap;
     double m_anim;
+    size_t m_obstacleA;
+    size_t m_obstacleB;
 };
 
 
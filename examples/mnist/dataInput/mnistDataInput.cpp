@@ -23,6 +23,9 @@
 
 #include "mnistDataInput.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "mnist/mnist_reader.hpp"
 #include "mnist/mnist_utils.hpp"
 
@@ -35,66 +38,75 @@ MnistDataInput::~MnistDataInput()
 {
 }
 
-bool MnistDataInput::loadMNISTSample( const std::vector<std::vector<double>>& imgSet, const std::vector<uint8_t>& lableSet,
-                                      const size_t& idx, Eigen::MatrixXd& img, uint8_t& lable)
+void MnistDataInput::load()
 {
-    if( std::max(imgSet.size(), lableSet.size()) <= idx )
-        return false;
-
-    lable = lableSet.at( idx );
-    const std::vector<double>& imgV = imgSet.at( idx );
-
-    img = Eigen::MatrixXd( imgV.size(), 1 );
-    for( size_t i = 0; i < imgV.size(); i++ )
-        img( int(i), 0 ) = imgV.at(i);
+    // The parsed data set is cached in a binary dataset file, which is memory mapped
+    // on the next start instead of parsing the IDX files again.
+    const std::string cacheFile = "mnist.eidnnds";
+    if( !openDatasets( cacheFile, m_trainingSet, m_testSet ) )
+    {
+        parse();
+        saveDatasets( cacheFile, m_trainingSet, m_testSet );
+    }
 
-    return true;
+    // lable -> expected output
+    m_lables.clear();
+    for( long k = 0; k < m_trainingSet.getOutputSize(); k++ )
+        m_lables.insert( std::make_pair( int(k), DataLable( int(k), NNMatrix::Identity( m_trainingSet.getOutputSize(), m_trainingSet.getOutputSize() ).col(k) ) ) );
 }
 
-void MnistDataInput::load()
+void MnistDataInput::parse()
 {
     // MNIST_DATA_LOCATION passed by cmake
     auto mnistinputNormalized = mnist::read_dataset<std::vector, std::vector, double, uint8_t>(MNIST_DATA_LOCATION);
     mnist::normalize_dataset(mnistinputNormalized);
 
-    // Load training data
-    for( size_t k = 0; k < mnistinputNormalized.training_images.size(); k++ )
-    {
-        Eigen::MatrixXd xInNormalized; uint8_t lable;
-        loadMNISTSample( mnistinputNormalized.training_images, mnistinputNormalized.training_labels, k, xInNormalized, lable );
-        addTrainingSample(xInNormalized, static_cast<int>(lable));
-    }
-
-    // Load testing data
-    for( size_t k = 0; k < mnistinputNormalized.test_images.size(); k++ )
-    {
-        Eigen::MatrixXd xInNormalized; uint8_t lable;
-        loadMNISTSample( mnistinputNormalized.test_images, mnistinputNormalized.test_labels, k, xInNormalized, lable );
-        addTestSample( xInNormalized, static_cast<int>(lable));
-    }
+    const size_t nbrOfLables = 10;
+    m_trainingSet = createDataset( mnistinputNormalized.training_images, mnistinputNormalized.training_labels, nbrOfLables );
+    m_testSet = createDataset( mnistinputNormalized.test_images, mnistinputNormalized.test_labels, nbrOfLables );
+}
 
-    generateFromLables();
+Dataset MnistDataInput::createDataset( const std::vector<std::vector<double>>& imgSet, const std::vector<uint8_t>& lableSet,
+                                       const size_t& nbrOfLables )
+{
+    const size_t nbrOfSamples = std::min( imgSet.size(), lableSet.size() );
+    if( nbrOfSamples == 0 )
+        return Dataset();
 
+    // written directly into the contiguous dataset -> no matrix per sample
+    const size_t nbrOfPixels = imgSet.front().size();
+    NNMatrix inputs( nbrOfPixels, nbrOfSamples );
+    NNMatrix outputs = NNMatrix::Zero( nbrOfLables, nbrOfSamples );
+    std::vector<int> lables( nbrOfSamples );
 
-    // get the test images as images
-    auto mnistPixelImages = mnist::read_dataset<std::vector, std::vector, double, uint8_t>(MNIST_DATA_LOCATION);
-    for( size_t k = 0; k < mnistPixelImages.test_images.size(); k++ )
+    for( size_t k = 0; k < nbrOfSamples; k++ )
     {
-        Eigen::MatrixXd xImg; uint8_t lable;
-        loadMNISTSample( mnistPixelImages.test_images, mnistPixelImages.test_labels, k, xImg, lable );
-        DataElement de;
-        de.input = xImg;
-        de.lable = lable;
-        m_testImages.push_back(de);
+        for( size_t i = 0; i < nbrOfPixels; i++ )
+            inputs( long(i), long(k) ) = NNScalar( imgSet[k][i] );
+
+        lables[k] = lableSet[k];
+        outputs( lables[k], long(k) ) = 1.0;
     }
+
+    return Dataset( std::move(inputs), std::move(outputs), std::move(lables) );
 }
 
 DataElement MnistDataInput::getTestImageAsPixelValues( size_t idx ) const
 {
-    return m_testImages.at(idx);
+    // the inputs are normalized per image (mean 0, std 1) -> scaling back to the pixel
+    // range restores the image, since MNIST images span the whole range
+    Eigen::Map<const NNMatrix> input = m_testSet.getInputs( idx, 1 );
+    const NNScalar minVal = input.minCoeff();
+    const NNScalar range = std::max( input.maxCoeff() - minVal, NNScalar(1e-6) );
+
+    DataElement de;
+    de.input = ( ( input.array() - minVal ) * ( NNScalar(255) / range ) ).matrix();
+    de.lable = m_testSet.hasLables() ? m_testSet.getLable( idx ) : 0;
+    de.lableSet = m_testSet.hasLables();
+    return de;
 }
 
-Eigen::MatrixXd MnistDataInput::representation( const Eigen::MatrixXd& input, bool* representationAvailable  ) const
+NNMatrix MnistDataInput::representation( const NNMatrix& input, bool* representationAvailable  ) const
 {
     size_t imgW = 28;
     size_t imgH = 28;
@@ -106,7 +118,7 @@ Eigen::MatrixXd MnistDataInput::representation( const Eigen::MatrixXd& input, bo
         return input;
     }
 
-    Eigen::MatrixXd rep = Eigen::MatrixXd(imgH,imgW);
+    NNMatrix rep = NNMatrix(imgH,imgW);
     for( size_t h = 0; h < imgH; h++ )
     {
         for( size_t w = 0; w < imgW; w++ )
@@ -35,15 +35,20 @@ public:
 
     DataElement getTestImageAsPixelValues( size_t idx ) const;
 
-    Eigen::MatrixXd representation( const Eigen::MatrixXd& input, bool* representationAvailable  ) const override;
+    NNMatrix representation( const NNMatrix& input, bool* representationAvailable  ) const override;
+
+    Dataset getTrainingDataset() const override { return m_trainingSet; }
+    Dataset getTestDataset() const override { return m_testSet; }
 
 
 private:
     void load();
-    bool loadMNISTSample( const std::vector<std::vector<double>>& imgSet, const std::vector<uint8_t>& lableSet,
-                          const size_t& idx, Eigen::MatrixXd& img, uint8_t& lable);
+    void parse();
+    static Dataset createDataset( const std::vector<std::vector<double>>& imgSet, const std::vector<uint8_t>& lableSet,
+                                  const size_t& nbrOfLables );
 
-    std::vector<DataElement> m_testImages;
+    Dataset m_trainingSet;
+    Dataset m_testSet;
 
 };
 
@@ -89,7 +89,7 @@ Widget::Widget(QWidget* parent) : QMainWindow(parent), ui(new Ui::Widget),
     connect( ui->formerSample, &QPushButton::pressed, [=]( )
     {
         if( m_currentIdx == 0 )
-            m_currentIdx = m_data->getNumberOfTestSamples() - 1;
+            m_currentIdx = m_testSet.getNumberOfSamples() - 1;
         else
             m_currentIdx--;
 
@@ -98,7 +98,7 @@ Widget::Widget(QWidget* parent) : QMainWindow(parent), ui(new Ui::Widget),
 
     connect( ui->nextSample, &QPushButton::pressed, [=]( )
     {
-        if( m_currentIdx == m_data->getNumberOfTestSamples() - 1 )
+        if( m_currentIdx == m_testSet.getNumberOfSamples() - 1 )
             m_currentIdx = 0;
         else
             m_currentIdx++;
@@ -169,11 +169,8 @@ void Widget::prepareSamples()
 {
     m_data = new MnistDataInput();
 
-    m_batchin = DataInput::getInputData(m_data->m_training);
-    m_batchout = DataInput::getOutputData(m_data->m_training);
-
-    m_testin = DataInput::getInputData(m_data->m_test);
-    m_testout = DataInput::getOutputData(m_data->m_test);
+    m_trainingSet = m_data->getTrainingDataset();
+    m_testSet = m_data->getTestDataset();
 
     // print lables
     std::cout << "Lables: " << std::endl;
@@ -183,15 +180,16 @@ void Widget::prepareSamples()
     }
 
     // validate sample data
-    DataInput::DataInputValidation div = m_data->validateData();
+    bool valid = m_trainingSet.getNumberOfSamples() > 0 && m_testSet.getNumberOfSamples() > 0 &&
+                 m_trainingSet.getInputSize() == m_testSet.getInputSize() && m_trainingSet.getOutputSize() == m_testSet.getOutputSize();
 
-    if( div.valid )
+    if( valid )
     {
         // prepare network
         std::vector<unsigned int> map;
-        map.push_back(div.inputDataLength);
+        map.push_back(m_trainingSet.getInputSize());
         map.push_back(30);
-        map.push_back(div.outputDataLength);
+        map.push_back(m_trainingSet.getOutputSize());
 
         m_net.reset(new Network(map));
         m_net->setObserver(this);
@@ -209,7 +207,7 @@ void Widget::displayTestMNISTImage( const size_t& idx )
 {
     DataElement sample = m_data->getTestImageAsPixelValues(idx);
     bool repAvailable = false;
-    Eigen::MatrixXd imgMatrix = m_data->representation(sample.input, &repAvailable);
+    NNMatrix imgMatrix = m_data->representation(sample.input, &repAvailable);
 
     if( repAvailable )
     {
@@ -229,11 +227,10 @@ void Widget::displayTestMNISTImage( const size_t& idx )
 
     ui->testlable->setText( "Lable: " + QString::number(sample.lable, 10) );
 
-    if( !m_net_validation->isOperationInProgress() )
+    // feedforward in own workspace -> does not interfere with an ongoing validation
+    if( m_net_validation->feedForward(m_testSet.getInputs(idx, 1), m_displayWorkspace) )
     {
-        // feedforward
-        m_net_validation->feedForward(m_data->m_test.at(idx).input);
-        Eigen::MatrixXd activationSignal = m_net_validation->getOutputActivation();
+        NNMatrix activationSignal = m_displayWorkspace.getOutputActivation();
         QString actStr;
         actStr.sprintf("Activation: [ %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f]", activationSignal(0,0), activationSignal(1,0),
                        activationSignal(2,0), activationSignal(3,0), activationSignal(4,0), activationSignal(5,0), activationSignal(6,0),
@@ -310,17 +307,17 @@ void Widget::doNNLearning()
 { 
     double learningRate = ui->learingRateSB->value();
     m_net->setCostFunction( getCurrentSelectedCostFunction() );
-    m_net->stochasticGradientDescentAsync(m_batchin, m_batchout, 10, learningRate, NETID_TRAINING );
+    m_net->stochasticGradientDescentAsync(m_trainingSet, 10, learningRate, NETID_TRAINING );
 }
 
 void Widget::doNNTesting()
 {
-    m_net_training_testing->testNetworkAsync( m_batchin, m_batchout, 0.50, NETID_TRAINING_TESTING);
+    m_net_training_testing->testNetworkAsync( m_trainingSet, 0.50, NETID_TRAINING_TESTING);
 }
 
 void Widget::doNNValidation()
 {
-    m_net_validation->testNetworkAsync( m_testin, m_testout, 0.50, NETID_VALIDATION);
+    m_net_validation->testNetworkAsync( m_testSet, 0.50, NETID_VALIDATION);
 }
 
 void Widget::networkOperationProgress( const NetworkOperationId & opId, const NetworkOperationStatus &opStatus,
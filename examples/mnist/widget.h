@@ -37,12 +37,12 @@ public:
 
 private:
     bool loadMNISTSample( const std::vector<std::vector<double>>& imgSet, const std::vector<uint8_t>& lableSet,
-                          const size_t& idx, Eigen::MatrixXd& img, uint8_t& lable);
+                          const size_t& idx, NNMatrix& img, uint8_t& lable);
     void displayTestMNISTImage(const size_t &idx);
     void learn();
     void sameImage();
     void prepareSamples();
-    Eigen::MatrixXd lableToOutputVector( const uint8_t& lable );
+    NNMatrix lableToOutputVector( const uint8_t& lable );
     Network::ECostFunction getCurrentSelectedCostFunction();
     void getMinMaxYValue(const QtCharts::QLineSeries* series, const uint &nbrEntries, double& min, double& max);
 
@@ -76,14 +76,13 @@ private:
     QtCharts::QValueAxis* m_RCYAxis;
 
     QTimer* m_uiUpdaterTimer;
-    std::vector<Eigen::MatrixXd> m_batchin;
-    std::vector<Eigen::MatrixXd> m_batchout;
-    std::vector<Eigen::MatrixXd> m_testin;
-    std::vector<Eigen::MatrixXd> m_testout;
+    Dataset m_trainingSet;
+    Dataset m_testSet;
     size_t m_currentIdx;
     std::shared_ptr<Network> m_net;
     std::shared_ptr<Network> m_net_validation;
     std::shared_ptr<Network> m_net_training_testing;
+    NetworkWorkspace m_displayWorkspace;
 
     // thread safe ui values
     std::atomic<double> m_sr_L2, m_sr_MAX;
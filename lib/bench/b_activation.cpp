@@ -0,0 +1,89 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include "neuron.h"
+
+// Sigmoid activation and its derivative: scalar loops calling Neuron::sigmoid
+// per element compared to the vectorized kernels used in Layer.
+
+template <typename F>
+static double nanosecondsPerElement( const long& nbrOfElements, const int& repetitions, F kernel )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( int r = 0; r < repetitions; r++ )
+        kernel();
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    return seconds * 1e9 / double(nbrOfElements * repetitions);
+}
+
+TEST(ActivationBenchmark, SigmoidPerLayerWidth)
+{
+    const long batchSize = 32;
+    const long elementsPerWidth = 1 << 22;
+
+    std::cout << std::setw(8) << "width"
+              << std::setw(16) << "scalar [ns]" << std::setw(16) << "vector [ns]" << std::setw(10) << "speedup"
+              << std::setw(18) << "d scalar [ns]" << std::setw(18) << "d vector [ns]" << std::setw(10) << "speedup" << std::endl;
+
+    double checksum = 0.0;
+
+    for( long width : { 16, 64, 256, 1024, 4096 } )
+    {
+        NNMatrix z = NNMatrix::Random( width, batchSize ) * 6.0;
+        NNMatrix a( width, batchSize );
+        NNMatrix d( width, batchSize );
+        const int repetitions = int( elementsPerWidth / z.size() );
+
+        const double scalar = nanosecondsPerElement( z.size(), repetitions, [&]{
+            for( long m = 0; m < z.rows(); m++ )
+                for( long n = 0; n < z.cols(); n++ )
+                    a(m,n) = Neuron::sigmoid( z(m,n) );
+            checksum += a(0,0); } );
+
+        const double vectorized = nanosecondsPerElement( z.size(), repetitions, [&]{
+            Neuron::sigmoid( z, a );
+            checksum += a(0,0); } );
+
+        // derivative: recomputing the sigmoid of z compared to reusing the activation
+        const double d_scalar = nanosecondsPerElement( z.size(), repetitions, [&]{
+            for( long m = 0; m < z.rows(); m++ )
+                for( long n = 0; n < z.cols(); n++ )
+                    d(m,n) = Neuron::d_sigmoid( z(m,n) );
+            checksum += d(0,0); } );
+
+        const double d_vectorized = nanosecondsPerElement( z.size(), repetitions, [&]{
+            d.array() = a.array() * (1.0 - a.array());
+            checksum += d(0,0); } );
+
+        std::cout << std::setw(8) << width << std::fixed << std::setprecision(3)
+                  << std::setw(16) << scalar << std::setw(16) << vectorized << std::setw(9) << scalar / vectorized << "x"
+                  << std::setw(18) << d_scalar << std::setw(18) << d_vectorized << std::setw(9) << d_scalar / d_vectorized << "x" << std::endl;
+    }
+
+    ASSERT_TRUE( std::isfinite( checksum ) );
+}
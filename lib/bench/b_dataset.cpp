@@ -0,0 +1,74 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include "dataInput.h"
+
+// Startup cost of a MNIST-sized data set: converting per-sample elements into a
+// contiguous dataset compared to memory mapping a binary dataset file.
+
+template <typename F>
+static double milliseconds( F f )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+TEST(DatasetBenchmark, ConvertVsMapped)
+{
+    const unsigned int nbrOfSamples = 20000;
+    const unsigned int inputSize = 784;
+
+    DataInput di;
+    for( unsigned int k = 0; k < nbrOfSamples; k++ )
+        di.addTrainingSample( NNMatrix::Random( inputSize, 1 ), int(k % 10) );
+    ASSERT_TRUE( di.generateFromLables() );
+
+    Dataset converted;
+    const double convert = milliseconds( [&]{ converted = di.getTrainingDataset(); } );
+
+    const std::string filePath = "dataset_benchmark.eidnnds";
+    const double save = milliseconds( [&]{ ASSERT_TRUE( DataInput::saveDatasets( filePath, converted, Dataset() ) ); } );
+
+    Dataset mapped, test;
+    const double open = milliseconds( [&]{ ASSERT_TRUE( DataInput::openDatasets( filePath, mapped, test ) ); } );
+
+    // first pass over the mapped data -> pages are read from the page cache
+    NNScalar sum = 0;
+    const double firstPass = milliseconds( [&]{ sum = mapped.getInputs().sum(); } );
+    ASSERT_NEAR( sum, converted.getInputs().sum(), 1e-6 * double( nbrOfSamples * inputSize ) );
+
+    std::cout << nbrOfSamples << " samples x " << inputSize << std::fixed << std::setprecision(2) << std::endl
+              << "convert elements [ms]: " << convert << std::endl
+              << "save file [ms]:        " << save << std::endl
+              << "open mapped [ms]:      " << open << std::endl
+              << "first pass [ms]:       " << firstPass << std::endl;
+
+    mapped = Dataset();
+    std::remove( filePath.c_str() );
+}
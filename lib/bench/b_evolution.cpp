@@ -0,0 +1,117 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include "evolution.h"
+
+// Simulation steps per second of cheap simulations, where the thread handling
+// dominates: threads created and joined in every step, as Evolution::doStep did
+// before, compared to the persistent worker pool of Evolution.
+
+class CheapSimulation: public Simulation
+{
+public:
+    CheapSimulation( const size_t& lifetime ) : m_lifetime( lifetime )
+    {
+        m_network = NetworkPtr( new Network( {4,6,2} ) );
+    }
+
+protected:
+    void update() override
+    {
+        m_network->feedForward( m_input, m_networkWorkspace );
+        if( ++m_steps >= m_lifetime )
+            m_alive = false;
+    }
+
+private:
+    NNMatrix m_input = NNMatrix::Random( 4, 1 );
+    size_t m_lifetime;
+    size_t m_steps = 0;
+};
+
+class CheapSimFactory: public SimulationFactory
+{
+public:
+    SimulationPtr createRandomSimulation() override
+    {
+        // unbalanced: most simulations die early
+        size_t lifetime = ( m_created++ % 10 ) == 0 ? 1000 : 50;
+        return SimulationPtr( new CheapSimulation( lifetime ) );
+    }
+
+    size_t m_created = 0;
+};
+
+TEST(EvolutionBenchmark, SpawnPerStepVsWorkerPool)
+{
+    const size_t nbrOfSims = 200;
+    const int nbrOfSteps = 1000;
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(18) << "spawn [steps/s]" << std::setw(18) << "pool [steps/s]" << std::setw(10) << "speedup" << std::endl;
+
+    for( unsigned int nbrOfThreads : {1u, 2u, 4u} )
+    {
+        // former implementation: static partitioning, new threads in every step
+        std::shared_ptr<CheapSimFactory> f( new CheapSimFactory() );
+        std::vector<SimulationPtr> sims;
+        for( size_t k = 0; k < nbrOfSims; k++ )
+            sims.push_back( f->createRandomSimulation() );
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( int step = 0; step < nbrOfSteps; step++ )
+        {
+            std::vector<std::thread> thv;
+            const size_t perThread = nbrOfSims / nbrOfThreads;
+            for( unsigned int th = 0; th < nbrOfThreads; th++ )
+            {
+                const size_t startPos = th * perThread;
+                const size_t endPos = th == nbrOfThreads - 1 ? nbrOfSims : startPos + perThread;
+                thv.emplace_back( [&sims, startPos, endPos]() {
+                    for( size_t k = startPos; k < endPos; k++ )
+                        if( sims[k]->isAlive() )
+                            sims[k]->doStep(); } );
+            }
+            for( std::thread& t : thv )
+                t.join();
+        }
+        const double spawn = nbrOfSteps / std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        Evolution e( nbrOfSims, nbrOfSims, std::shared_ptr<CheapSimFactory>( new CheapSimFactory() ), nbrOfThreads );
+        start = std::chrono::steady_clock::now();
+        for( int step = 0; step < nbrOfSteps; step++ )
+            e.doStep();
+        const double pool = nbrOfSteps / std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::cout << std::setw(8) << nbrOfThreads << std::fixed << std::setprecision(0) << std::setw(18) << spawn << std::setw(18) << pool
+                  << std::setprecision(2) << std::setw(9) << pool / spawn << "x" << std::endl;
+
+        ASSERT_GT( pool, 0.0 );
+    }
+}
@@ -0,0 +1,111 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include "layer.h"
+#include "neuron.h"
+
+// Forward pass of a layer: fused kernel of Layer::feedForward, which works in tiles
+// of samples, compared to three separate passes (product, bias, activation) over the
+// whole output. Both variants are timed alternately and the best round is reported.
+
+template <typename F>
+static double microsecondsPerCall( const int& repetitions, F kernel )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( int r = 0; r < repetitions; r++ )
+        kernel();
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    return seconds * 1e6 / double(repetitions);
+}
+
+TEST(ForwardBenchmark, FusedVsSeparatePasses)
+{
+    const int Rounds = 5;
+
+    struct Shape { unsigned int neurons; unsigned int inputs; long batch; };
+    const std::vector<Shape> shapes = { {30, 784, 10}, {10, 30, 10}, {256, 784, 64}, {1024, 1024, 32}, {512, 512, 256}, {4096, 256, 128},
+                                       {30, 784, 10000}, {100, 784, 10000}, {256, 784, 4096} };
+
+    std::cout << std::setw(8) << "neurons" << std::setw(8) << "inputs" << std::setw(8) << "batch"
+              << std::setw(12) << "type" << std::setw(16) << "separate [us]" << std::setw(14) << "fused [us]" << std::setw(10) << "speedup" << std::endl;
+
+    double checksum = 0.0;
+
+    for( const Shape& s : shapes )
+    {
+        for( Layer::LayerOutputType type : { Layer::Sigmoid, Layer::Softmax } )
+        {
+            Layer l( s.neurons, s.inputs, type );
+            l.reserveWorkspace( s.batch );
+            NNMatrix x = NNMatrix::Random( s.inputs, s.batch );
+            NNMatrix xCopy( s.inputs, s.batch );
+            NNMatrix z( s.neurons, s.batch );
+            NNMatrix a( s.neurons, s.batch );
+
+            const double flops = 2.0 * s.neurons * s.inputs * s.batch;
+            const int repetitions = std::max( 3, int( 4e8 / flops ) );
+
+            const std::function<void()> separatePasses = [&]{
+                xCopy = x; // the layer keeps its input for backpropagation
+                z.noalias() = l.getWeightMatrix() * xCopy;
+                z.colwise() += l.getBiasVector().col(0);
+                if( type == Layer::Sigmoid )
+                {
+                    Neuron::sigmoid( z, a );
+                }
+                else
+                {
+                    a = z.array().exp();
+                    for( long n = 0; n < a.cols(); n++ )
+                        a.col(n) /= a.col(n).sum();
+                }
+                checksum += a(0,0); };
+
+            const std::function<void()> fusedKernel = [&]{
+                l.feedForward( x );
+                checksum += l.getOutputActivation()(0,0); };
+
+            double separate = std::numeric_limits<double>::max();
+            double fused = std::numeric_limits<double>::max();
+            for( int round = 0; round < Rounds; round++ )
+            {
+                separate = std::min( separate, microsecondsPerCall( repetitions, separatePasses ) );
+                fused = std::min( fused, microsecondsPerCall( repetitions, fusedKernel ) );
+            }
+
+            std::cout << std::setw(8) << s.neurons << std::setw(8) << s.inputs << std::setw(8) << s.batch
+                      << std::setw(12) << ( type == Layer::Sigmoid ? "sigmoid" : "softmax" ) << std::fixed << std::setprecision(2)
+                      << std::setw(16) << separate << std::setw(14) << fused << std::setw(9) << separate / fused << "x" << std::endl;
+        }
+    }
+
+    // keeps the results alive, activations are within [0,1]
+    ASSERT_GE( checksum, 0.0 );
+}
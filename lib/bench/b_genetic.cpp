@@ -0,0 +1,68 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include "genetic.h"
+
+// Breeding a generation: one crossover per offspring network, compared to the
+// crossover of all offspring at once on the population store, and to copying
+// the store (lower bound).
+
+TEST(GeneticBenchmark, NetworksVsPopulation)
+{
+    const std::vector<unsigned int> structure = {8,16,2};
+    NetworkPtr a( new Network( structure ) );
+    NetworkPtr b( new Network( structure ) );
+
+    std::cout << std::setw(10) << "offspring" << std::setw(18) << "networks [ms]" << std::setw(18) << "population [ms]" << std::setw(10) << "speedup" << std::setw(14) << "copy [ms]" << std::endl;
+
+    for( size_t nbrOfOffspring : {100u, 1000u, 5000u, 50000u} )
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<NetworkPtr> children;
+        for( size_t k = 0; k < nbrOfOffspring; k++ )
+            children.push_back( Genetic::crossover( a, b, Genetic::Uniform, 0.05 ) );
+        const double networks = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+        start = std::chrono::steady_clock::now();
+        Population parents;
+        parents.setNetworks( { a.get(), b.get() } );
+        Population offspring;
+        offspring.setStructure( *a );
+        offspring.resize( nbrOfOffspring );
+        Genetic::crossover( parents, 0, 1, offspring, Genetic::Uniform, 0.05 );
+        const double population = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+        start = std::chrono::steady_clock::now();
+        Population copy = offspring;
+        const double copied = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+        std::cout << std::setw(10) << nbrOfOffspring << std::fixed << std::setprecision(2) << std::setw(18) << networks << std::setw(18) << population
+                  << std::setw(9) << networks / population << "x" << std::setw(14) << copied << std::endl;
+
+        ASSERT_EQ( children.size(), copy.getNumberOfIndividuals() );
+    }
+}
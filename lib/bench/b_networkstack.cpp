@@ -0,0 +1,81 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include "networkstack.h"
+#include "network.h"
+
+// Feedforward of a whole population of small networks with one sample each:
+// one matrix-vector product per network compared to the stacked networks,
+// which evaluate all networks with a few long vector operations.
+
+TEST(NetworkStackBenchmark, SeparateVsStacked)
+{
+    const int nbrOfRuns = 2000;
+
+    std::cout << std::setw(8) << "nets" << std::setw(18) << "separate [us]" << std::setw(18) << "stacked [us]" << std::setw(10) << "speedup" << std::endl;
+
+    for( size_t nbrOfNets : {50u, 500u, 2000u} )
+    {
+        std::vector<std::shared_ptr<Network>> nets;
+        std::vector<const Network*> netPtrs;
+        std::vector<NetworkWorkspace> workspaces( nbrOfNets );
+        for( size_t k = 0; k < nbrOfNets; k++ )
+        {
+            nets.push_back( std::shared_ptr<Network>( new Network( {8,4,2} ) ) );
+            netPtrs.push_back( nets.back().get() );
+        }
+
+        NetworkStack stack;
+        ASSERT_TRUE( stack.setNetworks( netPtrs ) );
+
+        NNMatrix x = NNMatrix::Random( 8, nbrOfNets );
+        NNScalar checksum = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( int run = 0; run < nbrOfRuns; run++ )
+            for( size_t k = 0; k < nbrOfNets; k++ )
+            {
+                nets[k]->feedForward( x.col(k), workspaces[k] );
+                checksum += workspaces[k].getOutputActivation()(0,0);
+            }
+        const double separate = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() / nbrOfRuns;
+
+        start = std::chrono::steady_clock::now();
+        for( int run = 0; run < nbrOfRuns; run++ )
+        {
+            stack.feedForward( x );
+            checksum += stack.getOutputActivation()(0,0);
+        }
+        const double stacked = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count() / nbrOfRuns;
+
+        std::cout << std::setw(8) << nbrOfNets << std::fixed << std::setprecision(1) << std::setw(18) << separate << std::setw(18) << stacked
+                  << std::setprecision(2) << std::setw(9) << separate / stacked << "x" << std::endl;
+
+        ASSERT_TRUE( checksum == checksum );
+    }
+}
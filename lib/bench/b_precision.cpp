@@ -0,0 +1,141 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include "network.h"
+#include "layer.h"
+#include "neuron.h"
+
+// Throughput and accuracy of a MNIST-sized network for the scalar type the library
+// was built with. runBenchmarks uses double, runBenchmarksFloat the float variant
+// of the library -> run both to compare.
+
+// Noisy samples around one random prototype per class.
+static void createClassificationSet( const unsigned int& nbrOfSamples, const unsigned int& inputSize, const unsigned int& nbrOfClasses,
+                                     std::mt19937& gen, std::vector<NNMatrix>& samples, std::vector<NNMatrix>& lables )
+{
+    std::normal_distribution<double> noise( 0.0, 1.0 );
+    std::mt19937 protoGen( 4711 );
+    std::uniform_real_distribution<double> protoDist( -1.0, 1.0 );
+
+    std::vector<NNMatrix> prototypes;
+    for( unsigned int c = 0; c < nbrOfClasses; c++ )
+    {
+        NNMatrix p( inputSize, 1 );
+        for( unsigned int i = 0; i < inputSize; i++ )
+            p(i,0) = NNScalar( protoDist(protoGen) );
+        prototypes.push_back( p );
+    }
+
+    samples.clear(); lables.clear();
+    for( unsigned int k = 0; k < nbrOfSamples; k++ )
+    {
+        const unsigned int c = k % nbrOfClasses;
+        NNMatrix s = prototypes[c];
+        for( unsigned int i = 0; i < inputSize; i++ )
+            s(i,0) += NNScalar( noise(gen) );
+        samples.push_back( s );
+
+        NNMatrix lable = NNMatrix::Zero( nbrOfClasses, 1 );
+        lable( c, 0 ) = 1.0;
+        lables.push_back( lable );
+    }
+}
+
+// Largest deviation of the network output from a double precision feedforward with the same weights.
+static double maxDeviationFromDouble( const Network& net, const NNMatrix& x )
+{
+    NetworkWorkspace ws = net.createWorkspace( x.cols() );
+    net.feedForward( x, ws );
+
+    Eigen::MatrixXd a = x.cast<double>();
+    for( unsigned int k = 1; k < net.getNumberOfLayer(); k++ )
+    {
+        const std::shared_ptr<const Layer> l = net.getLayer(k);
+        Eigen::MatrixXd z = l->getWeightMatrix().cast<double>() * a;
+        z.colwise() += l->getBiasVector().col(0).cast<double>();
+        a = ( 1.0 + (-z.array()).exp() ).inverse().matrix();
+    }
+
+    return ( ws.getOutputActivation().cast<double>() - a ).cwiseAbs().maxCoeff();
+}
+
+TEST(PrecisionBenchmark, ThroughputAndAccuracy)
+{
+    const unsigned int inputSize = 784;
+    const unsigned int nbrOfClasses = 10;
+    const unsigned int batchsize = 32;
+    const unsigned int nbrOfEpochs = 3;
+
+    std::mt19937 gen( 42 );
+    std::vector<NNMatrix> samples; std::vector<NNMatrix> lables;
+    std::vector<NNMatrix> testSamples; std::vector<NNMatrix> testLables;
+    createClassificationSet( 6000, inputSize, nbrOfClasses, gen, samples, lables );
+    createClassificationSet( 1000, inputSize, nbrOfClasses, gen, testSamples, testLables );
+
+    NNMatrix testBatch( inputSize, 1000 );
+    for( long k = 0; k < testBatch.cols(); k++ )
+        testBatch.col(k) = testSamples[k];
+
+    std::cout << "Scalar type: " << ( sizeof(NNScalar) == sizeof(float) ? "float" : "double" ) << std::endl;
+    std::cout << std::setw(14) << "network" << std::setw(16) << "sgd [smpl/s]" << std::setw(20) << "forward [smpl/s]"
+              << std::setw(14) << "accuracy" << std::setw(18) << "max deviation" << std::endl;
+
+    for( const std::vector<unsigned int>& map : { std::vector<unsigned int>{ inputSize, 30, nbrOfClasses },
+                                                  std::vector<unsigned int>{ inputSize, 100, nbrOfClasses } } )
+    {
+        Network net( map );
+        net.setCostFunction( Network::CrossEntropy );
+        net.reserveWorkspace( batchsize );
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( unsigned int e = 0; e < nbrOfEpochs; e++ )
+            ASSERT_TRUE( net.stochasticGradientDescent( samples, lables, batchsize, 0.5 ) );
+        const double sgd = double( samples.size() * nbrOfEpochs ) /
+                std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        NetworkWorkspace ws = net.createWorkspace( testBatch.cols() );
+        const int repetitions = 20;
+        start = std::chrono::steady_clock::now();
+        for( int r = 0; r < repetitions; r++ )
+            ASSERT_TRUE( net.feedForward( testBatch, ws ) );
+        const double forward = double( testBatch.cols() * repetitions ) /
+                std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        double successEuclidean, successMaxIdx, avgCost; std::vector<size_t> failed;
+        ASSERT_TRUE( net.testNetwork( testSamples, testLables, 0.5, false, successEuclidean, successMaxIdx, avgCost, failed ) );
+
+        const double deviation = maxDeviationFromDouble( net, testBatch );
+
+        std::cout << std::setw(14) << ( std::to_string(map[0]) + "-" + std::to_string(map[1]) + "-" + std::to_string(map[2]) )
+                  << std::setw(16) << std::fixed << std::setprecision(0) << sgd << std::setw(20) << forward
+                  << std::setw(14) << std::setprecision(4) << successMaxIdx << std::setw(18) << std::scientific << std::setprecision(2)
+                  << deviation << std::defaultfloat << std::endl;
+
+        ASSERT_GT( successMaxIdx, 0.9 );
+    }
+}
@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include "network.h"
+
+// One epoch of stochastic gradient descent with an expensive batch transform
+// (augmentation by noise), with and without batch prefetching. With prefetching,
+// gathering and transforming the next batch overlaps the training of the current
+// one -> ideally the epoch takes max(load, train) instead of load + train.
+
+static double secondsPerEpoch( Network& net, const Dataset& dataset, const unsigned int& batchsize, const int& epochs )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( int e = 0; e < epochs; e++ )
+        net.stochasticGradientDescent( dataset, batchsize, 0.1 );
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() / double(epochs);
+}
+
+TEST(PrefetchBenchmark, SerialVsPrefetchedEpoch)
+{
+    const long nbrOfSamples = 6000;
+    const unsigned int batchsize = 100;
+    Dataset dataset( NNMatrix::Random( 784, nbrOfSamples ), ( NNMatrix::Random( 10, nbrOfSamples ).array() + 1.0 ) * 0.5 );
+
+    // a few passes over the batch, comparable to a cheap image augmentation
+    Network::BatchTransform augment = []( NNMatrix& batch_in, NNMatrix& )
+    {
+        for( int pass = 0; pass < 8; pass++ )
+            batch_in = ( batch_in.array() + NNScalar(0.001) * ( batch_in.array() * NNScalar(12.9898) ).sin() ).matrix();
+    };
+
+    Network serial( {784, 100, 10} );
+    serial.setBatchTransform( augment );
+    Network prefetched( serial );
+    prefetched.setBatchPrefetching( true );
+
+    const int epochs = 3;
+    secondsPerEpoch( serial, dataset, batchsize, 1 ); // warm up, buffers are allocated
+    secondsPerEpoch( prefetched, dataset, batchsize, 1 );
+
+    const double tSerial = secondsPerEpoch( serial, dataset, batchsize, epochs );
+    const double tPrefetched = secondsPerEpoch( prefetched, dataset, batchsize, epochs );
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(16) << "serial [ms]" << std::setw(18) << "prefetched [ms]" << std::setw(10) << "speedup" << std::endl
+              << std::setw(16) << tSerial * 1e3 << std::setw(18) << tPrefetched * 1e3 << std::setw(9) << tSerial / tPrefetched << "x" << std::endl;
+
+    ASSERT_GT( tPrefetched, 0.0 );
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include "network.h"
+
+// Epoch throughput of the synchronous data-parallel SGD compared to the
+// lock-free Hogwild SGD for an increasing number of threads.
+
+static void createTrainingSet( const unsigned int& nbrOfSamples, const unsigned int& inputSize, const unsigned int& outputSize,
+                               std::vector<NNMatrix>& samples, std::vector<NNMatrix>& lables )
+{
+    samples.clear(); lables.clear();
+    for( unsigned int k = 0; k < nbrOfSamples; k++ )
+    {
+        samples.push_back( NNMatrix::Random( inputSize, 1 ) );
+        NNMatrix lable = NNMatrix::Zero( outputSize, 1 );
+        lable( k % outputSize, 0 ) = 1.0;
+        lables.push_back( lable );
+    }
+}
+
+template <typename F>
+static double samplesPerSecond( const size_t& nbrOfSamples, const unsigned int& nbrOfEpochs, F epoch )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( unsigned int e = 0; e < nbrOfEpochs; e++ )
+        epoch();
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    return double(nbrOfSamples * nbrOfEpochs) / seconds;
+}
+
+TEST(SGDBenchmark, SynchronousVsHogwild)
+{
+    std::vector<NNMatrix> samples; std::vector<NNMatrix> lables;
+    createTrainingSet( 8192, 256, 10, samples, lables );
+
+    const std::vector<unsigned int> map = { 256, 128, 10 };
+    const unsigned int batchsize = 32;
+    const unsigned int nbrOfEpochs = 3;
+
+    std::vector<unsigned int> threadCounts = { 1, 2, 4 };
+    const unsigned int hwThreads = std::thread::hardware_concurrency();
+    if( hwThreads > 4 )
+        threadCounts.push_back( hwThreads );
+
+    std::cout << std::setw(10) << "threads" << std::setw(18) << "sync [smpl/s]" << std::setw(20) << "hogwild [smpl/s]" << std::endl;
+
+    for( unsigned int threads : threadCounts )
+    {
+        Network syncNet( map );
+        syncNet.setNumberOfThreads( threads );
+        Network hogwildNet( syncNet );
+
+        const double sync = samplesPerSecond( samples.size(), nbrOfEpochs, [&]{
+            ASSERT_TRUE( syncNet.stochasticGradientDescent( samples, lables, batchsize, 0.1 ) ); } );
+
+        const double hogwild = samplesPerSecond( samples.size(), nbrOfEpochs, [&]{
+            ASSERT_TRUE( hogwildNet.stochasticGradientDescentHogwild( samples, lables, batchsize, 0.1 ) ); } );
+
+        std::cout << std::setw(10) << threads << std::setw(18) << std::fixed << std::setprecision(0) << sync
+                  << std::setw(20) << hogwild << std::endl;
+    }
+}
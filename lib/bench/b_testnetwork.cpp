@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include "network.h"
+#include "layer.h"
+
+// Evaluation of a MNIST sized test set (10k samples, 784-30-10): one sample
+// feedforwarded at a time, as testNetwork() did before, compared to the batched
+// testNetwork() with one thread and with all hardware threads.
+
+template <typename F>
+static double milliseconds( F kernel )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    kernel();
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+TEST(TestNetworkBenchmark, PerSampleVsBatched)
+{
+    const long nbrOfSamples = 10000;
+    NNMatrix outputs = NNMatrix::Zero( 10, nbrOfSamples );
+    for( long k = 0; k < nbrOfSamples; k++ )
+        outputs( k % 10, k ) = 1.0;
+    Dataset dataset( ( NNMatrix::Random( 784, nbrOfSamples ).array() + 1.0 ) * 0.5, outputs );
+
+    Network net( {784, 30, 10} );
+    net.setCostFunction( Network::CrossEntropy );
+
+    double checksum = 0.0;
+
+    const double perSample = milliseconds( [&]{
+        for( long t = 0; t < nbrOfSamples; t++ )
+        {
+            net.feedForward( dataset.getInputs( t, 1 ) );
+            NNMatrix out = net.getOutputActivation();
+            NNMatrix expected = dataset.getOutputs( t, 1 );
+            net.getOutputLayer()->computeBackpropagationOutputLayerError( expected );
+            checksum += net.getOutputLayer()->getCost() + ( out - expected ).norm();
+        } } );
+
+    double rateEuclidean, rateMax, cost; std::vector<size_t> failed;
+    net.testNetwork( dataset, 0.5, false, rateEuclidean, rateMax, cost, failed ); // warm up
+    const double batched = milliseconds( [&]{ net.testNetwork( dataset, 0.5, false, rateEuclidean, rateMax, cost, failed ); } );
+    checksum += cost;
+
+    net.setNumberOfThreads( 0 );
+    net.testNetwork( dataset, 0.5, false, rateEuclidean, rateMax, cost, failed );
+    const double parallel = milliseconds( [&]{ net.testNetwork( dataset, 0.5, false, rateEuclidean, rateMax, cost, failed ); } );
+    checksum += cost;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(18) << "per sample [ms]" << std::setw(14) << "batched [ms]" << std::setw(10) << "speedup"
+              << std::setw(16) << "threads" << std::setw(16) << "parallel [ms]" << std::setw(10) << "speedup" << std::endl
+              << std::setw(18) << perSample << std::setw(14) << batched << std::setw(9) << perSample / batched << "x"
+              << std::setw(16) << net.getNumberOfThreads() << std::setw(16) << parallel << std::setw(9) << perSample / parallel << "x" << std::endl;
+
+    ASSERT_GT( checksum, 0.0 );
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef BATCHPREFETCHERHEADER
+#define BATCHPREFETCHERHEADER
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <Eigen/Dense>
+#include "scalar.h"
+
+/**
+ * Loads batches in a background thread into a double buffer: while the
+ * caller trains on one batch, the next one is assembled in the other buffer.
+ * The loader thread is kept alive between epochs, and the buffers are reused.
+ */
+class BatchPrefetcher
+{
+public:
+    /**
+     * Assembles the batch batchIdx into batch_in and batch_out. It is called
+     * in the loader thread, one batch after the other.
+     */
+    typedef std::function<void( const size_t& batchIdx, NNMatrix& batch_in, NNMatrix& batch_out )> BatchLoader;
+
+    BatchPrefetcher();
+
+    ~BatchPrefetcher();
+
+    /**
+     * Starts loading the batches 0 to nbrOfBatches - 1. The loader needs to stay
+     * valid until finish() is called.
+     * @param nbrOfBatches Number of batches.
+     * @param loader Function assembling a batch.
+     */
+    void start( const size_t& nbrOfBatches, const BatchLoader& loader );
+
+    /**
+     * Waits until the next batch is loaded and returns it. The batch stays valid
+     * until next() or finish() is called again. Calling next() releases the former
+     * batch, so the loader can reuse its buffer.
+     * @param batch_in Receives the batch input.
+     * @param batch_out Receives the batch expected output.
+     */
+    void next( const NNMatrix*& batch_in, const NNMatrix*& batch_out );
+
+    /**
+     * Stops loading, if not all batches were taken, and waits until the loader
+     * thread is idle. Has to be called before the loader passed to start() is destroyed.
+     */
+    void finish();
+
+private:
+    void loaderLoop();
+
+private:
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+
+    NNMatrix m_batchIn[2];
+    NNMatrix m_batchOut[2];
+
+    const BatchLoader* m_loader;
+    size_t m_nbrOfBatches;
+    size_t m_nbrOfLoaded;    // batches completely loaded
+    size_t m_nbrOfTaken;     // batches returned by next()
+    size_t m_nbrOfReleased;  // batches whose buffer may be reused
+    unsigned long m_generation;
+    bool m_busy;
+    bool m_cancel;
+    bool m_stop;
+};
+
+#endif //BATCHPREFETCHERHEADER
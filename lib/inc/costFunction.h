@@ -26,11 +26,23 @@
 
 
 #include <Eigen/Dense>
+#include "scalar.h"
 
 class CostFunction
 {
 public:
 
+    /**
+     * Computes the diffrence between the actual network activation and the desired output in the output layer.
+     * The result is written into the passed delta matrix, which has to have the size of a_activation.
+     * @param z_weightdInput Weighted input.
+     * @param a_activation Network output activation.
+     * @param y_expected Desired network output.
+     * @param delta Output: The delta for each neuron in the output layer, one column per sample.
+     */
+    virtual void delta( const Eigen::Ref<const NNMatrix>& z_weightdInput, const Eigen::Ref<const NNMatrix>& a_activation,
+                        const Eigen::Ref<const NNMatrix>& y_expected, Eigen::Ref<NNMatrix> delta ) const = 0;
+
     /**
      * Computes the diffrence between the actual network activation and the desired output in the output layer.
      * @param z_weightdInput Weighted input.
@@ -39,8 +51,13 @@ public:
      * @return The delta for each neuron in the output layer. If one sample was feedforward, this is a
      *         vector. Otherwise it is a matrix.
      */
-    virtual Eigen::MatrixXd delta( const Eigen::MatrixXd& z_weightdInput, const Eigen::MatrixXd& a_activation,
-                                   const Eigen::MatrixXd& y_expected) const = 0;
+    NNMatrix delta( const Eigen::Ref<const NNMatrix>& z_weightdInput, const Eigen::Ref<const NNMatrix>& a_activation,
+                           const Eigen::Ref<const NNMatrix>& y_expected ) const
+    {
+        NNMatrix d( a_activation.rows(), a_activation.cols() );
+        delta( z_weightdInput, a_activation, y_expected, d );
+        return d;
+    }
 
     /**
      * Computes the overall cost of a neuronal network.
@@ -48,7 +65,7 @@ public:
      * @param y_expected Desired network output.
      * @return The overall cost.
      */
-    virtual double cost( const Eigen::MatrixXd& a_activation, const Eigen::MatrixXd& y_expected ) const = 0;
+    virtual double cost( const Eigen::Ref<const NNMatrix>& a_activation, const Eigen::Ref<const NNMatrix>& y_expected ) const = 0;
 
     /**
      * Returns the cost function type name.
@@ -35,10 +35,12 @@ public:
 
     // CostFunction interface
 public:
-    Eigen::MatrixXd delta(const Eigen::MatrixXd &z_weightdInput, const Eigen::MatrixXd &a_activation,
-                          const Eigen::MatrixXd &y_expected) const override;
+    using CostFunction::delta;
 
-    double cost(const Eigen::MatrixXd &a_activation, const Eigen::MatrixXd &y_expected) const override;
+    void delta( const Eigen::Ref<const NNMatrix>& z_weightdInput, const Eigen::Ref<const NNMatrix>& a_activation,
+                const Eigen::Ref<const NNMatrix>& y_expected, Eigen::Ref<NNMatrix> delta ) const override;
+
+    double cost( const Eigen::Ref<const NNMatrix>& a_activation, const Eigen::Ref<const NNMatrix>& y_expected ) const override;
 
     std::string name() const override { return "crossentropy"; }
 };
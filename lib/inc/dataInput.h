@@ -26,13 +26,16 @@
 
 #include <vector>
 #include <map>
+#include <string>
 #include <Eigen/Dense>
+#include "scalar.h"
+#include "dataset.h"
 
 struct DataElement
 {
-    Eigen::MatrixXd input;
+    NNMatrix input;
 
-    Eigen::MatrixXd output;
+    NNMatrix output;
     bool outputSet = false;
 
     int lable = 0;
@@ -43,7 +46,7 @@ class DataLable
 {
 public:
     DataLable(int lab){lable = lab; }
-    DataLable(int lab, const Eigen::MatrixXd& out ){lable = lab; output = out; }
+    DataLable(int lab, const NNMatrix& out ){lable = lab; output = out; }
 
     bool operator< (const DataLable &right) const
     {
@@ -51,7 +54,7 @@ public:
     }
 
     int lable = 0;
-    Eigen::MatrixXd output;
+    NNMatrix output;
 };
 
 class DataInput
@@ -66,7 +69,7 @@ public:
      * @param input Sample input.
      * @param expectedOutput Expected sample output.
      */
-    void addTrainingSample( const Eigen::MatrixXd& input, const Eigen::MatrixXd& expectedOutput);
+    void addTrainingSample( const NNMatrix& input, const NNMatrix& expectedOutput);
 
     /**
      * Add a training sample. When added last,
@@ -74,14 +77,14 @@ public:
      * @param input Sample input.
      * @param expectedOutput Numeric sample lable.
      */
-    void addTrainingSample( const Eigen::MatrixXd& input, int lable);
+    void addTrainingSample( const NNMatrix& input, int lable);
 
     /**
      * Add a test sample.
      * @param input Sample input.
      * @param expectedOutput Expected sample output.
      */
-    void addTestSample( const Eigen::MatrixXd& input, const Eigen::MatrixXd& expectedOutput);
+    void addTestSample( const NNMatrix& input, const NNMatrix& expectedOutput);
 
     /**
     * Add a test sample. When added last,
@@ -89,7 +92,7 @@ public:
     * @param input Sample input.
     * @param expectedOutput Numeric sample lable.
     */
-    void addTestSample( const Eigen::MatrixXd& input, int lable);
+    void addTestSample( const NNMatrix& input, int lable);
 
     /**
      * Normalize the input vectors. The applied normalization
@@ -119,8 +122,8 @@ public:
      * the number of different numeric lables which
      * were set. This function has to be called after
      * all smaples were added with
-     * addTrainingSample( const Eigen::MatrixXd& input, int lable) or
-     * addTestSample( const Eigen::MatrixXd& input, int lable);
+     * addTrainingSample( const NNMatrix& input, int lable) or
+     * addTestSample( const NNMatrix& input, int lable);
      *
      * @return True if successfull. Otherwise false.
      */
@@ -131,28 +134,81 @@ public:
      * @param vector Data set.
      * @return
      */
-    static std::vector<Eigen::MatrixXd> getInputData( const std::vector<DataElement>& vector );
+    static std::vector<NNMatrix> getInputData( const std::vector<DataElement>& vector );
 
     /**
      * Returns a vector consisting only of the output vectors for the passed data set.
      * @param vector Data set.
      * @return
      */
-    static std::vector<Eigen::MatrixXd> getOutputData( const std::vector<DataElement>& vector );
+    static std::vector<NNMatrix> getOutputData( const std::vector<DataElement>& vector );
+
+    /**
+     * Returns the passed data set as contiguous dataset. All inputs are stored in one
+     * matrix, and all outputs in another one, one column per sample. This is the
+     * preferred form to train and test a network, since batches are assembled without
+     * any per-sample allocation. The lables are kept if each sample has one.
+     * @param vector Data set. The output of each sample needs to be set.
+     * @return Dataset, or an empty one if an output is missing or the sizes mismatch.
+     */
+    static Dataset getDataset( const std::vector<DataElement>& vector );
+
+    /**
+     * Returns the training samples as contiguous dataset.
+     * @return Dataset.
+     */
+    virtual Dataset getTrainingDataset() const { return getDataset( m_training ); }
+
+    /**
+     * Returns the test samples as contiguous dataset.
+     * @return Dataset.
+     */
+    virtual Dataset getTestDataset() const { return getDataset( m_test ); }
+
+    /**
+     * Writes a training and a test dataset into a binary dataset file. The file consists of
+     * a header, followed by the packed inputs, outputs and lables of both datasets in the
+     * memory layout of Dataset. The scalar type is the one the library was built with.
+     * @param filePath Path to file.
+     * @param training Training dataset.
+     * @param test Test dataset.
+     * @return True if successful, otherwise false.
+     */
+    static bool saveDatasets( const std::string& filePath, const Dataset& training, const Dataset& test );
+
+    /**
+     * Writes the training and test samples into a binary dataset file.
+     * @param filePath Path to file.
+     * @return True if successful, otherwise false.
+     */
+    bool saveDatasets( const std::string& filePath ) const { return saveDatasets( filePath, getTrainingDataset(), getTestDataset() ); }
+
+    /**
+     * Opens a binary dataset file written by saveDatasets(). The file is memory mapped
+     * read-only and the datasets refer directly to the mapped file: opening is almost
+     * instant, the page cache is shared among processes, and the datasets may be
+     * larger than the main memory. The file is unmapped when the last copy of the
+     * datasets is destroyed. It must not be changed while it is mapped.
+     * @param filePath Path to file.
+     * @param training Receives the training dataset.
+     * @param test Receives the test dataset.
+     * @return True if successful, otherwise false.
+     */
+    static bool openDatasets( const std::string& filePath, Dataset& training, Dataset& test );
 
     /**
      * Normalize an input vector.
      * @param in
      * @return
      */
-    static Eigen::MatrixXd normalize0Mean1Std(const Eigen::MatrixXd& in);
+    static NNMatrix normalize0Mean1Std(const NNMatrix& in);
 
     /**
      * Return the row index of the maximum element in out.
      * @param out
      * @return
      */
-    static size_t getStrongestIdx(const Eigen::MatrixXd& out);
+    static size_t getStrongestIdx(const NNMatrix& out);
 
 
     struct DataInputValidation
@@ -179,7 +235,7 @@ public:
      * @param representationAvailable Returns true if a dedicated representation is implemented.
      * @return Representation of data.
      */
-    virtual Eigen::MatrixXd representation( const Eigen::MatrixXd& input, bool* representationAvailable  ) const;
+    virtual NNMatrix representation( const NNMatrix& input, bool* representationAvailable  ) const;
 
 
 
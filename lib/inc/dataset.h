@@ -0,0 +1,156 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef DATASETHEADER
+#define DATASETHEADER
+
+#include <vector>
+#include <memory>
+#include <Eigen/Dense>
+#include "scalar.h"
+
+/**
+ * A set of samples stored contiguously: all inputs in one matrix and all
+ * expected outputs in another one, one column per sample. Since Eigen matrices
+ * are column major, each sample and each range of samples is a contiguous block
+ * of memory. A range of samples is therefore accessible without copying, and a
+ * batch of arbitrary samples is gathered by one memcpy per sample. Optionally,
+ * a numeric lable is stored for each sample.
+ * The storage is either owned by the dataset or a memory mapped dataset file
+ * (see DataInput::openDatasets()). Copies of a dataset share the same storage,
+ * which is never changed.
+ */
+class Dataset
+{
+    friend class DataInput;
+
+public:
+    /**
+     * Empty dataset.
+     */
+    Dataset();
+
+    /**
+     * Dataset of the passed samples.
+     * @param inputs Sample inputs, one column per sample.
+     * @param outputs Expected outputs, one column per sample.
+     *                Pass temporaries or use std::move to avoid copying.
+     * @param lables Numeric lable of each sample. Either empty or one per sample.
+     */
+    Dataset( NNMatrix inputs, NNMatrix outputs, std::vector<int> lables = std::vector<int>() );
+
+    /**
+     * Dataset of the passed samples. Each sample has to be a column vector, and
+     * all inputs and all outputs have to be of the same size.
+     * @param inputs Sample inputs.
+     * @param outputs Expected outputs.
+     */
+    Dataset( const std::vector<NNMatrix>& inputs, const std::vector<NNMatrix>& outputs );
+
+    ~Dataset();
+
+    /**
+     * Returns the number of samples.
+     */
+    size_t getNumberOfSamples() const { return m_nbrOfSamples; }
+
+    /**
+     * Returns the size of a sample input.
+     */
+    long getInputSize() const { return m_inputSize; }
+
+    /**
+     * Returns the size of an expected output.
+     */
+    long getOutputSize() const { return m_outputSize; }
+
+    /**
+     * All sample inputs, one column per sample.
+     */
+    Eigen::Map<const NNMatrix> getInputs() const { return getInputs( 0, m_nbrOfSamples ); }
+
+    /**
+     * All expected outputs, one column per sample.
+     */
+    Eigen::Map<const NNMatrix> getOutputs() const { return getOutputs( 0, m_nbrOfSamples ); }
+
+    /**
+     * Inputs of the samples [begin, begin + count), without copying.
+     * @param begin Index of the first sample.
+     * @param count Number of samples.
+     * @return View of the inputs.
+     */
+    Eigen::Map<const NNMatrix> getInputs( const size_t& begin, const size_t& count ) const
+    {
+        return Eigen::Map<const NNMatrix>( m_inputs + m_inputSize * long(begin), m_inputSize, long(count) );
+    }
+
+    /**
+     * Expected outputs of the samples [begin, begin + count), without copying.
+     * @param begin Index of the first sample.
+     * @param count Number of samples.
+     * @return View of the expected outputs.
+     */
+    Eigen::Map<const NNMatrix> getOutputs( const size_t& begin, const size_t& count ) const
+    {
+        return Eigen::Map<const NNMatrix>( m_outputs + m_outputSize * long(begin), m_outputSize, long(count) );
+    }
+
+    /**
+     * Is a lable stored for each sample.
+     */
+    bool hasLables() const { return m_lables != nullptr; }
+
+    /**
+     * Returns the lable of a sample. Only valid if hasLables().
+     * @param idx Sample index.
+     * @return Lable.
+     */
+    int getLable( const size_t& idx ) const { return m_lables[idx]; }
+
+    /**
+     * Copies the inputs and expected outputs of the passed samples into a batch.
+     * The batch matrices are only resized if their size does not fit.
+     * @param sampleIdx Indices of the samples.
+     * @param count Number of samples.
+     * @param batch_in Receives the inputs, one column per sample.
+     * @param batch_out Receives the expected outputs, one column per sample.
+     */
+    void gather( const size_t* sampleIdx, const size_t& count, NNMatrix& batch_in, NNMatrix& batch_out ) const;
+
+private:
+    // dataset on memory, which is kept alive by storage
+    Dataset( const std::shared_ptr<const void>& storage, const NNScalar* inputs, const NNScalar* outputs, const int* lables,
+             const long& inputSize, const long& outputSize, const size_t& nbrOfSamples );
+
+private:
+    std::shared_ptr<const void> m_storage;
+    const NNScalar* m_inputs;
+    const NNScalar* m_outputs;
+    const int* m_lables;
+    long m_inputSize;
+    long m_outputSize;
+    size_t m_nbrOfSamples;
+};
+
+#endif //DATASETHEADER
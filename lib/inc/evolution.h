@@ -25,10 +25,16 @@
 #define _EVOLUTION_H_
 
 #include "simulation.h"
+#include "workerpool.h"
+#include "networkstack.h"
+#include "population.h"
+#include "xoshiro.h"
 
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <functional>
 
 /**
  * This class runs simulations and evolutions, and keeps track of the
@@ -44,14 +50,19 @@ public:
      * @param nInitial How many random initialized genoms (first epoch)
      * @param nNext How many offsprings generated among best genoms (further epochs)
      * @param simFactory Factory for simulations
-     * @param nThreads Number of threads used for computation
+     * @param nThreads Number of threads used for computation. They are kept alive
+     *                 between the simulation steps.
      */
     Evolution( size_t nInitial, size_t nNext, SimFactoryPtr simFactory, unsigned int nThreads = 4 );
 
     virtual ~Evolution();
 
     /**
-     * A single, discrete simulation step.
+     * A single, discrete simulation step. The simulations are stepped concurrently:
+     * the threads claim chunks of simulations until all are done, so dead simulations
+     * do not leave threads idle. With batched inference, the simulations supporting
+     * sense() and act() are stepped in two phases, and their networks are feedforwarded
+     * at once in between.
      */
     void doStep();
 
@@ -61,7 +72,12 @@ public:
     void doEpoch();
 
     /**
-     * Create the next generation.
+     * Create the next generation. If all simulations share the same network structure,
+     * crossover and mutation run on the population store, and the networks of the
+     * offspring are created from it with SimulationFactory::createFromGenome().
+     * The offspring are bred in chunks by the worker threads, each chunk with its own
+     * random generator, so the genomes only depend on the seed and not on the number
+     * of threads. Otherwise SimulationFactory::createCrossover() is used.
      */
     void breed();
 
@@ -118,6 +134,43 @@ public:
      */
     void setKeepParents(bool keepParents);
 
+    /**
+     * Enables or disables batched inference in doStep(). If enabled, the networks of
+     * all alive simulations, which support sense() and act() and share the same network
+     * structure, are stacked and feedforwarded at once. The other simulations are
+     * stepped with Simulation::doStep(). The networks must not be changed during an
+     * epoch. Enabled by default.
+     * @param enable True or false.
+     */
+    void setBatchedInference( const bool& enable );
+
+    /**
+     * Is batched inference enabled.
+     */
+    bool isBatchedInferenceEnabled() const { return m_batchedInference; }
+
+    /**
+     * Runs all simulations with a fixed time step instead of the wall clock, see
+     * Simulation::setFixedTimeStep(). The time step is applied to the current and
+     * to all later created simulations. An evolution then runs as fast as it can be
+     * computed, and its results do not depend on the machine load.
+     * @param dt Time step in seconds. 0 switches back to the wall clock (default).
+     */
+    void setFixedTimeStep( const double& dt );
+
+    /**
+     * Get the fixed time step.
+     * @return Time step in seconds, or 0 if the wall clock is used.
+     */
+    double getFixedTimeStep() const;
+
+    /**
+     * Seeds the random generator used in breed(). Breeding the same parents with the
+     * same seed gives the same offspring genomes.
+     * @param seed Seed.
+     */
+    void setSeed( const uint64_t& seed );
+
     /**
      * Kill all simulations.
      */
@@ -152,7 +205,26 @@ public:
 
 private:
     std::chrono::milliseconds now() const;
-    static void doStepOnFewSimulations( std::vector<SimulationPtr>& sims, std::atomic_bool& anyAlive, size_t start, size_t end );
+    void doStepOnSimulationChunks( const unsigned int& workerIdx );
+    void doActOnStackChunks( const unsigned int& workerIdx );
+    void breedOnChunks( const unsigned int& workerIdx );
+
+    // (Re)builds the network stack if needed: the simulations changed, or more than
+    // half of the stacked simulations died.
+    void prepareNetworkStack();
+
+    // Applies the fixed time step to all simulations.
+    void applyFixedTimeStep();
+
+    // Copies the networks of all simulations into the population store, if they
+    // share the same structure.
+    void syncPopulation();
+
+    // Number of simulations claimed at once by a thread in doStep().
+    static constexpr size_t StepChunkSize = 4;
+
+    // Number of offspring bred at once with one random generator in breed().
+    static constexpr size_t BreedChunkSize = 32;
 
 
 private:
@@ -167,7 +239,33 @@ private:
     std::chrono::milliseconds m_simSpeedTime;
     double m_simSpeed;
     unsigned int m_nbrThreads;
+    std::unique_ptr<WorkerPool> m_workerPool;
+    std::function<void(const unsigned int&)> m_stepJob;
+    std::atomic<size_t> m_nextStepChunk;
+    std::atomic<bool> m_anyAlive;
+
+    Population m_population;                  // genomes of the simulations
+    std::vector<size_t> m_genomeIdx;          // simulation index -> individual in m_population
+    bool m_populationValid;
+
+    Xoshiro256 m_breedRng;                    // seeds the generators of the breed chunks
+    Population m_parents;
+    std::vector<uint64_t> m_breedSeeds;       // one per breed chunk
+    bool m_createInBreedJob;
+    std::function<void(const unsigned int&)> m_breedJob;
+    std::atomic<size_t> m_nextBreedChunk;
+
+    bool m_batchedInference;
+    bool m_networkStackValid;
+    NetworkStack m_networkStack;
+    std::vector<Simulation*> m_stackedSims;   // stack column -> simulation
+    std::vector<long> m_stackIndex;           // simulation index -> stack column, -1 if not stacked
+    std::vector<char> m_sensed;               // stack column was sensed in this step
+    NNMatrix m_stackInput;                    // one column per stacked simulation
+    std::function<void(const unsigned int&)> m_actJob;
+    std::atomic<size_t> m_nextActChunk;
     bool m_keepParents;
+    double m_fixedTimeStep;
     SimulationPtr m_fittest;
     std::mutex m_mutex;
 };
@@ -0,0 +1,108 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef EXECUTORHEADER
+#define EXECUTORHEADER
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+/**
+ * A fixed set of threads executing independent tasks from a bounded queue.
+ * Each submitted task gets a future, which becomes ready when the task finished.
+ * In contrast to WorkerPool, a task is executed once by one thread, and the
+ * caller does not wait for it.
+ */
+class Executor
+{
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * Creates the executor and starts its threads.
+     * @param nbrOfThreads Number of threads, at least 1.
+     * @param maxQueueSize Maximum number of tasks waiting for a thread, at least 1.
+     */
+    Executor( const unsigned int& nbrOfThreads, const size_t& maxQueueSize );
+
+    /**
+     * Waits for the running tasks. Queued tasks, which did not start yet,
+     * are discarded. Their futures become ready with a broken promise.
+     */
+    ~Executor();
+
+    /**
+     * Queues the task. If the queue is full, it blocks until there is space.
+     * @param task Task to execute.
+     * @return Future, which is ready when the task finished.
+     */
+    std::shared_future<void> submit( Task task );
+
+    /**
+     * Queues the task, if the queue is not full.
+     * @param task Task to execute.
+     * @param future Future, which is ready when the task finished.
+     * @return True if queued. False if the queue is full.
+     */
+    bool trySubmit( Task task, std::shared_future<void>& future );
+
+    /**
+     * Returns the number of tasks waiting for a thread.
+     */
+    size_t getNbrOfQueuedTasks() const;
+
+    unsigned int getNbrOfThreads() const { return m_nbrOfThreads; }
+
+    size_t getMaxQueueSize() const { return m_maxQueueSize; }
+
+    /**
+     * The executor used by the asynchronous operations of the library. It has
+     * as many threads as hardware threads, but at least two.
+     * @return Library wide executor.
+     */
+    static Executor& global();
+
+private:
+    void threadLoop();
+
+    std::shared_future<void> enqueue( Task& task );
+
+private:
+    const unsigned int m_nbrOfThreads;
+    const size_t m_maxQueueSize;
+    std::vector<std::thread> m_threads;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_spaceAvailable;
+
+    std::deque< std::packaged_task<void()> > m_queue;
+    bool m_stop;
+};
+
+#endif //EXECUTORHEADER
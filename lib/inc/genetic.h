@@ -25,6 +25,8 @@
 #define _GENETIC_H_
 
 #include "network.h"
+#include "population.h"
+#include "xoshiro.h"
 
 #include <memory>
 
@@ -44,8 +46,60 @@ public:
 
     static NetworkPtr crossover( NetworkPtr a, NetworkPtr b, CrossoverMethod method, double mutationRate = 0.0 );
 
+    /**
+     * Seeds the random generator used by the calling thread, if no generator is
+     * passed to crossover() or mutate(). Without seed, it is seeded randomly once.
+     * @param seed Seed.
+     */
+    static void setSeed( const uint64_t& seed );
+
+    /**
+     * Crossover and mutation on a population store: every individual of offspring
+     * becomes a crossover of the individuals a and b of parents. A parameter is
+     * mutated with the probability mutationRate, which replaces it by a normal
+     * distributed random value. Each random 64 bit word decides the crossover of
+     * 64 parameters, which are selected branchless. Mutated parameters are found by
+     * skipping geometrically distributed gaps, so mutation costs in proportion to
+     * the number of mutations.
+     * @param parents Parent population.
+     * @param a Index of the first parent.
+     * @param b Index of the second parent.
+     * @param offspring Population with the same structure as parents. Its size
+     *                  determines the number of offspring.
+     * @param method Crossover method.
+     * @param mutationRate Mutation rate (0.0 - 1.0).
+     * @param rng Random generator. Equally seeded generators give the same offspring.
+     * @return True if successful. Otherwise false.
+     */
+    static bool crossover( const Population& parents, const size_t& a, const size_t& b, Population& offspring,
+                           CrossoverMethod method, double mutationRate, Xoshiro256& rng );
+
+    /**
+     * Same as above, but only the individuals first to first + count - 1 of offspring
+     * are bred. Disjoint ranges can be bred concurrently, each with its own generator.
+     * @param first Index of the first offspring.
+     * @param count Number of offspring.
+     */
+    static bool crossover( const Population& parents, const size_t& a, const size_t& b, Population& offspring,
+                           const size_t& first, const size_t& count, CrossoverMethod method, double mutationRate, Xoshiro256& rng );
+
+    /**
+     * Same as above, with the random generator of the calling thread.
+     */
+    static bool crossover( const Population& parents, const size_t& a, const size_t& b, Population& offspring,
+                           CrossoverMethod method, double mutationRate = 0.0 );
+
+    /**
+     * Mutates every parameter of a population with the probability mutationRate.
+     * A mutated parameter is replaced by a normal distributed random value.
+     * @param population Population.
+     * @param mutationRate Mutation rate (0.0 - 1.0).
+     * @param rng Random generator.
+     */
+    static void mutate( Population& population, double mutationRate, Xoshiro256& rng );
+
 };
 
 
 
-#endif // _GENETIC_H_
\ No newline at end of file
+#endif // _GENETIC_H_
@@ -26,6 +26,7 @@
 
 #include <string>
 #include <Eigen/Dense>
+#include "scalar.h"
 #include <vector>
 
 using namespace std;
@@ -33,12 +34,12 @@ using namespace std;
 class Helpers
 {
 public:
-    static void printVector( const Eigen::VectorXd& vector, const string& name );
-    static void printMatrix( const Eigen::MatrixXd& mat, const string& name );
+    static void printVector( const NNVector& vector, const string& name );
+    static void printMatrix( const NNMatrix& mat, const string& name );
 
-    static void maxElement( const Eigen::MatrixXd& mat, unsigned long& m_idx, unsigned long& n_idx, double& maxVal);
+    static void maxElement( const NNMatrix& mat, unsigned long& m_idx, unsigned long& n_idx, double& maxVal);
 
-    static Eigen::MatrixXd mean( const std::vector<Eigen::MatrixXd>& input );
+    static NNMatrix mean( const std::vector<NNMatrix>& input );
 };
 
 #endif //HELPERSHEADER
@@ -29,8 +29,10 @@
 #include <memory>
 #include <string>
 #include <Eigen/Dense>
+#include "scalar.h"
 
 #include "regularization.h"
+#include "workspace.h"
 
 class CostFunction;
 
@@ -62,7 +64,7 @@ public:
      * @param biases Vector of neuron biases.
      * @param type The layer type
      */
-    Layer( const uint& nbr_of_inputs, const std::vector<Eigen::VectorXd>& weights, const std::vector<double>& biases, const LayerOutputType& type = Sigmoid );
+    Layer( const uint& nbr_of_inputs, const std::vector<NNVector>& weights, const std::vector<double>& biases, const LayerOutputType& type = Sigmoid );
 
     /**
      * Copy-constructor
@@ -80,21 +82,46 @@ public:
      * @param x_in Input signal.
      * @return true if successful.
      */
-    bool feedForward( const Eigen::MatrixXd& x_in );
+    bool feedForward( const Eigen::Ref<const NNMatrix>& x_in );
+
+    /**
+     * Compute the neural layer output signal based on the input signal x_in.
+     * All intermediate results are written to the passed workspace. The layer
+     * itself is not changed.
+     * @param x_in Input signal.
+     * @param ws Workspace receiving the results.
+     * @return true if successful.
+     */
+    bool feedForward( const Eigen::Ref<const NNMatrix>& x_in, LayerWorkspace& ws ) const;
+
+    /**
+     * Allocates the layer's own workspace for batches up to maxBatchSize samples.
+     * Calling this is optional, since the workspace grows on demand. After reserving,
+     * feedforward and backpropagation do not allocate memory anymore.
+     * @param maxBatchSize Maximum number of samples passed at once.
+     */
+    void reserveWorkspace( const long& maxBatchSize );
+
+    /**
+     * Returns the layer's own workspace, which holds the results of the
+     * functions not taking an explicit workspace.
+     * @return Workspace.
+     */
+    const LayerWorkspace& getWorkspace() const { return m_workspace; }
 
     /**
      * Sets the weights-vector in each neuron of this layer.
      * @param weights Vector of neuron weights-vector.
      * @return true if successful
      */
-    bool setWeights( const std::vector<Eigen::VectorXd>& weights );
+    bool setWeights( const std::vector<NNVector>& weights );
 
     /**
      * Sets the weights in this layer.
      * @param weights The weight matrix
      * @return true if successful
      */
-    bool setWeights( const Eigen::MatrixXd& weights );
+    bool setWeights( const NNMatrix& weights );
 
     /**
      * Sets the same weight for all neurons and all intputs
@@ -107,7 +134,7 @@ public:
      * ( see updateWeightMatrixAndBiasVector() )
      * @return
      */
-    const Eigen::MatrixXd& getWeightMatrix() const { return m_weightMatrix; }
+    const NNMatrix& getWeightMatrix() const { return m_weightMatrix; }
 
     /**
      * Sets the bias of each neuron in this layer.
@@ -121,7 +148,7 @@ public:
      * @param biases Vector of neuron biases.
      * @return true if successful
      */
-    bool setBiases(const Eigen::MatrixXd &biases );
+    bool setBiases(const NNMatrix &biases );
 
     /**
      * Sets the same bias for all neurons
@@ -134,7 +161,7 @@ public:
      * ( see updateWeightMatrixAndBiasVector() )
      * @return
      */
-    const Eigen::MatrixXd& getBiasVector() const { return m_biasVector; }
+    const NNMatrix& getBiasVector() const { return m_biasVector; }
 
     /**
      * Resets all weights and biases of each neuron in this layer
@@ -147,13 +174,13 @@ public:
      * after executing feedForward().
      * @return Output activation Vector
      */
-    const Eigen::MatrixXd& getOutputActivation() const { return m_activation_out; }
+    Eigen::Map<const NNMatrix> getOutputActivation() const { return m_workspace.getOutputActivation(); }
 
     /**
      * Get the input activation of this layer. This is set after calling feedForward().
      * @return Input activation.
      */
-    const Eigen::MatrixXd& getInputActivation() const { return m_activation_in; }
+    Eigen::Map<const NNMatrix> getInputActivation() const { return m_workspace.getInputActivation(); }
 
     /**
      * This is an intermediate result of calling feedForward(). It is the weighted input,
@@ -161,7 +188,7 @@ public:
      * function.
      * @return weighted input.
      */
-    const Eigen::MatrixXd& getWeightedInputZ() const { return m_z_weighted_input; }
+    Eigen::Map<const NNMatrix> getWeightedInputZ() const { return m_workspace.getWeightedInputZ(); }
 
     /**
      * This function computes the backpropagation error in case this is the output layer.
@@ -169,7 +196,15 @@ public:
      * @param expectedNetworkOutput The desired network output.
      * @return Return true if operation was successful. Otherwise false
      */
-    bool computeBackpropagationOutputLayerError( const Eigen::MatrixXd& expectedNetworkOutput );
+    bool computeBackpropagationOutputLayerError( const Eigen::Ref<const NNMatrix>& expectedNetworkOutput );
+
+    /**
+     * Computes the backpropagation error and cost of the output layer within the passed workspace.
+     * @param expectedNetworkOutput The desired network output.
+     * @param ws Workspace holding the results of feedForward().
+     * @return Return true if operation was successful. Otherwise false
+     */
+    bool computeBackpropagationOutputLayerError( const Eigen::Ref<const NNMatrix>& expectedNetworkOutput, LayerWorkspace& ws ) const;
 
     /**
      * Computes the backpropagation error in this layer. The backpropagation error can be accessed
@@ -177,19 +212,40 @@ public:
      * @param expectedNetworkOutput The desired network output.
      * @return Return true if operation was successful. Otherwise false
      */
-    bool computeBackprogationError(const Eigen::MatrixXd& errorNextLayer, const Eigen::MatrixXd& weightMatrixNextLayer );
+    bool computeBackprogationError( const Eigen::Ref<const NNMatrix>& errorNextLayer, const Eigen::Ref<const NNMatrix>& weightMatrixNextLayer );
+
+    /**
+     * Computes the backpropagation error in this layer within the passed workspace.
+     * @param errorNextLayer Backpropagation error of the next layer.
+     * @param weightMatrixNextLayer Weight matrix of the next layer.
+     * @param ws Workspace holding the results of feedForward().
+     * @return Return true if operation was successful. Otherwise false
+     */
+    bool computeBackprogationError( const Eigen::Ref<const NNMatrix>& errorNextLayer, const Eigen::Ref<const NNMatrix>& weightMatrixNextLayer,
+                                    LayerWorkspace& ws ) const;
 
     /**
-     * Computes the partial derivatives of the biases and weights. Results can be
-     * accessed by getPartialDerivativesBiases() and getPartialDerivativesWeights().
+     * Computes the partial derivatives of the biases and weights, summed over all passed
+     * samples. Results can be accessed by getPartialDerivativesBiasesSum() and
+     * getPartialDerivativesWeightsSum(). If per-sample derivatives are enabled
+     * (see setPerSampleDerivatives()), the derivatives of each sample are additionally
+     * accessible by getPartialDerivativesBiases() and getPartialDerivativesWeights().
      */
     void computePartialDerivatives();
 
+    /**
+     * Computes the partial derivatives of the biases and weights within the passed workspace.
+     * @param ws Workspace holding the backpropagation error.
+     */
+    void computePartialDerivatives( LayerWorkspace& ws ) const;
+
     /**
      * Updates the biases and weights within this layer based on the computed
      * derivatives and the learning rate.
      * @param eta Learning rate
-     * @param sampleIdx Based on which sample's partial derivatives the weights and biases should be updated
+     * @param sampleIdx Based on which sample's partial derivatives the weights and biases should be updated.
+     *                  This is only considered if per-sample derivatives are enabled. Otherwise the
+     *                  summed derivatives are applied.
      */
     void updateWeightsAndBiases( const double& eta, const unsigned int& sampleIdx = 0  );
 
@@ -199,7 +255,17 @@ public:
      * @param deltaWeight
      * @param eta Learning rate
      */
-    void updateWeightsAndBiases(const Eigen::MatrixXd &deltaBias, const Eigen::MatrixXd& deltaWeight, const double& eta );
+    void updateWeightsAndBiases( const Eigen::Ref<const NNMatrix>& deltaBias, const Eigen::Ref<const NNMatrix>& deltaWeight, const double& eta );
+
+    /**
+     * Updates the biases and weights within this layer by the summed partial derivatives
+     * in the passed workspace, averaged over the number of samples, and the learning rate.
+     * The update is done in place.
+     * @param ws Workspace holding the summed partial derivatives.
+     * @param eta Learning rate
+     * @param nbrOfSamples Number of samples the derivatives were summed over.
+     */
+    void updateWeightsAndBiasesAveraged( const LayerWorkspace& ws, const double& eta, const long& nbrOfSamples );
 
     /**
      * Returns the computed backprogation error in this layer. Each column of the returned
@@ -207,23 +273,53 @@ public:
      * the matrix has the form of m x 1 ( a vector).
      * @return
      */
-    const Eigen::MatrixXd getBackpropagationError() const { return m_backpropagationError; }
+    Eigen::Map<const NNMatrix> getBackpropagationError() const { return m_workspace.getBackpropagationError(); }
 
-    double getCost() const { return m_outputLayerCost; }
+    double getCost() const { return m_workspace.getCost(); }
 
     /**
-     * Partial derivatives of the biases. This is set after calling computePartialDerivatives().
-     * The vector holds the derivatives for each passed sample.
+     * Partial derivatives of the biases, summed over all passed samples. This is set
+     * after calling computePartialDerivatives().
+     * @return Vector of size m x 1
+     */
+    const NNMatrix& getPartialDerivativesBiasesSum() const { return m_workspace.getPartialDerivativesBiasesSum(); }
+
+    /**
+     * Partial derivatives of the weights, summed over all passed samples. This is set
+     * after calling computePartialDerivatives(). It is computed at once as delta * a_in^T.
+     * @return Matrix of size m x n, same as the weight matrix.
+     */
+    const NNMatrix& getPartialDerivativesWeightsSum() const { return m_workspace.getPartialDerivativesWeightsSum(); }
+
+    /**
+     * Partial derivatives of the biases. This is set after calling computePartialDerivatives()
+     * and only if per-sample derivatives are enabled. The vector holds the derivatives for
+     * each passed sample.
      * @return
      */
-    const std::vector<Eigen::MatrixXd>& getPartialDerivativesBiases() const { return m_bias_partialDerivatives; }
+    const std::vector<NNMatrix>& getPartialDerivativesBiases() const { return m_workspace.getPartialDerivativesBiases(); }
 
     /**
-     * Partial derivatives of weights. This is set after calling computePartialDerivatives().
-     * The vector holds the derivatives for each passed sample.
+     * Partial derivatives of weights. This is set after calling computePartialDerivatives()
+     * and only if per-sample derivatives are enabled. The vector holds the derivatives for
+     * each passed sample.
      * @return
      */
-    const std::vector<Eigen::MatrixXd>& getPartialDerivativesWeights() const { return m_weight_partialDerivatives; }
+    const std::vector<NNMatrix>& getPartialDerivativesWeights() const { return m_workspace.getPartialDerivativesWeights(); }
+
+    /**
+     * Enable or disable keeping the partial derivatives of each sample. This is meant
+     * for debugging, since it allocates one weight matrix per sample. By default,
+     * only the summed derivatives are computed.
+     * @param enable True or false.
+     */
+    void setPerSampleDerivatives( const bool& enable ) { m_perSampleDerivatives = enable; }
+
+    /**
+     * Are the partial derivatives of each sample kept.
+     * @return True if enabled. False if disabled.
+     */
+    bool isPerSampleDerivativesEnabled() const { return m_perSampleDerivatives; }
 
     /**
      * Set the cost function. This is only relevant in the output layer while learning.
@@ -289,6 +385,12 @@ public:
 private:
     void initLayer();
 
+    // Tile size of the fused forward kernel: a tile of z (262144 doubles = 2MB) is still
+    // in L2 cache when the activation reads it. Tiles are at least FusedTileMinCols samples
+    // wide, narrower tiles slow down the matrix product, which packs the weights per tile.
+    static constexpr long FusedTileElements = 262144;
+    static constexpr long FusedTileMinCols = 1024;
+
     /**
      * Sets directly the activation output of this layer.
      * This function is called by the network for the
@@ -296,7 +398,8 @@ private:
      * @param activation_out
      * @return True if successful.
      */
-    bool setActivationOutput(const Eigen::MatrixXd &activation_out );
+    bool setActivationOutput( const Eigen::Ref<const NNMatrix>& activation_out );
+    bool setActivationOutput( const Eigen::Ref<const NNMatrix>& activation_out, LayerWorkspace& ws ) const;
 
 
 private:
@@ -304,17 +407,11 @@ private:
     unsigned int m_nbr_of_inputs;
     LayerOutputType    m_layer_type;
 
-    Eigen::MatrixXd m_activation_in;
-    Eigen::MatrixXd m_activation_out;
-    Eigen::MatrixXd m_z_weighted_input;
-
-    Eigen::MatrixXd m_backpropagationError;
-    double m_outputLayerCost;
-    Eigen::MatrixXd m_weightMatrix;
-    Eigen::MatrixXd m_biasVector;
+    NNMatrix m_weightMatrix;
+    NNMatrix m_biasVector;
 
-    std::vector<Eigen::MatrixXd> m_bias_partialDerivatives;
-    std::vector<Eigen::MatrixXd> m_weight_partialDerivatives;
+    LayerWorkspace m_workspace;
+    bool m_perSampleDerivatives;
 
     std::shared_ptr<CostFunction> m_costFunction;
 
@@ -27,11 +27,20 @@
 #include <vector>
 #include <memory>
 #include <thread>
+#include <future>
 #include <atomic>
+#include <random>
+#include <functional>
 #include <Eigen/Dense>
+#include "scalar.h"
 
 #include "network_cb.h"
 #include "regularization.h"
+#include "workspace.h"
+#include "dataset.h"
+#include "workerpool.h"
+#include "batchprefetcher.h"
+#include "executor.h"
 
 
 #define NetworkPtr std::shared_ptr<Network>
@@ -73,14 +82,43 @@ public:
      * @param x_in Input signal.
      * @return true if successful.
      */
-    bool feedForward(const Eigen::MatrixXd &x_in );
+    bool feedForward( const Eigen::Ref<const NNMatrix>& x_in );
+
+    /**
+     * Compute the neural network output signal based on the input signal x_in, without
+     * changing the network. All intermediate results are written to the caller owned
+     * workspace, where the output signal can be accessed with NetworkWorkspace::getOutputActivation().
+     * Many threads can feedforward through the same network concurrently, each with its
+     * own workspace, as long as the network is not trained at the same time.
+     * @param x_in Input signal.
+     * @param ws Workspace of the caller.
+     * @return true if successful.
+     */
+    bool feedForward( const Eigen::Ref<const NNMatrix>& x_in, NetworkWorkspace& ws ) const;
+
+    /**
+     * Creates a workspace for feedForward( x_in, ws ), which holds batches up to
+     * maxBatchSize samples without allocating memory.
+     * @param maxBatchSize Maximum number of samples passed at once.
+     * @return Workspace.
+     */
+    NetworkWorkspace createWorkspace( const long& maxBatchSize = 1 ) const;
 
     /**
      * Get the output activation of this neural network. This function is usually
-     * called after feedForward() is executed.
+     * called after feedForward() is executed. The returned view is valid until the
+     * next operation on this network.
      * @return Output activation vector.
      */
-    const Eigen::MatrixXd& getOutputActivation() const { return m_activation_out; }
+    Eigen::Map<const NNMatrix> getOutputActivation() const;
+
+    /**
+     * Allocates the workspaces of all layers for batches up to maxBatchSize samples.
+     * Afterwards, feedForward(), gradientDescent() and stochasticGradientDescent() do
+     * not allocate memory as long as the batches do not exceed maxBatchSize.
+     * @param maxBatchSize Maximum number of samples passed at once.
+     */
+    void reserveWorkspace( const long& maxBatchSize );
 
     /**
      * Returns the number of layers.
@@ -111,7 +149,7 @@ public:
      * @param eta Learning rate.
      * @return true if successful.
      */
-    bool gradientDescent(const Eigen::MatrixXd &x_in, const Eigen::MatrixXd &y_out, const double& eta);
+    bool gradientDescent( const Eigen::Ref<const NNMatrix>& x_in, const Eigen::Ref<const NNMatrix>& y_out, const double& eta );
 
     /**
      * Feedforward, backpropagate and update weigths and biases in each layer corresponding
@@ -126,9 +164,46 @@ public:
      * @param eta
      * @return true if successful.
      */
-    bool stochasticGradientDescent(const std::vector<Eigen::MatrixXd> &samples, const std::vector<Eigen::MatrixXd> &lables,
+    bool stochasticGradientDescent(const std::vector<NNMatrix> &samples, const std::vector<NNMatrix> &lables,
                                    const unsigned int& batchsize, const double& eta);
 
+    /**
+     * Same as above, but the samples are taken from a contiguous dataset. The batches
+     * are gathered by copying whole columns, without any allocation.
+     * @param dataset Input signals and desired output signals.
+     * @param batchsize Number of samples in the batch.
+     * @param eta Learning rate.
+     * @return true if successful.
+     */
+    bool stochasticGradientDescent( const Dataset& dataset, const unsigned int& batchsize, const double& eta );
+
+    /**
+     * Asynchronous variant of stochasticGradientDescent() in the style of Hogwild!. Each worker
+     * thread (see setNumberOfThreads()) repeatedly takes the next batch of the shared random
+     * permutation, computes its partial derivatives in its own workspace and updates the shared
+     * weights and biases directly, without any locking. Workers may therefore read weights which
+     * are partially updated by another worker. This is tolerated by the method in exchange of
+     * throughput scaling. The result is not deterministic, even for a fixed sample order.
+     * Per worker throughput is reported by NetworkOperationCallback::networkWorkerThroughput().
+     * @see setCostFunction
+     * @param samples Input signals.
+     * @param lables Desired output signals.
+     * @param batchsize Number of samples in the batch.
+     * @param eta Learning rate.
+     * @return true if successful.
+     */
+    bool stochasticGradientDescentHogwild( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
+                                           const unsigned int& batchsize, const double& eta );
+
+    /**
+     * Same as above, but the samples are taken from a contiguous dataset.
+     * @param dataset Input signals and desired output signals.
+     * @param batchsize Number of samples in the batch.
+     * @param eta Learning rate.
+     * @return true if successful.
+     */
+    bool stochasticGradientDescentHogwild( const Dataset& dataset, const unsigned int& batchsize, const double& eta );
+
     /**
      * Feedforward, backpropagate and update weigths and biases in each layer corresponding
      * to the computed partial derivatives and the stochastic gradient descent method.
@@ -136,6 +211,8 @@ public:
      * partial derivatives of a randomly chosen batch of samples. In total, nbrOfSamples / batchsize
      * batches are executed -> this is called an epoch. The computation is performed in another
      * thread. The user gets informed over the NetworkOperationCallback interface.
+     * Note, the samples and lables are copied for the computation thread. Pass them
+     * as shared pointers or as dataset to avoid this copy.
      * @see setCostFunction
      * @param samples Input signals.
      * @param lables Desired output signals.
@@ -144,11 +221,36 @@ public:
      * @param userId User given id.
      * @return true if successful.
      */
-    bool stochasticGradientDescentAsync(const std::vector<Eigen::MatrixXd> &samples, const std::vector<Eigen::MatrixXd> &lables,
+    bool stochasticGradientDescentAsync(const std::vector<NNMatrix> &samples, const std::vector<NNMatrix> &lables,
                                         const unsigned int& batchsize, const double& eta, const int& userId );
 
     /**
-     * Tests the network with given samples and lables.
+     * Same as above, but the samples and lables are shared with the computation
+     * thread, and not copied. They must not be changed until the operation finished.
+     * @param samples Input signals.
+     * @param lables Desired output signals.
+     * @param batchsize Number of samples in the batch.
+     * @param eta Learning rate.
+     * @param userId User given id.
+     * @return true if successful.
+     */
+    bool stochasticGradientDescentAsync( std::shared_ptr<const std::vector<NNMatrix>> samples, std::shared_ptr<const std::vector<NNMatrix>> lables,
+                                         const unsigned int& batchsize, const double& eta, const int& userId );
+
+    /**
+     * Same as above, but the samples are taken from a contiguous dataset. The dataset
+     * storage is shared with the computation thread, and not copied.
+     * @param dataset Input signals and desired output signals.
+     * @param batchsize Number of samples in the batch.
+     * @param eta Learning rate.
+     * @param userId User given id.
+     * @return true if successful.
+     */
+    bool stochasticGradientDescentAsync( const Dataset& dataset, const unsigned int& batchsize, const double& eta, const int& userId );
+
+    /**
+     * Tests the network with given samples and lables. The samples are feedforwarded
+     * in batches, which are distributed among the threads set by setNumberOfThreads().
      * @param samples Input sample.
      * @param lables Expected output.
      * @param euclideanDistanceThreshold The threshold when compareing the Euclidean distance between expected output and actual output signal.
@@ -158,22 +260,60 @@ public:
      * @param failedSamplesIdx Vector of sample indices which were NOT successful.
      * @return True if successful. Otherwise false.
      */
-    bool testNetwork( const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+    bool testNetwork( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
                       const double& euclideanDistanceThreshold, bool doCallback, double& successRateEuclideanDistance,
                       double& successRateIdenticalMax, double& averageCost, std::vector<size_t>& failedSamplesIdx );
 
+    /**
+     * Tests the network with the samples of a contiguous dataset. The batches are
+     * feedforwarded directly from the dataset, without copying.
+     * @param dataset Input samples and expected outputs.
+     * @param euclideanDistanceThreshold The threshold when compareing the Euclidean distance between expected output and actual output signal.
+     * @param successRateEuclideanDistance Success rate of testing the Euclidean distance.
+     * @param successRateIdenticalMax Success rate when testing that the maximum elements are identical.
+     * @param averageCost Average cost
+     * @param failedSamplesIdx Vector of sample indices which were NOT successful.
+     * @return True if successful. Otherwise false.
+     */
+    bool testNetwork( const Dataset& dataset, const double& euclideanDistanceThreshold, bool doCallback, double& successRateEuclideanDistance,
+                      double& successRateIdenticalMax, double& averageCost, std::vector<size_t>& failedSamplesIdx );
+
     /**
      * Tests the network with given samples and lables. The computation is performed in another
      * thread. The user gets informed over the NetworkOperationCallback interface.
+     * Note, the samples and lables are copied for the computation thread. Pass them
+     * as shared pointers or as dataset to avoid this copy.
+     * @param samples Input sample.
+     * @param lables Expected output.
+     * @param euclideanDistanceThreshold The threshold when compareing the Euclidean distance between expected output and actual output signal.
+     * @param userId User given id.
+     * @return True if successful. Otherwise false.
+     */
+    bool testNetworkAsync( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
+                           const double& euclideanDistanceThreshold, const int& userId );
+
+    /**
+     * Same as above, but the samples and lables are shared with the computation
+     * thread, and not copied. They must not be changed until the operation finished.
      * @param samples Input sample.
      * @param lables Expected output.
      * @param euclideanDistanceThreshold The threshold when compareing the Euclidean distance between expected output and actual output signal.
      * @param userId User given id.
      * @return True if successful. Otherwise false.
      */
-    bool testNetworkAsync( const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+    bool testNetworkAsync( std::shared_ptr<const std::vector<NNMatrix>> samples, std::shared_ptr<const std::vector<NNMatrix>> lables,
                            const double& euclideanDistanceThreshold, const int& userId );
 
+    /**
+     * Same as above, but the samples are taken from a contiguous dataset. The dataset
+     * storage is shared with the computation thread, and not copied.
+     * @param dataset Input samples and expected outputs.
+     * @param euclideanDistanceThreshold The threshold when compareing the Euclidean distance between expected output and actual output signal.
+     * @param userId User given id.
+     * @return True if successful. Otherwise false.
+     */
+    bool testNetworkAsync( const Dataset& dataset, const double& euclideanDistanceThreshold, const int& userId );
+
     /**
      * Returns the magnitude of the error vector in the output layer. This error is
      * initialized during the backpropagation.
@@ -195,10 +335,32 @@ public:
     void setObserver( NetworkOperationCallback* observer ) { m_oberserver = observer; }
 
     /**
-    * Return a handle to the current NN operation thread.
-    * @return Handle to compuation thread.
-    */
-    std::thread& getCurrentAsyncOperation() { return m_asyncOperation; }
+     * Returns the future of the current or last asynchronous operation. It becomes
+     * ready when the operation finished. The operations are executed by the executor
+     * set with setExecutor().
+     * @return Future of the operation.
+     */
+    std::shared_future<void> getCurrentAsyncOperation() const { return m_asyncOperation; }
+
+    /**
+     * Requests the current asynchronous operation to stop. It is cancelled before
+     * the next batch or test sample, or before it starts if it is still queued. The
+     * observer is informed with the status OpResultCancelled. This does not block.
+     */
+    void cancelAsyncOperation();
+
+    /**
+     * Sets the executor running the asynchronous operations. By default, this
+     * is Executor::global(). If the executor queue is full, an asynchronous
+     * operation is refused. The executor needs to outlive the network.
+     * @param executor Executor. If null, the global one is used.
+     */
+    void setExecutor( Executor* executor );
+
+    /**
+     * Returns the executor running the asynchronous operations.
+     */
+    Executor* getExecutor() const { return m_executor; }
 
     /**
      * Indicates if an asynchronous operation is ongoing or not.
@@ -257,6 +419,59 @@ public:
      */
     bool isSoftmaxOutputEnabled() const;
 
+    /**
+     * Enable or disable keeping the partial derivatives of each sample in
+     * all layers. This is meant for debugging. See Layer::setPerSampleDerivatives().
+     * @param enable True or false.
+     */
+    void setPerSampleDerivatives( const bool& enable );
+
+    /**
+     * Sets the number of threads used in stochasticGradientDescent(). Each batch is split
+     * into shards, which are feedforwarded and backpropagated concurrently, each in its own
+     * workspace. The partial derivatives of all shards are summed up before the weights and
+     * biases are updated. Hence, the result equals the single threaded one up to floating-point
+     * reordering. Note, after a multi-threaded batch, the layer results like activation
+     * and backpropagation error belong to the first shard only. The threads are used
+     * by testNetwork() as well.
+     * @param nbrOfThreads Number of threads. If 0, the number of hardware threads is used.
+     */
+    void setNumberOfThreads( const unsigned int& nbrOfThreads );
+
+    /**
+     * Returns the number of threads used in stochasticGradientDescent().
+     * @return Number of threads.
+     */
+    unsigned int getNumberOfThreads() const { return m_nbrOfThreads; }
+
+    /**
+     * Transformation applied to every batch before it is trained, like a normalization
+     * or a data augmentation. It may change the values of the batch, but not its dimension.
+     */
+    typedef std::function<void( NNMatrix& batch_in, NNMatrix& batch_out )> BatchTransform;
+
+    /**
+     * Sets the transformation applied to every batch in stochasticGradientDescent() and
+     * stochasticGradientDescentHogwild(). With prefetching or Hogwild!, the transformation
+     * is called from another thread, and concurrently in the Hogwild! case. Hence, it has
+     * to be thread-safe.
+     * @param transform Transformation. An empty function disables it.
+     */
+    void setBatchTransform( const BatchTransform& transform );
+
+    /**
+     * Enable or disable batch prefetching in stochasticGradientDescent(). If enabled, a loader
+     * thread gathers and transforms the next batch into a second buffer while the current
+     * batch is trained. The result is identical to the one without prefetching.
+     * @param enable True or false.
+     */
+    void setBatchPrefetching( const bool& enable );
+
+    /**
+     * Returns true if batch prefetching is enabled.
+     */
+    bool isBatchPrefetchingEnabled() const { return m_batchPrefetcher != nullptr; }
+
     void print();
 
     /**
@@ -293,30 +508,99 @@ public:
 
 private:
 
+    // Copies the samples with the passed indices into batch_in and batch_out.
+    typedef std::function<void( const size_t* sampleIdx, const unsigned int& count, NNMatrix& batch_in, NNMatrix& batch_out )> BatchGatherer;
+
+    // Provides the samples [begin, begin + count) as contiguous columns: either points into
+    // the sample storage directly, or copies the samples into the passed buffers.
+    typedef std::function<void( const size_t& begin, const unsigned int& count, NNMatrix& buffer_in, NNMatrix& buffer_out,
+                                const NNScalar*& batch_in, const NNScalar*& batch_out )> SampleRange;
+
+    // Number of samples feedforwarded at once in testNetwork().
+    static constexpr size_t TestBatchSize = 256;
+
     void initNetwork();
 
+    // The workspace of layer layerIdx: either in ws, or the layer's own one if ws is null.
+    // Not const -> the layers' own workspaces are only handed out to non-const callers.
+    LayerWorkspace& getLayerWorkspace( const unsigned int& layerIdx, NetworkWorkspace* ws );
+
+    // Feedforward in ws, or in the layers' own workspaces if ws is null.
+    bool doFeedForward( const Eigen::Ref<const NNMatrix>& x_in, NetworkWorkspace* ws );
+
+    // Feeds x_in through all layers. workspaceOf(k) returns the workspace of layer k.
+    template <typename WorkspaceOf>
+    bool feedForwardLayers( const Eigen::Ref<const NNMatrix>& x_in, WorkspaceOf workspaceOf ) const;
+
     // Do feedforward and backprop. but weights and biases are not updated!
-    bool doFeedforwardAndBackpropagation(const Eigen::MatrixXd &x_in, const Eigen::MatrixXd &y_out );
+    bool doFeedforwardAndBackpropagation( const Eigen::Ref<const NNMatrix>& x_in, const Eigen::Ref<const NNMatrix>& y_out,
+                                          NetworkWorkspace* ws = nullptr );
+
+    // Same as above, but the samples are split among the worker threads. The results are reduced
+    // into the layers' own workspaces.
+    bool doParallelFeedforwardAndBackpropagation( const Eigen::Ref<const NNMatrix>& x_in, const Eigen::Ref<const NNMatrix>& y_out );
 
-    bool doStochasticGradientDescentBatch(const Eigen::MatrixXd& batch_in, const Eigen::MatrixXd& batch_out, const double& eta);
+    void updateRegularization( const long& nbrOfSamples );
+
+    bool checkTrainingSet( const size_t& nbrOfSamples, const size_t& nbrOfLables, const unsigned int& batchsize ) const;
+
+    // One epoch, independent of how the samples are stored.
+    bool doStochasticGradientDescent( const size_t& nbrOfSamples, const unsigned int& batchsize, const double& eta, const BatchGatherer& gather );
+    bool doStochasticGradientDescentHogwild( const size_t& nbrOfSamples, const unsigned int& batchsize, const double& eta, const BatchGatherer& gather );
+    bool doTestNetwork( const size_t& nbrOfTestSamples, const SampleRange& range,
+                        const double& euclideanDistanceThreshold, bool doCallback, double& successRateEuclideanDistance,
+                        double& successRateIdenticalMax, double& avgCost, std::vector<size_t>& failedSamplesIdx );
+
+    void shuffleSampleOrder( const size_t& nbrOfSamples );
+
+    // makes sure there is a workspace for each worker other than worker 0
+    void prepareWorkerWorkspaces( const unsigned int& nbrOfWorkers );
+
+    bool doStochasticGradientDescentBatch( const Eigen::Ref<const NNMatrix>& batch_in, const Eigen::Ref<const NNMatrix>& batch_out, const double& eta );
 
     void sendProg2Obs( const NetworkOperationCallback::NetworkOperationId& opId,
                        const NetworkOperationCallback::NetworkOperationStatus& opStatus, const double& progress  );
 
-    bool prepareForNextAsynchronousOperation();
+    // Queues the operation in the executor, if no other operation is in progress.
+    bool submitAsynchronousOperation( const int& userId, const Executor::Task& operation );
+
+    // True if the currently running asynchronous operation was cancelled.
+    bool isCancelRequested() const;
 
-    void doTestAsync( const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+    void doTestAsync( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
                       const double& euclideanDistanceThreshold );
+    void doTestAsync( const Dataset& dataset, const double& euclideanDistanceThreshold );
+    void sendTestResults2Obs( const bool& res, const double& successRateEuclidean, const double& successRateMaxIdx,
+                              const double& avgCost, const std::vector<size_t>& failedSamples );
 
 private:
 
     const std::vector<unsigned int> m_NetworkStructure;
     std::vector< std::shared_ptr<Layer> > m_Layers;
-    Eigen::MatrixXd m_activation_out;
+
+    // reused between epochs of stochasticGradientDescent()
+    std::vector<size_t> m_sampleOrder;
+    NNMatrix m_batch_in;
+    NNMatrix m_batch_out;
+    std::mt19937 m_shuffleGenerator;
+    BatchTransform m_batchTransform;
+    std::unique_ptr<BatchPrefetcher> m_batchPrefetcher;
+
+    unsigned int m_nbrOfThreads;
+    std::unique_ptr<WorkerPool> m_workerPool;
+    std::vector<NetworkWorkspace> m_workerWorkspaces; // workers 1..n, worker 0 uses the layers' workspaces
+    std::vector<char> m_workerResults;
+    std::vector<NNMatrix> m_workerBatchIn;
+    std::vector<NNMatrix> m_workerBatchOut;
+    std::vector<double> m_workerThroughput;
 
     NetworkOperationCallback* m_oberserver;
-    std::thread m_asyncOperation;
+    Executor* m_executor;
+    std::shared_future<void> m_asyncOperation;
     std::atomic<bool> m_operationInProgress;
+    std::atomic<unsigned long> m_operationCounter;   // id of the last submitted operation
+    std::atomic<unsigned long> m_runningOperation;   // id of the running operation, 0 if none
+    std::atomic<unsigned long> m_cancelledOperation; // id of the last cancelled operation
 
     std::shared_ptr<Regularization> m_regularization;
 
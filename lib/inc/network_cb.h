@@ -33,14 +33,16 @@ public:
     enum NetworkOperationId
     {
         OpStochasticGradientDescent = 0x00,
-        OpTestNetwork
+        OpTestNetwork,
+        OpStochasticGradientDescentHogwild
     };
 
     enum NetworkOperationStatus
     {
         OpResultOk = 0x00,
         OpResultErr,
-        OpInProgress
+        OpInProgress,
+        OpResultCancelled
     };
 
 public:
@@ -68,6 +70,16 @@ public:
                                      const double& averageCost,
                                      const std::vector<std::size_t>& failedSamplesIdx, const int& userId) = 0;
 
+    /**
+     * Callback function which informs about the throughput of each worker thread. It is
+     * called at the end of a multi-threaded operation. The default implementation ignores it.
+     * @param opId Operation ID.
+     * @param samplesPerSecond Processed samples per second, one entry per worker thread.
+     * @param userId User given id.
+     */
+    virtual void networkWorkerThroughput( const NetworkOperationId& /*opId*/, const std::vector<double>& /*samplesPerSecond*/,
+                                          const int& /*userId*/ ) {}
+
 };
 
 #endif // NETWORKCALLBACKHEADER
@@ -0,0 +1,101 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef NETWORKSTACKHEADER
+#define NETWORKSTACKHEADER
+
+#include <vector>
+#include <Eigen/Dense>
+#include "scalar.h"
+#include "population.h"
+
+class Network;
+
+/**
+ * Feedforwards many networks of the same structure at once, each with its own
+ * input. The networks are held in a Population: for each weight, the values of
+ * all networks are stored contiguously. A layer is then computed as a sequence of
+ * vectorized multiply-adds running across all networks, instead of one small
+ * matrix-vector product per network.
+ */
+class NetworkStack
+{
+public:
+    NetworkStack();
+    ~NetworkStack();
+
+    /**
+     * Copies the weights and biases of the passed networks into the stack. The
+     * networks are not referenced afterwards.
+     * @param networks Networks with identical structure and layer types.
+     * @return True if successful. False if the networks differ in structure.
+     */
+    bool setNetworks( const std::vector<const Network*>& networks );
+
+    /**
+     * Copies the individuals idx of a population into the stack, in the given order.
+     * Network n of the stack is individual idx[n].
+     * @param population Population.
+     * @param idx Indices of the individuals.
+     */
+    void setPopulation( const Population& population, const std::vector<size_t>& idx );
+
+    /**
+     * Number of stacked networks.
+     */
+    size_t getNumberOfNetworks() const { return m_population.getNumberOfIndividuals(); }
+
+    /**
+     * Structure of the stacked networks, empty if none are set.
+     */
+    const std::vector<unsigned int>& getNetworkStructure() const { return m_population.getNetworkStructure(); }
+
+    /**
+     * Feedforwards column n of x_in through network n.
+     * @param x_in Input, one column per network.
+     * @return True if successful.
+     */
+    bool feedForward( const Eigen::Ref<const NNMatrix>& x_in );
+
+    /**
+     * Output of the last feedforward, one column per network.
+     */
+    const NNMatrix& getOutputActivation() const { return m_output; }
+
+    /**
+     * Checks if two networks have the same structure and layer types.
+     */
+    static bool isSameStructure( const Network& a, const Network& b );
+
+private:
+    void reserveActivations();
+
+private:
+    Population m_population;
+    std::vector<NNMatrix> m_activations; // column j holds the activation of neuron j of all networks
+
+    NNMatrix m_input;  // one row per network
+    NNMatrix m_output; // one column per network
+};
+
+#endif //NETWORKSTACKHEADER
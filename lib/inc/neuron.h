@@ -25,6 +25,7 @@
 #define NEURONHEADER
 
 #include <Eigen/Dense>
+#include "scalar.h"
 
 class Neuron
 {
@@ -41,13 +42,21 @@ public:
     */
     static double d_sigmoid(const double &z );
 
+    /**
+     * Computes the sigmoid function component wise for each element in z.
+     * The computation is vectorized. z and a may be the same matrix.
+     * @param z Input matrix.
+     * @param a Output matrix of the same size as z.
+     */
+    static void sigmoid( const Eigen::Ref<const NNMatrix>& z, Eigen::Ref<NNMatrix> a );
+
     /**
      * Computes component wise derrivative of the sigmoid function
      * for each component in the vector z.
      * @param z Vector in
      * @return Vector holding the result.
      */
-    static const Eigen::MatrixXd d_sigmoid(const Eigen::MatrixXd &z );
+    static const NNMatrix d_sigmoid(const NNMatrix &z );
 };
 
 #endif //NEURONHEADER
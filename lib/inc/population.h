@@ -0,0 +1,171 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef POPULATIONHEADER
+#define POPULATIONHEADER
+
+#include <vector>
+#include <memory>
+#include <Eigen/Dense>
+#include "scalar.h"
+#include "layer.h"
+
+class Network;
+
+/**
+ * Stores the parameters (genomes) of many networks with the same structure
+ * contiguously. For each layer, there is one weight and one bias matrix holding
+ * one row per individual. Weight (j,k) of a layer is in column j * nbrOfInputs + k.
+ * As all individuals are stored along the rows, an operation on the same parameter
+ * of all individuals runs over contiguous memory. This is used by the genetic
+ * operators and by NetworkStack. Network objects are created only on demand.
+ */
+class Population
+{
+public:
+    Population();
+    ~Population();
+
+    /**
+     * Takes the structure and the layer types of the prototype network. The
+     * population is emptied.
+     * @param prototype Network.
+     */
+    void setStructure( const Network& prototype );
+
+    /**
+     * Copies the parameters of the passed networks, one row per network. The
+     * structure is taken from the first network.
+     * @param networks Networks with identical structure and layer types.
+     * @return True if successful. False if the networks differ in structure.
+     */
+    bool setNetworks( const std::vector<const Network*>& networks );
+
+    /**
+     * Sets the number of individuals. Existing individuals are kept, added ones
+     * are not initialized.
+     * @param nbrOfIndividuals Number of individuals.
+     */
+    void resize( const size_t& nbrOfIndividuals );
+
+    /**
+     * Number of individuals.
+     */
+    size_t getNumberOfIndividuals() const { return m_nbrOfIndividuals; }
+
+    /**
+     * Structure of the networks, empty if not set.
+     */
+    const std::vector<unsigned int>& getNetworkStructure() const { return m_structure; }
+
+    /**
+     * Number of layers with parameters, the input layer excluded.
+     */
+    size_t getNumberOfLayers() const { return m_layers.size(); }
+
+    /**
+     * Copies the parameters of a network into an individual. The network
+     * has to have the same structure, the layer types are not checked.
+     * @param idx Index of the individual.
+     * @param network Network.
+     * @return True if successful.
+     */
+    bool setGenome( const size_t& idx, const Network& network );
+
+    /**
+     * Copies the parameters of an individual into a network with the same structure.
+     * @param idx Index of the individual.
+     * @param network Network.
+     * @return True if successful.
+     */
+    bool getGenome( const size_t& idx, Network& network ) const;
+
+    /**
+     * Creates a network with the parameters of an individual.
+     * @param idx Index of the individual.
+     * @return Network, or nullptr if the index is invalid.
+     */
+    std::shared_ptr<Network> createNetwork( const size_t& idx ) const;
+
+    /**
+     * Copies the individuals srcIdx of src into this population, in the given order.
+     * The structure is taken from src.
+     * @param src Source population.
+     * @param srcIdx Indices of the individuals in src.
+     */
+    void gather( const Population& src, const std::vector<size_t>& srcIdx );
+
+    /**
+     * Copies individual srcIdx of src to individual dstIdx. Both populations have to
+     * have the same structure.
+     * @return True if successful.
+     */
+    bool copyGenome( const Population& src, const size_t& srcIdx, const size_t& dstIdx );
+
+    /**
+     * Layer type of layer l (1 = first hidden layer).
+     */
+    Layer::LayerOutputType getLayerType( const size_t& l ) const { return layer(l).type; }
+    long getNbrOfNeurons( const size_t& l ) const { return layer(l).nbrOfNeurons; }
+    long getNbrOfInputs( const size_t& l ) const { return layer(l).nbrOfInputs; }
+
+    /**
+     * Weights of layer l (1 = first hidden layer), one row per individual.
+     */
+    NNMatrix& weights( const size_t& l ) { return layer(l).weights; }
+    const NNMatrix& weights( const size_t& l ) const { return layer(l).weights; }
+
+    /**
+     * Biases of layer l (1 = first hidden layer), one row per individual.
+     */
+    NNMatrix& biases( const size_t& l ) { return layer(l).biases; }
+    const NNMatrix& biases( const size_t& l ) const { return layer(l).biases; }
+
+    /**
+     * Checks if two networks have the same structure and layer types.
+     */
+    static bool isSameStructure( const Network& a, const Network& b );
+
+private:
+    struct LayerGenome
+    {
+        Layer::LayerOutputType type;
+        long nbrOfNeurons;
+        long nbrOfInputs;
+        NNMatrix weights;
+        NNMatrix biases;
+    };
+
+    // layer 0 is the input layer, which has no parameters
+    LayerGenome& layer( const size_t& l ) { return m_layers[l - 1]; }
+    const LayerGenome& layer( const size_t& l ) const { return m_layers[l - 1]; }
+
+    bool hasNetworkStructure( const Network& network ) const;
+
+private:
+    std::vector<LayerGenome> m_layers;
+    std::vector<unsigned int> m_structure;
+    size_t m_nbrOfIndividuals;
+};
+
+#endif //POPULATIONHEADER
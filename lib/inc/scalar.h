@@ -0,0 +1,45 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef SCALARHEADER
+#define SCALARHEADER
+
+#include <Eigen/Dense>
+
+/**
+ * Numeric type of weights, biases, activations and all intermediate results.
+ * By default, double precision is used. If EIDNN_SINGLE_PRECISION is defined
+ * (cmake option SINGLEPRECISIONEIDNN), float is used instead: this halves the
+ * memory bandwidth and doubles the SIMD width. Learning rates, costs and the
+ * serialization format stay in double precision.
+ */
+#ifdef EIDNN_SINGLE_PRECISION
+typedef float NNScalar;
+#else
+typedef double NNScalar;
+#endif
+
+typedef Eigen::Matrix<NNScalar, Eigen::Dynamic, Eigen::Dynamic> NNMatrix;
+typedef Eigen::Matrix<NNScalar, Eigen::Dynamic, 1> NNVector;
+
+#endif //SCALARHEADER
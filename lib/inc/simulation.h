@@ -28,6 +28,7 @@
 #include <memory>
 
 #include "network.h"
+#include "population.h"
 
 #define SimulationPtr std::shared_ptr<Simulation>
 
@@ -44,6 +45,28 @@ public:
      */
     void doStep();
 
+    /**
+     * Indicates if the simulation supports the two-phase step sense() -> act(). Such
+     * simulations can be stepped with the network feedforward batched over many
+     * simulations, see Evolution. The default is false.
+     * @return True if sense() and act() are implemented.
+     */
+    virtual bool supportsSenseAct() const;
+
+    /**
+     * First phase of a step: advances the simulation state and writes the input
+     * for the network. The network is not feedforwarded here.
+     * @param input Network input, one column.
+     */
+    virtual void sense( Eigen::Ref<NNMatrix> input );
+
+    /**
+     * Second phase of a step: applies the network output, which corresponds to
+     * the input of the previous sense(). sense() followed by act() equals doStep().
+     * @param output Network output, one column.
+     */
+    void act( const Eigen::Ref<const NNMatrix>& output );
+
     /**
      * Fitness is a measure performance.
      * @return Fitness.
@@ -63,11 +86,26 @@ public:
     virtual void setLastUpdateTime(const std::chrono::milliseconds &lastUpdate);
 
     /**
-     * Time since last update in seconds.
+     * Time since last update in seconds. With a fixed time step, this is the
+     * time step.
      * @return Elapsed time in seconds
      */
     virtual double getTimeSinceLastUpdate() const;
 
+    /**
+     * Sets a fixed time step. Each step then advances the simulated time by dt,
+     * independent of the wall clock. This makes simulations deterministic, and lets
+     * them run as fast as they can be computed.
+     * @param dt Time step in seconds. 0 switches back to the wall clock (default).
+     */
+    void setFixedTimeStep( const double& dt );
+
+    /**
+     * Get the fixed time step.
+     * @return Time step in seconds, or 0 if the wall clock is used.
+     */
+    double getFixedTimeStep() const;
+
     /**
      * Get neuronal network.
      * @return NN
@@ -86,7 +124,8 @@ public:
     virtual bool isAlive() const;
 
     /**
-     * How long was the simulation alive.
+     * How long was the simulation alive. With a fixed time step, this is the
+     * simulated time.
      * @return seconds.
      */
     virtual double getAge() const;
@@ -98,13 +137,23 @@ public:
 
 protected:
 
+    /**
+     * Current time: wall clock, or the simulated time with a fixed time step.
+     */
     std::chrono::milliseconds now() const;
 
     /**
-     * Update the actual simulation.
+     * Update the actual simulation. For simulations supporting sense() and
+     * act(), the default feedforwards the sensed input through the network.
      */
     virtual void update();
 
+    /**
+     * Applies the network output in act().
+     * @param output Network output, one column.
+     */
+    virtual void actuate( const Eigen::Ref<const NNMatrix>& output );
+
 
 protected:
 
@@ -113,6 +162,14 @@ protected:
     std::chrono::milliseconds m_lastUpdate;
     bool m_alive = true;
     NetworkPtr m_network;
+
+    double m_fixedTimeStep = 0.0;   // seconds, 0 -> wall clock
+    double m_simulatedTime = 0.0;   // seconds since creation, with fixed time step
+
+    // Workspace for feedforwarding through m_network. Simulations may share
+    // the same network, but each feedforwards in its own workspace.
+    NetworkWorkspace m_networkWorkspace;
+    NNMatrix m_networkInput;
 };
 
 #define SimFactoryPtr std::shared_ptr<SimulationFactory>
@@ -125,6 +182,23 @@ public:
 
     virtual SimulationPtr createRandomSimulation();
     virtual SimulationPtr createCrossover( SimulationPtr a, SimulationPtr b, double mutationRate );
+
+    /**
+     * Creates a simulation, whose network is created from an individual of a population
+     * store. Evolution breeds with it. The default creates a random simulation and sets
+     * the network. Modifications of the genome have to be applied to the population,
+     * before the network is created.
+     * @param population Population store.
+     * @param idx Index of the individual.
+     * @return Simulation.
+     */
+    virtual SimulationPtr createFromGenome( Population& population, const size_t& idx );
+
+    /**
+     * Indicates if createFromGenome() can be called concurrently for different
+     * individuals. Evolution then creates the offspring in parallel. The default is false.
+     */
+    virtual bool isThreadSafe() const;
     virtual SimulationPtr copy( SimulationPtr a );
 };
 
@@ -0,0 +1,78 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef WORKERPOOLHEADER
+#define WORKERPOOLHEADER
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * A fixed set of threads, which are kept alive between jobs. A job is
+ * executed once by each worker, where the calling thread acts as
+ * worker 0. run() returns when all workers finished the job.
+ */
+class WorkerPool
+{
+public:
+    /**
+     * Creates the pool. nbrOfWorkers - 1 threads are started, since
+     * the calling thread participates.
+     * @param nbrOfWorkers Number of workers, at least 1.
+     */
+    WorkerPool( const unsigned int& nbrOfWorkers );
+
+    ~WorkerPool();
+
+    /**
+     * Executes the job on all workers and blocks until all are done.
+     * @param job Function called with the worker index [0, getNbrOfWorkers()).
+     */
+    void run( const std::function<void(const unsigned int&)>& job );
+
+    /**
+     * Returns the number of workers, including the calling thread.
+     */
+    unsigned int getNbrOfWorkers() const { return m_nbrOfWorkers; }
+
+private:
+    void workerLoop( const unsigned int workerIdx );
+
+private:
+    const unsigned int m_nbrOfWorkers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_jobDone;
+
+    const std::function<void(const unsigned int&)>* m_job;
+    unsigned long m_jobGeneration;
+    unsigned int m_nbrOfPendingWorkers;
+    bool m_stop;
+};
+
+#endif //WORKERPOOLHEADER
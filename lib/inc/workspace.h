@@ -0,0 +1,182 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef WORKSPACEHEADER
+#define WORKSPACEHEADER
+
+#include <vector>
+#include <Eigen/Dense>
+#include "scalar.h"
+
+/**
+ * Holds the intermediate results of a layer: input and output activation,
+ * weighted input, backpropagation error, cost and partial derivatives.
+ * The buffers depending on the number of samples are allocated for a maximum
+ * batch size and reused for every smaller batch. Repeated feedforward and
+ * backpropagation therefore do not allocate memory once the workspace is reserved.
+ */
+class LayerWorkspace
+{
+    friend class Layer;
+    friend class Network;
+
+public:
+    LayerWorkspace();
+    ~LayerWorkspace();
+
+    /**
+     * Makes sure the buffers fit the layer dimension and the batch size. Memory is
+     * only allocated if the layer dimension changed or the batch size exceeds the
+     * already reserved one.
+     * @param nbrOfNeurons Number of neurons in the layer.
+     * @param nbrOfInputs Number of inputs to each neuron.
+     * @param maxBatchSize Maximum number of samples passed at once.
+     */
+    void reserve( const unsigned int& nbrOfNeurons, const unsigned int& nbrOfInputs, const long& maxBatchSize );
+
+    /**
+     * Sets the number of samples currently held. It has to be within the
+     * reserved batch size.
+     * @param batchSize Number of samples.
+     */
+    void setBatchSize( const long& batchSize );
+
+    /**
+     * Returns the number of samples currently held.
+     */
+    long getBatchSize() const { return m_batchSize; }
+
+    /**
+     * Returns the number of samples, which can be held without allocating memory.
+     */
+    long getMaxBatchSize() const { return m_activation_out.cols(); }
+
+    /**
+     * Input activation, one column per sample.
+     */
+    Eigen::Map<const NNMatrix> getInputActivation() const { return view( m_activation_in ); }
+
+    /**
+     * Weighted input z, one column per sample.
+     */
+    Eigen::Map<const NNMatrix> getWeightedInputZ() const { return view( m_z_weighted_input ); }
+
+    /**
+     * Output activation, one column per sample.
+     */
+    Eigen::Map<const NNMatrix> getOutputActivation() const { return view( m_activation_out ); }
+
+    /**
+     * Backpropagation error, one column per sample.
+     */
+    Eigen::Map<const NNMatrix> getBackpropagationError() const { return view( m_backpropagationError ); }
+
+    /**
+     * Cost, if this is the workspace of the output layer.
+     */
+    double getCost() const { return m_outputLayerCost; }
+
+    /**
+     * Partial derivatives of the biases, summed over all samples.
+     */
+    const NNMatrix& getPartialDerivativesBiasesSum() const { return m_bias_partialDerivativesSum; }
+
+    /**
+     * Partial derivatives of the weights, summed over all samples.
+     */
+    const NNMatrix& getPartialDerivativesWeightsSum() const { return m_weight_partialDerivativesSum; }
+
+    /**
+     * Partial derivatives of the biases of each sample (debug only).
+     */
+    const std::vector<NNMatrix>& getPartialDerivativesBiases() const { return m_bias_partialDerivatives; }
+
+    /**
+     * Partial derivatives of the weights of each sample (debug only).
+     */
+    const std::vector<NNMatrix>& getPartialDerivativesWeights() const { return m_weight_partialDerivatives; }
+
+private:
+    Eigen::Map<NNMatrix> inputActivation() { return view( m_activation_in ); }
+    Eigen::Map<NNMatrix> weightedInputZ() { return view( m_z_weighted_input ); }
+    Eigen::Map<NNMatrix> outputActivation() { return view( m_activation_out ); }
+    Eigen::Map<NNMatrix> backpropagationError() { return view( m_backpropagationError ); }
+
+    // the first m_batchSize columns of a buffer -> column major, so they are contiguous
+    Eigen::Map<NNMatrix> view( NNMatrix& buffer ) const
+    {
+        return Eigen::Map<NNMatrix>( buffer.data(), buffer.rows(), m_batchSize );
+    }
+
+    Eigen::Map<const NNMatrix> view( const NNMatrix& buffer ) const
+    {
+        return Eigen::Map<const NNMatrix>( buffer.data(), buffer.rows(), m_batchSize );
+    }
+
+private:
+    long m_batchSize;
+
+    NNMatrix m_activation_in;
+    NNMatrix m_activation_out;
+    NNMatrix m_z_weighted_input;
+    NNMatrix m_backpropagationError;
+    double m_outputLayerCost;
+
+    NNMatrix m_bias_partialDerivativesSum;
+    NNMatrix m_weight_partialDerivativesSum;
+
+    std::vector<NNMatrix> m_bias_partialDerivatives;
+    std::vector<NNMatrix> m_weight_partialDerivatives;
+};
+
+/**
+ * Holds one layer workspace for each layer of a network. It allows to
+ * run feedforward and backpropagation of the same network concurrently,
+ * each in its own workspace.
+ */
+class NetworkWorkspace
+{
+public:
+    NetworkWorkspace( const size_t& nbrOfLayers = 0 ) : m_layers( nbrOfLayers ) {}
+
+    /**
+     * Sets the number of layers.
+     * @param nbrOfLayers Number of layers, including the input layer.
+     */
+    void resize( const size_t& nbrOfLayers ) { m_layers.resize( nbrOfLayers ); }
+
+    size_t size() const { return m_layers.size(); }
+
+    LayerWorkspace& at( const size_t& layerIdx ) { return m_layers.at( layerIdx ); }
+    const LayerWorkspace& at( const size_t& layerIdx ) const { return m_layers.at( layerIdx ); }
+
+    /**
+     * Output activation of the last layer.
+     */
+    Eigen::Map<const NNMatrix> getOutputActivation() const { return m_layers.back().getOutputActivation(); }
+
+private:
+    std::vector<LayerWorkspace> m_layers;
+};
+
+#endif //WORKSPACEHEADER
@@ -0,0 +1,104 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#ifndef XOSHIROHEADER
+#define XOSHIROHEADER
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * Fast pseudo random number generator xoshiro256** by Blackman and Vigna.
+ * It fulfills the requirements of a UniformRandomBitGenerator, and can be
+ * used with the distributions of <random>. Each call returns 64 random bits,
+ * which allows to draw many random decisions at once. The generator is seeded
+ * with a single 64 bit value, the sequence is reproducible.
+ */
+class Xoshiro256
+{
+public:
+    typedef uint64_t result_type;
+
+    /**
+     * Constructor
+     * @param seed Seed, expanded to the internal state with splitmix64.
+     */
+    explicit Xoshiro256( const uint64_t& seed = 0 );
+
+    /**
+     * Reseeds the generator.
+     * @param seed Seed.
+     */
+    void seed( const uint64_t& seed );
+
+    /**
+     * Advances the generator by 2^128 steps. Calling jump() repeatedly on copies
+     * of a generator gives non-overlapping streams.
+     */
+    void jump();
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /**
+     * 64 random bits.
+     */
+    result_type operator()()
+    {
+        const uint64_t result = rotl( m_s[1] * 5, 7 ) * 9;
+        const uint64_t t = m_s[1] << 17;
+
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = rotl( m_s[3], 45 );
+
+        return result;
+    }
+
+    /**
+     * Uniform random value in [0, 1).
+     */
+    double uniform()
+    {
+        return double( (*this)() >> 11 ) * ( 1.0 / 9007199254740992.0 );
+    }
+
+    /**
+     * Standard normal distributed random value (Box-Muller).
+     */
+    double normal();
+
+private:
+    static uint64_t rotl( const uint64_t& x, const int& k )
+    {
+        return ( x << k ) | ( x >> ( 64 - k ) );
+    }
+
+private:
+    uint64_t m_s[4];
+};
+
+#endif //XOSHIROHEADER
@@ -0,0 +1,142 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "batchprefetcher.h"
+
+BatchPrefetcher::BatchPrefetcher() :
+    m_loader( nullptr ),
+    m_nbrOfBatches( 0 ),
+    m_nbrOfLoaded( 0 ),
+    m_nbrOfTaken( 0 ),
+    m_nbrOfReleased( 0 ),
+    m_generation( 0 ),
+    m_busy( false ),
+    m_cancel( false ),
+    m_stop( false )
+{
+    m_thread = std::thread( &BatchPrefetcher::loaderLoop, this );
+}
+
+BatchPrefetcher::~BatchPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_changed.notify_all();
+
+    m_thread.join();
+}
+
+void BatchPrefetcher::start( const size_t& nbrOfBatches, const BatchLoader& loader )
+{
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_changed.wait( lock, [this]{ return !m_busy; } );
+
+        m_loader = &loader;
+        m_nbrOfBatches = nbrOfBatches;
+        m_nbrOfLoaded = 0;
+        m_nbrOfTaken = 0;
+        m_nbrOfReleased = 0;
+        m_cancel = false;
+        m_busy = true;
+        m_generation++;
+    }
+    m_changed.notify_all();
+}
+
+void BatchPrefetcher::next( const NNMatrix*& batch_in, const NNMatrix*& batch_out )
+{
+    size_t batchIdx;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        // the former batch is not used anymore
+        m_nbrOfReleased = m_nbrOfTaken;
+        m_changed.notify_all();
+
+        batchIdx = m_nbrOfTaken;
+        m_changed.wait( lock, [this, batchIdx]{ return m_nbrOfLoaded > batchIdx; } );
+        m_nbrOfTaken++;
+    }
+
+    batch_in = &m_batchIn[batchIdx % 2];
+    batch_out = &m_batchOut[batchIdx % 2];
+}
+
+void BatchPrefetcher::finish()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_cancel = true;
+    m_changed.notify_all();
+    m_changed.wait( lock, [this]{ return !m_busy; } );
+    m_loader = nullptr;
+}
+
+void BatchPrefetcher::loaderLoop()
+{
+    unsigned long lastGeneration = 0;
+
+    for(;;)
+    {
+        const BatchLoader* loader;
+        size_t nbrOfBatches;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_changed.wait( lock, [this, lastGeneration]{ return m_stop || m_generation != lastGeneration; } );
+
+            if( m_stop )
+                return;
+
+            lastGeneration = m_generation;
+            loader = m_loader;
+            nbrOfBatches = m_nbrOfBatches;
+        }
+
+        for( size_t k = 0; k < nbrOfBatches; k++ )
+        {
+            {
+                // double buffer: batch k reuses the buffer of batch k - 2
+                std::unique_lock<std::mutex> lock( m_mutex );
+                m_changed.wait( lock, [this, k]{ return m_cancel || m_stop || k < m_nbrOfReleased + 2; } );
+                if( m_cancel || m_stop )
+                    break;
+            }
+
+            (*loader)( k, m_batchIn[k % 2], m_batchOut[k % 2] );
+
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                m_nbrOfLoaded = k + 1;
+            }
+            m_changed.notify_all();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_busy = false;
+        }
+        m_changed.notify_all();
+    }
+}
@@ -35,20 +35,17 @@ CrossEntropyCost::~CrossEntropyCost()
 
 }
 
-Eigen::MatrixXd CrossEntropyCost::delta(const Eigen::MatrixXd &/*z_weightdInput*/, const Eigen::MatrixXd &a_activation,
-                                        const Eigen::MatrixXd &y_expected) const
+void CrossEntropyCost::delta( const Eigen::Ref<const NNMatrix>& /*z_weightdInput*/, const Eigen::Ref<const NNMatrix>& a_activation,
+                              const Eigen::Ref<const NNMatrix>& y_expected, Eigen::Ref<NNMatrix> delta ) const
 {
-    return a_activation - y_expected;
+    delta = a_activation - y_expected;
 }
 
-double CrossEntropyCost::cost(const Eigen::MatrixXd &a_activation, const Eigen::MatrixXd &y_expected) const
+double CrossEntropyCost::cost( const Eigen::Ref<const NNMatrix>& a_activation, const Eigen::Ref<const NNMatrix>& y_expected ) const
 {
-    Eigen::MatrixXd ones = Eigen::MatrixXd::Constant( y_expected.rows(), y_expected.cols(), 1.0 );
+    // - sum( y * ln(a) + (1-y) * ln(1-a) ), averaged over all samples
+    const double sum = ( y_expected.array() * a_activation.array().log() +
+                         (1.0 - y_expected.array()) * (1.0 - a_activation.array()).log() ).sum();
 
-    Eigen::MatrixXd d =  - ((y_expected.array() * a_activation.array().log()) +  // y * ln(a)  +
-                           (ones - y_expected).array() * (ones-a_activation).array().log()).matrix();
-
-    Eigen::MatrixXd sums = d.colwise().sum();
-
-    return sums.sum() / double(sums.cols());
+    return - sum / double(a_activation.cols());
 }
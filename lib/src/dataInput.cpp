@@ -26,9 +26,134 @@
 
 #include <set>
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
 
 using namespace std;
 
+namespace
+{
+    // Binary dataset file: header, then inputs, outputs and lables of the training
+    // and of the test dataset. Each section starts at a multiple of 64 bytes.
+    const char DatasetFileMagic[8] = { 'E', 'I', 'D', 'N', 'N', 'D', 'S', '\0' };
+    const uint32_t DatasetFileVersion = 1;
+    const uint64_t DatasetFileAlignment = 64;
+
+    struct DatasetFileSet
+    {
+        uint64_t nbrOfSamples;
+        uint64_t inputSize;
+        uint64_t outputSize;
+        uint64_t hasLables;
+    };
+
+    struct DatasetFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t scalarSize;
+        DatasetFileSet sets[2]; // training, test
+    };
+
+    struct DatasetFileSections
+    {
+        uint64_t inputs;
+        uint64_t outputs;
+        uint64_t lables;
+    };
+
+    static_assert( sizeof(int) == sizeof(int32_t), "lables are stored as 32 bit integers" );
+
+    uint64_t alignSection( const uint64_t& offset )
+    {
+        return ( offset + DatasetFileAlignment - 1 ) / DatasetFileAlignment * DatasetFileAlignment;
+    }
+
+    // a * b, returns false on overflow
+    bool multiplySize( const uint64_t& a, const uint64_t& b, uint64_t& product )
+    {
+        if( a != 0 && b > UINT64_MAX / a )
+            return false;
+
+        product = a * b;
+        return true;
+    }
+
+    // Advances offset by a section of count elements of elementSize bytes, then aligns it.
+    // Returns false on overflow.
+    bool appendSection( uint64_t& offset, const uint64_t& count, const uint64_t& elementSize )
+    {
+        uint64_t bytes;
+        if( !multiplySize( count, elementSize, bytes ) )
+            return false;
+
+        const uint64_t maxEnd = UINT64_MAX - ( DatasetFileAlignment - 1 );
+        if( offset > maxEnd || bytes > maxEnd - offset )
+            return false;
+
+        offset = alignSection( offset + bytes );
+        return true;
+    }
+
+    // Computes the section offsets of both sets and the file size. Returns false if
+    // the sizes in the header overflow -> corrupt file.
+    bool datasetFileLayout( const DatasetFileHeader& header, DatasetFileSections sections[2], uint64_t& fileSize )
+    {
+        const uint64_t maxDimension = uint64_t( std::numeric_limits<long>::max() );
+
+        uint64_t offset = alignSection( sizeof(DatasetFileHeader) );
+        for( int k = 0; k < 2; k++ )
+        {
+            const DatasetFileSet& set = header.sets[k];
+            if( set.inputSize > maxDimension || set.outputSize > maxDimension )
+                return false;
+
+            uint64_t inputScalars, outputScalars;
+            if( !multiplySize( set.nbrOfSamples, set.inputSize, inputScalars ) ||
+                !multiplySize( set.nbrOfSamples, set.outputSize, outputScalars ) )
+                return false;
+
+            sections[k].inputs = offset;
+            if( !appendSection( offset, inputScalars, header.scalarSize ) )
+                return false;
+
+            sections[k].outputs = offset;
+            if( !appendSection( offset, outputScalars, header.scalarSize ) )
+                return false;
+
+            sections[k].lables = offset;
+            if( !appendSection( offset, set.hasLables ? set.nbrOfSamples : 0, sizeof(int32_t) ) )
+                return false;
+        }
+
+        fileSize = offset;
+        return true;
+    }
+
+    bool writeSection( std::ofstream& file, const uint64_t& offset, const void* data, const uint64_t& size )
+    {
+        // zero padding up to the section start
+        static const char padding[DatasetFileAlignment] = {};
+        const uint64_t pos = uint64_t( file.tellp() );
+        if( offset < pos )
+            return false;
+
+        file.write( padding, std::streamsize( offset - pos ) );
+        if( size > 0 )
+            file.write( static_cast<const char*>( data ), std::streamsize( size ) );
+
+        return bool( file );
+    }
+}
+
 DataInput::DataInput( )
 {
 }
@@ -36,7 +161,7 @@ DataInput::DataInput( )
 DataInput::~DataInput()
 {
 }
-void DataInput::addTrainingSample(const Eigen::MatrixXd &input, const Eigen::MatrixXd &expectedOutput)
+void DataInput::addTrainingSample(const NNMatrix &input, const NNMatrix &expectedOutput)
 {
     DataElement de;
     de.input = input;
@@ -45,7 +170,7 @@ void DataInput::addTrainingSample(const Eigen::MatrixXd &input, const Eigen::Mat
     m_training.push_back(de);
 }
 
-void DataInput::addTrainingSample(const Eigen::MatrixXd &input, int lable)
+void DataInput::addTrainingSample(const NNMatrix &input, int lable)
 {
     DataElement de;
     de.input = input;
@@ -55,7 +180,7 @@ void DataInput::addTrainingSample(const Eigen::MatrixXd &input, int lable)
 }
 
 
-void DataInput::addTestSample(const Eigen::MatrixXd &input, const Eigen::MatrixXd &expectedOutput)
+void DataInput::addTestSample(const NNMatrix &input, const NNMatrix &expectedOutput)
 {
     DataElement de;
     de.input = input;
@@ -64,7 +189,7 @@ void DataInput::addTestSample(const Eigen::MatrixXd &input, const Eigen::MatrixX
     m_test.push_back(de);
 }
 
-void DataInput::addTestSample(const Eigen::MatrixXd &input, int lable)
+void DataInput::addTestSample(const NNMatrix &input, int lable)
 {
     DataElement de;
     de.input = input;
@@ -117,12 +242,12 @@ bool DataInput::generateFromLables()
     // Example for nbrOfLables = 3 and second lable -> [0,1,0]
 
     m_lables.clear();
-    Eigen::MatrixXd outputBase = Eigen::MatrixXd::Constant(nbrOfLables,1, 0.0);
+    NNMatrix outputBase = NNMatrix::Constant(nbrOfLables,1, 0.0);
 
     size_t currentLableIdx = 0;
     for (int lNbr: lables)
     {
-        Eigen::MatrixXd thisOut = outputBase;
+        NNMatrix thisOut = outputBase;
         thisOut(currentLableIdx,0) = 1.0;
 
         m_lables.insert(std::pair<int,DataLable>(lNbr,DataLable(lNbr,thisOut)));
@@ -170,9 +295,9 @@ bool DataInput::assignOutput( std::vector<DataElement>& vector )
     return true;
 }
 
-std::vector<Eigen::MatrixXd> DataInput::getInputData( const std::vector<DataElement>& vector )
+std::vector<NNMatrix> DataInput::getInputData( const std::vector<DataElement>& vector )
 {
-    std::vector<Eigen::MatrixXd> ret;
+    std::vector<NNMatrix> ret;
 
     for( const DataElement& de : vector )
     {
@@ -182,9 +307,9 @@ std::vector<Eigen::MatrixXd> DataInput::getInputData( const std::vector<DataElem
     return ret;
 }
 
-std::vector<Eigen::MatrixXd> DataInput::getOutputData( const std::vector<DataElement>& vector )
+std::vector<NNMatrix> DataInput::getOutputData( const std::vector<DataElement>& vector )
 {
-    std::vector<Eigen::MatrixXd> ret;
+    std::vector<NNMatrix> ret;
 
     for( const DataElement& de : vector )
     {
@@ -201,6 +326,164 @@ std::vector<Eigen::MatrixXd> DataInput::getOutputData( const std::vector<DataEle
     return ret;
 }
 
+Dataset DataInput::getDataset( const std::vector<DataElement>& vector )
+{
+    if( vector.empty() )
+        return Dataset();
+
+    const long inputSize = vector.front().input.size();
+    const long outputSize = vector.front().output.size();
+    NNMatrix inputs( inputSize, long(vector.size()) );
+    NNMatrix outputs( outputSize, long(vector.size()) );
+    std::vector<int> lables;
+
+    for( size_t k = 0; k < vector.size(); k++ )
+    {
+        const DataElement& de = vector[k];
+        if( !de.outputSet || de.input.size() != inputSize || de.output.size() != outputSize )
+        {
+            std::cout << "Error: Data element without output or with mismatching size" << std::endl;
+            return Dataset();
+        }
+
+        inputs.col( long(k) ) = Eigen::Map<const NNVector>( de.input.data(), inputSize );
+        outputs.col( long(k) ) = Eigen::Map<const NNVector>( de.output.data(), outputSize );
+        lables.push_back( de.lable );
+    }
+
+    // lables are only kept if each sample has one
+    bool allLablesSet = true;
+    for( const DataElement& de : vector )
+        allLablesSet = allLablesSet && de.lableSet;
+    if( !allLablesSet )
+        lables.clear();
+
+    return Dataset( std::move(inputs), std::move(outputs), std::move(lables) );
+}
+
+bool DataInput::saveDatasets( const std::string& filePath, const Dataset& training, const Dataset& test )
+{
+    const Dataset* sets[2] = { &training, &test };
+
+    DatasetFileHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    std::memcpy( header.magic, DatasetFileMagic, sizeof(DatasetFileMagic) );
+    header.version = DatasetFileVersion;
+    header.scalarSize = sizeof(NNScalar);
+    for( int k = 0; k < 2; k++ )
+    {
+        header.sets[k].nbrOfSamples = sets[k]->getNumberOfSamples();
+        header.sets[k].inputSize = uint64_t( sets[k]->getInputSize() );
+        header.sets[k].outputSize = uint64_t( sets[k]->getOutputSize() );
+        header.sets[k].hasLables = sets[k]->hasLables() ? 1 : 0;
+    }
+
+    DatasetFileSections sections[2];
+    uint64_t fileSize;
+    if( !datasetFileLayout( header, sections, fileSize ) )
+    {
+        std::cout << "Error: Dataset is too large for a dataset file" << std::endl;
+        return false;
+    }
+
+    std::ofstream file( filePath, std::ios::binary | std::ios::trunc );
+    if( !file.is_open() )
+    {
+        std::cout << "Error: Cannot open dataset file " << filePath << std::endl;
+        return false;
+    }
+
+    bool ok = writeSection( file, 0, &header, sizeof(header) );
+    for( int k = 0; k < 2 && ok; k++ )
+    {
+        const Dataset& set = *sets[k];
+        const DatasetFileSet& fileSet = header.sets[k];
+        ok = writeSection( file, sections[k].inputs, set.m_inputs, fileSet.nbrOfSamples * fileSet.inputSize * sizeof(NNScalar) ) &&
+             writeSection( file, sections[k].outputs, set.m_outputs, fileSet.nbrOfSamples * fileSet.outputSize * sizeof(NNScalar) ) &&
+             writeSection( file, sections[k].lables, set.m_lables, fileSet.hasLables ? fileSet.nbrOfSamples * sizeof(int32_t) : 0 );
+    }
+    ok = ok && writeSection( file, fileSize, nullptr, 0 );
+
+    if( !ok )
+        std::cout << "Error: Writing dataset file " << filePath << " failed" << std::endl;
+
+    return ok;
+}
+
+bool DataInput::openDatasets( const std::string& filePath, Dataset& training, Dataset& test )
+{
+    int fd = ::open( filePath.c_str(), O_RDONLY );
+    if( fd < 0 )
+    {
+        std::cout << "Error: Cannot open dataset file " << filePath << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if( ::fstat( fd, &fileStat ) != 0 || uint64_t( fileStat.st_size ) < sizeof(DatasetFileHeader) )
+    {
+        std::cout << "Error: Invalid dataset file " << filePath << std::endl;
+        ::close( fd );
+        return false;
+    }
+
+    const size_t mappedSize = size_t( fileStat.st_size );
+    void* addr = ::mmap( nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0 );
+    ::close( fd ); // the mapping stays valid
+
+    if( addr == MAP_FAILED )
+    {
+        std::cout << "Error: Cannot map dataset file " << filePath << std::endl;
+        return false;
+    }
+
+    // unmapped when the last dataset referring to it is gone
+    std::shared_ptr<const void> storage( addr, [mappedSize]( const void* p ) { ::munmap( const_cast<void*>( p ), mappedSize ); } );
+
+    const char* base = static_cast<const char*>( addr );
+    DatasetFileHeader header;
+    std::memcpy( &header, base, sizeof(header) );
+
+    if( std::memcmp( header.magic, DatasetFileMagic, sizeof(DatasetFileMagic) ) != 0 || header.version != DatasetFileVersion )
+    {
+        std::cout << "Error: Invalid dataset file " << filePath << std::endl;
+        return false;
+    }
+
+    if( header.scalarSize != sizeof(NNScalar) )
+    {
+        std::cout << "Error: Dataset file " << filePath << " was written with another scalar type" << std::endl;
+        return false;
+    }
+
+    DatasetFileSections sections[2];
+    uint64_t fileSize;
+    if( !datasetFileLayout( header, sections, fileSize ) )
+    {
+        std::cout << "Error: Invalid section sizes in dataset file " << filePath << std::endl;
+        return false;
+    }
+
+    if( fileSize > mappedSize )
+    {
+        std::cout << "Error: Dataset file " << filePath << " is truncated" << std::endl;
+        return false;
+    }
+
+    Dataset* sets[2] = { &training, &test };
+    for( int k = 0; k < 2; k++ )
+    {
+        const DatasetFileSet& fileSet = header.sets[k];
+        *sets[k] = Dataset( storage,
+                            reinterpret_cast<const NNScalar*>( base + sections[k].inputs ),
+                            reinterpret_cast<const NNScalar*>( base + sections[k].outputs ),
+                            fileSet.hasLables ? reinterpret_cast<const int*>( base + sections[k].lables ) : nullptr,
+                            long( fileSet.inputSize ), long( fileSet.outputSize ), size_t( fileSet.nbrOfSamples ) );
+    }
+
+    return true;
+}
+
 // source http://www.faqs.org/faqs/ai-faq/neural-nets/part2/
 void DataInput::normalizeData()
 {
@@ -215,7 +498,7 @@ void DataInput::normalizeData()
     }
 }
 
-Eigen::MatrixXd DataInput::normalize0Mean1Std(const Eigen::MatrixXd& in)
+NNMatrix DataInput::normalize0Mean1Std(const NNMatrix& in)
 {
     // compute mean and std of input
     double mean = in.mean();
@@ -230,7 +513,7 @@ Eigen::MatrixXd DataInput::normalize0Mean1Std(const Eigen::MatrixXd& in)
     double stdev = std::sqrt( accum / (m-1) );
 
     // apply mean and std to create new sample
-    Eigen::MatrixXd normSamp(m,1);
+    NNMatrix normSamp(m,1);
     for( size_t k = 0; k < m; k++ )
     {
         normSamp(k,0) = (in(k,0) - mean) / stdev;
@@ -239,7 +522,7 @@ Eigen::MatrixXd DataInput::normalize0Mean1Std(const Eigen::MatrixXd& in)
     return normSamp;
 }
 
-size_t DataInput::getStrongestIdx(const Eigen::MatrixXd& out)
+size_t DataInput::getStrongestIdx(const NNMatrix& out)
 {
     unsigned long maxRowIdx = 0;
     unsigned long maxColIdx = 0;
@@ -289,7 +572,7 @@ DataInput::DataInputValidation DataInput::validateData() const
     return ret;
 }
 
-Eigen::MatrixXd DataInput::representation(const Eigen::MatrixXd &input, bool *representationAvailable) const
+NNMatrix DataInput::representation(const NNMatrix &input, bool *representationAvailable) const
 {
     *representationAvailable = false;
     return input;
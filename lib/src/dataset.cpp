@@ -0,0 +1,130 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "dataset.h"
+
+#include <iostream>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    // storage of a dataset, which is not memory mapped
+    struct OwnedStorage
+    {
+        NNMatrix inputs;
+        NNMatrix outputs;
+        std::vector<int> lables;
+    };
+}
+
+Dataset::Dataset() :
+    m_inputs( nullptr ),
+    m_outputs( nullptr ),
+    m_lables( nullptr ),
+    m_inputSize( 0 ),
+    m_outputSize( 0 ),
+    m_nbrOfSamples( 0 )
+{
+}
+
+Dataset::Dataset( const std::shared_ptr<const void>& storage, const NNScalar* inputs, const NNScalar* outputs, const int* lables,
+                  const long& inputSize, const long& outputSize, const size_t& nbrOfSamples ) :
+    m_storage( storage ),
+    m_inputs( inputs ),
+    m_outputs( outputs ),
+    m_lables( lables ),
+    m_inputSize( inputSize ),
+    m_outputSize( outputSize ),
+    m_nbrOfSamples( nbrOfSamples )
+{
+}
+
+Dataset::Dataset( NNMatrix inputs, NNMatrix outputs, std::vector<int> lables ) : Dataset()
+{
+    if( inputs.cols() != outputs.cols() || ( !lables.empty() && long(lables.size()) != inputs.cols() ) )
+    {
+        std::cout << "Error: Dataset number of inputs, outputs and lables mismatch" << std::endl;
+        return;
+    }
+
+    std::shared_ptr<OwnedStorage> storage( new OwnedStorage{ std::move(inputs), std::move(outputs), std::move(lables) } );
+
+    m_storage = storage;
+    m_inputs = storage->inputs.data();
+    m_outputs = storage->outputs.data();
+    m_lables = storage->lables.empty() ? nullptr : storage->lables.data();
+    m_inputSize = storage->inputs.rows();
+    m_outputSize = storage->outputs.rows();
+    m_nbrOfSamples = size_t( storage->inputs.cols() );
+}
+
+Dataset::Dataset( const std::vector<NNMatrix>& inputs, const std::vector<NNMatrix>& outputs ) : Dataset()
+{
+    if( inputs.size() != outputs.size() )
+    {
+        std::cout << "Error: Dataset number of inputs and outputs mismatch" << std::endl;
+        return;
+    }
+
+    if( inputs.empty() )
+        return;
+
+    const long inputSize = inputs.front().rows();
+    const long outputSize = outputs.front().rows();
+
+    NNMatrix in( inputSize, long(inputs.size()) );
+    NNMatrix out( outputSize, long(outputs.size()) );
+
+    for( size_t k = 0; k < inputs.size(); k++ )
+    {
+        if( inputs[k].size() != inputSize || outputs[k].size() != outputSize )
+        {
+            std::cout << "Error: Dataset sample size mismatch" << std::endl;
+            return;
+        }
+
+        in.col( long(k) ) = Eigen::Map<const NNVector>( inputs[k].data(), inputSize );
+        out.col( long(k) ) = Eigen::Map<const NNVector>( outputs[k].data(), outputSize );
+    }
+
+    *this = Dataset( std::move(in), std::move(out) );
+}
+
+Dataset::~Dataset()
+{
+}
+
+void Dataset::gather( const size_t* sampleIdx, const size_t& count, NNMatrix& batch_in, NNMatrix& batch_out ) const
+{
+    // no allocation if the size does not change
+    batch_in.resize( m_inputSize, long(count) );
+    batch_out.resize( m_outputSize, long(count) );
+
+    // each sample is a contiguous column in the dataset and in the batch
+    for( size_t b = 0; b < count; b++ )
+    {
+        std::memcpy( batch_in.data() + m_inputSize * long(b), m_inputs + m_inputSize * long(sampleIdx[b]), size_t(m_inputSize) * sizeof(NNScalar) );
+        std::memcpy( batch_out.data() + m_outputSize * long(b), m_outputs + m_outputSize * long(sampleIdx[b]), size_t(m_outputSize) * sizeof(NNScalar) );
+    }
+}
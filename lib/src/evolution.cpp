@@ -25,22 +25,32 @@
 #include "evolution.h"
 #include "layer.h"
 #include "helpers.h"
+#include "genetic.h"
 
 
 #include <algorithm>
 #include <iostream>
 #include <numeric>
-#include <thread>
+#include <random>
 #include <inc/evolution.h>
 
 
 Evolution::Evolution(size_t nInitial, size_t nNext, SimFactoryPtr simFactory, unsigned int nThreads)
 : m_nInitials(nInitial), m_nOffsprings(nNext), m_simFactory(simFactory), m_epochOver(false), m_epochCount(0), m_mutationRate(0.0),
-  m_stepCounter(0), m_simSpeed(0.0), m_nbrThreads(nThreads), m_keepParents(true)
+  m_stepCounter(0), m_simSpeed(0.0), m_nbrThreads(std::max(nThreads, 1u)), m_populationValid(false),
+  m_breedRng( ( uint64_t( std::random_device()() ) << 32 ) | std::random_device()() ), m_createInBreedJob(false),
+  m_batchedInference(true), m_networkStackValid(false), m_keepParents(true), m_fixedTimeStep(0.0)
 {
+    m_workerPool.reset( new WorkerPool( m_nbrThreads ) );
+    m_stepJob = [this]( const unsigned int& w ) { doStepOnSimulationChunks( w ); };
+    m_actJob = [this]( const unsigned int& w ) { doActOnStackChunks( w ); };
+    m_breedJob = [this]( const unsigned int& w ) { breedOnChunks( w ); };
+
     m_simSpeedTime = now();
     std::generate_n(std::back_inserter(m_simulations), nInitial, [simFactory]()->SimulationPtr { return simFactory->createRandomSimulation(); });
     m_fittest = m_simulations[0]; // set randomly
+
+    syncPopulation();
 }
 
 Evolution::~Evolution()
@@ -48,17 +58,197 @@ Evolution::~Evolution()
 
 }
 
-void Evolution::doStepOnFewSimulations( std::vector<SimulationPtr>& sims, std::atomic_bool& anyAlive, size_t start, size_t end )
+void Evolution::doStepOnSimulationChunks( const unsigned int& /*workerIdx*/ )
 {
-    for( size_t k = start; k < end; k++ )
+    const size_t nbrOfSims = m_simulations.size();
+    bool anyAlive = false;
+
+    for(;;)
     {
-        SimulationPtr s = sims[k];
-        if (s->isAlive())
+        const size_t start = m_nextStepChunk.fetch_add( StepChunkSize, std::memory_order_relaxed );
+        if( start >= nbrOfSims )
+            break;
+
+        const size_t end = std::min( start + StepChunkSize, nbrOfSims );
+        for( size_t k = start; k < end; k++ )
         {
-            s->doStep();
-            anyAlive = true;
+            Simulation* s = m_simulations[k].get();
+            if( s->isAlive() )
+            {
+                const long stackIdx = k < m_stackIndex.size() ? m_stackIndex[k] : -1;
+                if( stackIdx >= 0 )
+                {
+                    s->sense( m_stackInput.col( stackIdx ) );
+                    m_sensed[stackIdx] = 1;
+                }
+                else
+                {
+                    s->doStep();
+                }
+                anyAlive = true;
+            }
         }
     }
+
+    if( anyAlive )
+        m_anyAlive = true;
+}
+
+void Evolution::doActOnStackChunks( const unsigned int& /*workerIdx*/ )
+{
+    const size_t nbrOfStacked = m_stackedSims.size();
+    const NNMatrix& output = m_networkStack.getOutputActivation();
+
+    for(;;)
+    {
+        const size_t start = m_nextActChunk.fetch_add( StepChunkSize, std::memory_order_relaxed );
+        if( start >= nbrOfStacked )
+            break;
+
+        const size_t end = std::min( start + StepChunkSize, nbrOfStacked );
+        for( size_t i = start; i < end; i++ )
+            if( m_sensed[i] )
+                m_stackedSims[i]->act( output.col( i ) );
+    }
+}
+
+void Evolution::breedOnChunks( const unsigned int& /*workerIdx*/ )
+{
+    for(;;)
+    {
+        const size_t chunk = m_nextBreedChunk.fetch_add( 1, std::memory_order_relaxed );
+        if( chunk >= m_breedSeeds.size() )
+            break;
+
+        // the generator depends on the chunk only -> same genomes for any number of threads
+        const size_t first = chunk * BreedChunkSize;
+        const size_t count = std::min( BreedChunkSize, m_nOffsprings - first );
+        Xoshiro256 rng( m_breedSeeds[chunk] );
+        Genetic::crossover( m_parents, 0, 1, m_population, first, count, Genetic::CrossoverMethod::Uniform, m_mutationRate, rng );
+
+        if( m_createInBreedJob )
+            for( size_t k = first; k < first + count; k++ )
+                m_simulations[k] = m_simFactory->createFromGenome( m_population, k );
+    }
+}
+
+void Evolution::prepareNetworkStack()
+{
+    if( !m_batchedInference )
+    {
+        m_stackIndex.clear();
+        m_stackedSims.clear();
+        m_networkStackValid = false;
+        return;
+    }
+
+    if( m_networkStackValid )
+    {
+        size_t nbrOfAlive = 0;
+        for( Simulation* s : m_stackedSims )
+            if( s->isAlive() )
+                nbrOfAlive++;
+
+        if( 2 * nbrOfAlive >= m_stackedSims.size() )
+            return;
+    }
+
+    // gather the alive simulations with the same network structure
+    m_stackIndex.assign( m_simulations.size(), -1 );
+    m_stackedSims.clear();
+    std::vector<const Network*> networks;
+    std::vector<size_t> genomes;
+
+    for( size_t k = 0; k < m_simulations.size(); k++ )
+    {
+        Simulation* s = m_simulations[k].get();
+        const Network* net = s->getNetwork().get();
+        if( !s->isAlive() || !s->supportsSenseAct() || net == nullptr )
+            continue;
+
+        if( !networks.empty() && !NetworkStack::isSameStructure( *networks.front(), *net ) )
+            continue;
+
+        m_stackIndex[k] = long( m_stackedSims.size() );
+        m_stackedSims.push_back( s );
+        networks.push_back( net );
+        if( m_populationValid )
+            genomes.push_back( m_genomeIdx[k] );
+    }
+
+    // take the genomes from the population store if possible
+    bool stacked = true;
+    if( m_populationValid )
+        m_networkStack.setPopulation( m_population, genomes );
+    else
+        stacked = m_networkStack.setNetworks( networks );
+
+    if( !stacked )
+    {
+        m_stackIndex.assign( m_simulations.size(), -1 );
+        m_stackedSims.clear();
+    }
+    else if( !networks.empty() )
+    {
+        m_stackInput = NNMatrix::Zero( m_networkStack.getNetworkStructure().front(), long( m_stackedSims.size() ) );
+    }
+
+    m_networkStackValid = true;
+}
+
+void Evolution::syncPopulation()
+{
+    m_populationValid = false;
+    m_genomeIdx.clear();
+
+    std::vector<const Network*> networks;
+    for( const SimulationPtr& s : m_simulations )
+    {
+        const Network* net = s->getNetwork().get();
+        if( net == nullptr || ( !networks.empty() && !Population::isSameStructure( *networks.front(), *net ) ) )
+            return;
+
+        networks.push_back( net );
+    }
+
+    if( networks.empty() || !m_population.setNetworks( networks ) )
+        return;
+
+    m_genomeIdx.resize( networks.size() );
+    std::iota( m_genomeIdx.begin(), m_genomeIdx.end(), 0 );
+    m_populationValid = true;
+}
+
+void Evolution::setFixedTimeStep( const double& dt )
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_fixedTimeStep = std::max( dt, 0.0 );
+    applyFixedTimeStep();
+}
+
+double Evolution::getFixedTimeStep() const
+{
+    return m_fixedTimeStep;
+}
+
+void Evolution::applyFixedTimeStep()
+{
+    for( const SimulationPtr& s : m_simulations )
+        if( s->getFixedTimeStep() != m_fixedTimeStep )
+            s->setFixedTimeStep( m_fixedTimeStep );
+}
+
+void Evolution::setSeed( const uint64_t& seed )
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_breedRng.seed( seed );
+}
+
+void Evolution::setBatchedInference( const bool& enable )
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_batchedInference = enable;
+    m_networkStackValid = false;
 }
 
 void Evolution::doStep()
@@ -67,21 +257,22 @@ void Evolution::doStep()
 
     std::lock_guard<std::mutex> guard(m_mutex);
 
-    std::atomic_bool anyAlive = false;
-    std::vector<std::thread> thv;
-    size_t samplesPerThread = m_simulations.size() / m_nbrThreads;
-    for(unsigned int th = 0; th < m_nbrThreads; th++)
-    {
-        size_t startPos = th * samplesPerThread;
-        size_t endPos = startPos + samplesPerThread;
-        if( th == m_nbrThreads - 1 ) // last thread till end
-            endPos = m_simulations.size();
+    prepareNetworkStack();
+    m_sensed.assign( m_stackedSims.size(), 0 );
 
-        thv.emplace_back(std::thread( doStepOnFewSimulations, std::ref(m_simulations), std::ref(anyAlive), startPos, endPos ));
-    }
+    // the threads claim chunks until all simulations are stepped or sensed
+    m_anyAlive = false;
+    m_nextStepChunk = 0;
+    m_workerPool->run( m_stepJob );
+    const bool anyAlive = m_anyAlive;
 
-    for( std::thread& th : thv )
-        th.join();
+    // feedforward all sensed inputs at once, and let the simulations act
+    if( std::find( m_sensed.begin(), m_sensed.end(), 1 ) != m_sensed.end() )
+    {
+        m_networkStack.feedForward( m_stackInput );
+        m_nextActChunk = 0;
+        m_workerPool->run( m_actJob );
+    }
 
     if( !anyAlive )
     {
@@ -117,9 +308,25 @@ std::vector<SimulationPtr > Evolution::getSimulationsOrderedByFitness()
 {
     std::lock_guard<std::mutex> guard(m_mutex);
 
-    std::sort( m_simulations.begin(), m_simulations.end(), [](SimulationPtr a, SimulationPtr b) -> bool {
-        return a->getFitness() > b->getFitness();
+    // sort the simulations and their genome indices together
+    std::vector<size_t> order( m_simulations.size() );
+    std::iota( order.begin(), order.end(), 0 );
+    std::sort( order.begin(), order.end(), [this](size_t a, size_t b) -> bool {
+        return m_simulations[a]->getFitness() > m_simulations[b]->getFitness();
     } );
+
+    std::vector<SimulationPtr> sims( m_simulations.size() );
+    std::vector<size_t> genomeIdx( m_genomeIdx.size() );
+    for( size_t k = 0; k < order.size(); k++ )
+    {
+        sims[k] = m_simulations[order[k]];
+        if( m_populationValid )
+            genomeIdx[k] = m_genomeIdx[order[k]];
+    }
+    m_simulations.swap( sims );
+    m_genomeIdx.swap( genomeIdx );
+
+    m_networkStackValid = false;
     return m_simulations;
 }
 
@@ -137,7 +344,41 @@ void Evolution::breed()
 
     m_simulations.clear();
 
-    std::generate_n(std::back_inserter(m_simulations), m_nOffsprings, [=]()->SimulationPtr { return m_simFactory->createCrossover(a,b,m_mutationRate); });
+    if( m_populationValid )
+    {
+        // crossover and mutation on the population store, in parallel chunks
+        m_parents.gather( m_population, { m_genomeIdx[0], m_genomeIdx[1] } );
+
+        m_population.gather( m_parents, {} );
+        m_population.resize( m_nOffsprings );
+
+        m_breedSeeds.resize( ( m_nOffsprings + BreedChunkSize - 1 ) / BreedChunkSize );
+        for( uint64_t& seed : m_breedSeeds )
+            seed = m_breedRng();
+
+        m_simulations.assign( m_nOffsprings, SimulationPtr() );
+        m_createInBreedJob = m_simFactory->isThreadSafe();
+        m_nextBreedChunk = 0;
+        m_workerPool->run( m_breedJob );
+
+        if( !m_createInBreedJob )
+            for( size_t k = 0; k < m_nOffsprings; k++ )
+                m_simulations[k] = m_simFactory->createFromGenome( m_population, k );
+
+        if( m_keepParents )
+        {
+            m_population.resize( m_nOffsprings + 2 );
+            m_population.copyGenome( m_parents, 0, m_nOffsprings );
+            m_population.copyGenome( m_parents, 1, m_nOffsprings + 1 );
+        }
+
+        m_genomeIdx.resize( m_population.getNumberOfIndividuals() );
+        std::iota( m_genomeIdx.begin(), m_genomeIdx.end(), 0 );
+    }
+    else
+    {
+        std::generate_n(std::back_inserter(m_simulations), m_nOffsprings, [=]()->SimulationPtr { return m_simFactory->createCrossover(a,b,m_mutationRate); });
+    }
 
     // add parents to the next epoch
     if( m_keepParents )
@@ -146,7 +387,13 @@ void Evolution::breed()
         m_simulations.push_back(m_simFactory->copy(b));
     }
 
+    if( !m_populationValid )
+        syncPopulation();
+
+    applyFixedTimeStep();
+
     m_epochOver = false;
+    m_networkStackValid = false;
 }
 
 size_t Evolution::getNumberOfEpochs() const
@@ -266,6 +513,9 @@ bool Evolution::load(const std::string &a_path, const std::string &b_path)
     m_simulations.clear();
     m_simulations.push_back(a);
     m_simulations.push_back(b);
+    syncPopulation();
+    applyFixedTimeStep();
+    m_networkStackValid = false;
 
     return true;
 }
@@ -0,0 +1,113 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "executor.h"
+
+#include <algorithm>
+
+Executor::Executor( const unsigned int& nbrOfThreads, const size_t& maxQueueSize ) :
+    m_nbrOfThreads( std::max( nbrOfThreads, 1u ) ),
+    m_maxQueueSize( std::max( maxQueueSize, size_t(1) ) ),
+    m_stop( false )
+{
+    for( unsigned int t = 0; t < m_nbrOfThreads; t++ )
+        m_threads.push_back( std::thread( &Executor::threadLoop, this ) );
+}
+
+Executor::~Executor()
+{
+    std::deque< std::packaged_task<void()> > discarded;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stop = true;
+        discarded.swap( m_queue );
+    }
+    m_taskAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+
+    for( std::thread& t : m_threads )
+        t.join();
+}
+
+std::shared_future<void> Executor::submit( Task task )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_spaceAvailable.wait( lock, [this]{ return m_stop || m_queue.size() < m_maxQueueSize; } );
+
+    if( m_stop )
+        return std::shared_future<void>();
+
+    return enqueue( task );
+}
+
+bool Executor::trySubmit( Task task, std::shared_future<void>& future )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( m_stop || m_queue.size() >= m_maxQueueSize )
+        return false;
+
+    future = enqueue( task );
+    return true;
+}
+
+// m_mutex is locked by the caller
+std::shared_future<void> Executor::enqueue( Task& task )
+{
+    m_queue.emplace_back( std::move( task ) );
+    std::shared_future<void> future = m_queue.back().get_future().share();
+    m_taskAvailable.notify_one();
+    return future;
+}
+
+size_t Executor::getNbrOfQueuedTasks() const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_queue.size();
+}
+
+Executor& Executor::global()
+{
+    static Executor executor( std::max( std::thread::hardware_concurrency(), 2u ), 64 );
+    return executor;
+}
+
+void Executor::threadLoop()
+{
+    for(;;)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_taskAvailable.wait( lock, [this]{ return m_stop || !m_queue.empty(); } );
+
+            if( m_stop )
+                return;
+
+            task = std::move( m_queue.front() );
+            m_queue.pop_front();
+        }
+        m_spaceAvailable.notify_one();
+
+        task();
+    }
+}
@@ -26,85 +26,169 @@
 
 #include <iostream>
 #include <random>
+#include <cmath>
+#include <algorithm>
 
 NetworkPtr Genetic::crossover(NetworkPtr a, NetworkPtr b, Genetic::CrossoverMethod method, double mutationRate )
 {
-    auto kv = a->getNetworkStructure();
-    auto qv = b->getNetworkStructure();
-
     if( ! std::equal( a->getNetworkStructure().begin(), a->getNetworkStructure().end(),  b->getNetworkStructure().begin() ) )
     {
         std::cout << "Genetic::crossover, Error mismatching network sizes" << std::endl;
         return std::shared_ptr<Network>(nullptr);
     }
 
-    NetworkPtr cross = std::shared_ptr<Network>( new Network(*(a.get())) );
+    // layer types are taken from a
+    Population parents;
+    parents.setStructure( *a );
+    parents.resize( 2 );
+    parents.setGenome( 0, *a );
+    parents.setGenome( 1, *b );
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> crossOv(0, 1);
+    Population child;
+    child.setStructure( *a );
+    child.resize( 1 );
+    crossover( parents, 0, 1, child, method, mutationRate );
 
-    std::uniform_real_distribution<double> mutation(0.0, 1.0);
-    std::normal_distribution<double> mutationVal(0.0, 1.0);
+    NetworkPtr cross = std::shared_ptr<Network>( new Network(*(a.get())) );
+    child.getGenome( 0, *cross );
 
-    for( unsigned int i = 0; i < cross->getNumberOfLayer(); i++ )
+    return cross;
+}
+
+namespace
+{
+    Xoshiro256& threadGenerator()
     {
-        auto al = a->getLayer(i);
-        auto bl = b->getLayer(i);
-        auto crl = cross->getLayer(i);
+        thread_local Xoshiro256 gen( ( uint64_t( std::random_device()() ) << 32 ) | std::random_device()() );
+        return gen;
+    }
+
+    typedef Eigen::Block<NNMatrix, Eigen::Dynamic, Eigen::Dynamic, false> RowRange;
 
-        // crossover weight matrix
-        auto aw = al->getWeightMatrix();
-        auto bw = bl->getWeightMatrix();
-        Eigen::MatrixXd crlw(aw.rows(), aw.cols());
+    // offspring is a range of rows -> each column is contiguous
+    void crossoverMatrix( const NNMatrix& parents, const long& a, const long& b, RowRange offspring, Xoshiro256& rng )
+    {
+        const long nbrOfRows = offspring.rows();
+        uint64_t bits = 0;
+        long bitsLeft = 0;
 
-        for( size_t m = 0; m < crlw.rows(); m++ )
+        for( long c = 0; c < offspring.cols(); c++ )
         {
-            for( size_t n = 0; n < crlw.cols(); n++ )
+            const NNScalar pa = parents( a, c );
+            const NNScalar pb = parents( b, c );
+            NNScalar* col = offspring.col( c ).data();
+
+            long i = 0;
+            while( i < nbrOfRows )
             {
-                if( mutation(gen) < mutationRate )
+                if( bitsLeft == 0 )
                 {
-                    // do mutation
-                    crlw(m, n) = mutationVal(gen);
+                    bits = rng();
+                    bitsLeft = 64;
                 }
-                else
-                {
-                    // do crossover
 
-                    if (crossOv(gen) == 0)
-                        crlw(m, n) = aw(m, n);
-                    else
-                        crlw(m, n) = bw(m, n);
-                }
+                // one bit per parameter, branchless -> vectorizable blend
+                const long n = std::min( bitsLeft, nbrOfRows - i );
+                for( long j = 0; j < n; j++ )
+                    col[i + j] = ( ( bits >> j ) & 1 ) ? pb : pa;
+
+                bits = n < 64 ? bits >> n : 0;
+                bitsLeft -= n;
+                i += n;
             }
         }
+    }
 
-        crl->setWeights(crlw);
+    void mutateMatrix( RowRange m, double mutationRate, Xoshiro256& rng )
+    {
+        const long size = m.size();
 
-        // crossover bias vector
-        auto ab = al->getBiasVector();
-        auto bb = bl->getBiasVector();
-        Eigen::MatrixXd crlb(ab.rows(),1);
+        if( mutationRate <= 0.0 || size == 0 )
+            return;
 
-        for( size_t m = 0; m < crlb.rows(); m++ )
+        if( mutationRate >= 1.0 )
         {
-            if( mutation(gen) < mutationRate )
-            {
-                // do mutation
-                crlb(m) = mutationVal(gen);
-            }
-            else
-            {
-                // do crossover
-                if( crossOv(gen) == 0 )
-                    crlb(m) = ab(m);
-                else
-                    crlb(m) = bb(m);
-            }
+            for( long c = 0; c < m.cols(); c++ )
+                for( long r = 0; r < m.rows(); r++ )
+                    m( r, c ) = NNScalar( rng.normal() );
+            return;
         }
 
-        crl->setBiases(crlb);
+        // gaps between mutations are geometric distributed
+        const double logKeep = std::log1p( -mutationRate );
+        double pos = -1.0;
+        for(;;)
+        {
+            pos += 1.0 + std::floor( std::log( 1.0 - rng.uniform() ) / logKeep );
+            if( pos >= double( size ) )
+                break;
+
+            const long p = long( pos );
+            m( p % m.rows(), p / m.rows() ) = NNScalar( rng.normal() );
+        }
     }
+}
 
-    return cross;
+void Genetic::setSeed( const uint64_t& seed )
+{
+    threadGenerator().seed( seed );
+}
+
+bool Genetic::crossover( const Population& parents, const size_t& a, const size_t& b, Population& offspring,
+                         Genetic::CrossoverMethod method, double mutationRate )
+{
+    return crossover( parents, a, b, offspring, method, mutationRate, threadGenerator() );
+}
+
+bool Genetic::crossover( const Population& parents, const size_t& a, const size_t& b, Population& offspring,
+                         Genetic::CrossoverMethod method, double mutationRate, Xoshiro256& rng )
+{
+    return crossover( parents, a, b, offspring, 0, offspring.getNumberOfIndividuals(), method, mutationRate, rng );
+}
+
+bool Genetic::crossover( const Population& parents, const size_t& a, const size_t& b, Population& offspring,
+                         const size_t& first, const size_t& count, Genetic::CrossoverMethod /*method*/, double mutationRate, Xoshiro256& rng )
+{
+    if( parents.getNetworkStructure() != offspring.getNetworkStructure() )
+    {
+        std::cout << "Genetic::crossover, Error mismatching population structure" << std::endl;
+        return false;
+    }
+
+    if( a >= parents.getNumberOfIndividuals() || b >= parents.getNumberOfIndividuals() )
+    {
+        std::cout << "Genetic::crossover, Error invalid parent" << std::endl;
+        return false;
+    }
+
+    if( first + count > offspring.getNumberOfIndividuals() )
+    {
+        std::cout << "Genetic::crossover, Error invalid offspring range" << std::endl;
+        return false;
+    }
+
+    for( size_t l = 1; l <= offspring.getNumberOfLayers(); l++ )
+    {
+        crossoverMatrix( parents.weights(l), long(a), long(b), offspring.weights(l).middleRows( long(first), long(count) ), rng );
+        crossoverMatrix( parents.biases(l), long(a), long(b), offspring.biases(l).middleRows( long(first), long(count) ), rng );
+    }
+
+    for( size_t l = 1; l <= offspring.getNumberOfLayers(); l++ )
+    {
+        mutateMatrix( offspring.weights(l).middleRows( long(first), long(count) ), mutationRate, rng );
+        mutateMatrix( offspring.biases(l).middleRows( long(first), long(count) ), mutationRate, rng );
+    }
+
+    return true;
+}
+
+void Genetic::mutate( Population& population, double mutationRate, Xoshiro256& rng )
+{
+    for( size_t l = 1; l <= population.getNumberOfLayers(); l++ )
+    {
+        NNMatrix& w = population.weights(l);
+        NNMatrix& b = population.biases(l);
+        mutateMatrix( w.middleRows( 0, w.rows() ), mutationRate, rng );
+        mutateMatrix( b.middleRows( 0, b.rows() ), mutationRate, rng );
+    }
 }
@@ -28,19 +28,19 @@
 
 using namespace std;
 
-void Helpers::printVector( const Eigen::VectorXd& vector, const string& name )
+void Helpers::printVector( const NNVector& vector, const string& name )
 {
     Eigen::IOFormat CleanFmt(4, 0, ", ", "\n", "[", "]");
     cout << name << ":" << endl << vector.format(CleanFmt) << endl;
 }
 
-void Helpers::printMatrix( const Eigen::MatrixXd& mat, const string& name )
+void Helpers::printMatrix( const NNMatrix& mat, const string& name )
 {
     Eigen::IOFormat CleanFmt(4, 0, ", ", "\n", "[", "]");
     cout << name << ":" << endl << mat.format(CleanFmt) << endl;
 }
 
-void Helpers::maxElement( const Eigen::MatrixXd& mat, unsigned long& m_idx, unsigned long& n_idx, double& maxVal)
+void Helpers::maxElement( const NNMatrix& mat, unsigned long& m_idx, unsigned long& n_idx, double& maxVal)
 {
     maxVal = numeric_limits<double>::min();
     for( unsigned int m = 0; m < mat.rows(); m++ )
@@ -57,16 +57,16 @@ void Helpers::maxElement( const Eigen::MatrixXd& mat, unsigned long& m_idx, unsi
     }
 }
 
-Eigen::MatrixXd Helpers::mean( const std::vector<Eigen::MatrixXd>& input )
+NNMatrix Helpers::mean( const std::vector<NNMatrix>& input )
 {
     size_t n = input.size();
     if( n == 0 )
     {
         std::cerr << "Helpers::mean: empty.";
-        return Eigen::MatrixXd(0,0);
+        return NNMatrix(0,0);
     }
 
-    Eigen::MatrixXd accum = Eigen::MatrixXd::Constant(input.at(0).rows(),1, 0.0);
+    NNMatrix accum = NNMatrix::Constant(input.at(0).rows(),1, 0.0);
     for(size_t i = 0; i < n; i++)
         accum = accum + input.at(i);
 
@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <random>
+#include <algorithm>
 #include <inc/layer.h>
 
 #include "layer.h"
@@ -37,12 +38,12 @@ Layer::Layer(const uint& nbr_of_neurons , const uint &nbr_of_inputs, const Layer
     m_nbr_of_neurons( nbr_of_neurons ),
     m_nbr_of_inputs( nbr_of_inputs ),
     m_layer_type(type),
-    m_outputLayerCost(0.0)
+    m_perSampleDerivatives(false)
 {
     initLayer();
 }
 
-Layer::Layer( const uint& nbr_of_inputs, const vector<Eigen::VectorXd>& weights, const vector<double>& biases, const LayerOutputType& type ) :
+Layer::Layer( const uint& nbr_of_inputs, const vector<NNVector>& weights, const vector<double>& biases, const LayerOutputType& type ) :
     Layer::Layer( uint(weights.size()), nbr_of_inputs, type )
 {
     assert( weights.size() ==  biases.size() );
@@ -69,15 +70,12 @@ Layer::Layer( const Layer& l ) : Layer( l.getNbrOfNeurons(), l.getNbrOfNeuronInp
 // init vectors and neurons
 void Layer::initLayer()
 {
-    m_weightMatrix = Eigen::MatrixXd( m_nbr_of_neurons , m_nbr_of_inputs );
-    m_biasVector = Eigen::MatrixXd( m_nbr_of_neurons, 1 );
+    m_weightMatrix = NNMatrix( m_nbr_of_neurons , m_nbr_of_inputs );
+    m_biasVector = NNMatrix( m_nbr_of_neurons, 1 );
     resetRandomlyWeightsAndBiases();
 
-    // init with size 1 -> dimensionso of these matrices will change corrsponding to input signal
-    m_activation_in = Eigen::MatrixXd( 1, 1 );
-    m_activation_out = Eigen::MatrixXd( 1, 1 );
-    m_z_weighted_input = Eigen::MatrixXd( 1, 1 );
-    m_backpropagationError =  Eigen::MatrixXd( 1 , 1 );
+    // init for one sample -> the workspace grows corrsponding to the input signal
+    m_workspace.reserve( m_nbr_of_neurons, m_nbr_of_inputs, 1 );
 
     m_costFunction.reset( new QuadraticCost() );
 
@@ -90,7 +88,12 @@ Layer::~Layer()
     // used smart pointers
 }
 
-bool Layer::feedForward(const Eigen::MatrixXd &x_in )
+bool Layer::feedForward( const Eigen::Ref<const NNMatrix>& x_in )
+{
+    return feedForward( x_in, m_workspace );
+}
+
+bool Layer::feedForward( const Eigen::Ref<const NNMatrix>& x_in, LayerWorkspace& ws ) const
 {
     if( x_in.rows() != m_nbr_of_inputs )
     {
@@ -98,33 +101,59 @@ bool Layer::feedForward(const Eigen::MatrixXd &x_in )
         return false;
     }
 
-    m_activation_in = x_in;
-    m_z_weighted_input = m_weightMatrix * x_in + m_biasVector.replicate(1, x_in.cols());
-    m_activation_out = Eigen::MatrixXd(m_z_weighted_input.rows(), m_z_weighted_input.cols());
+    ws.reserve( m_nbr_of_neurons, m_nbr_of_inputs, x_in.cols() );
+    ws.setBatchSize( x_in.cols() );
 
-    if( m_layer_type == Sigmoid )
-    {
-        // compute sigmoid of weighted input matrix
-        for( unsigned int m = 0; m < m_z_weighted_input.rows(); m++ )
-            for( unsigned int n = 0; n < m_z_weighted_input.cols(); n++ )
-                m_activation_out(m,n) = Neuron::sigmoid( m_z_weighted_input(m,n) );
-    }
-    else if( m_layer_type == Softmax )
-    {
-        // compute softmax of weighted input matrix
-        Eigen::MatrixXd expZ = (m_z_weighted_input.array().exp()).matrix();
-        Eigen::MatrixXd expSums = expZ.colwise().sum();
+    ws.inputActivation() = x_in;
+
+    Eigen::Map<NNMatrix> z = ws.weightedInputZ();
+    Eigen::Map<NNMatrix> a = ws.outputActivation();
+
+    const long nbrOfNeurons = m_nbr_of_neurons;
+    const long nbrOfSamples = x_in.cols();
 
-        for( unsigned int n = 0; n < m_z_weighted_input.cols(); n++ ) // each sample
-            for( unsigned int m = 0; m < m_z_weighted_input.rows(); m++ ) // each neuron
-                m_activation_out(m,n) = expZ(m,n) / expSums(0,n);
+    if( nbrOfSamples == 0 )
+        return true;
+
+    // Fused product, bias and activation: the output is computed in tiles of samples, so
+    // a tile of z is still in cache when the activation is applied. A tile holds whole
+    // samples, which softmax needs for its normalization. The bias is written into the
+    // tile first and the product is accumulated onto it, which saves a pass over z.
+    const long tileCols = std::min( nbrOfSamples, std::max( FusedTileMinCols, FusedTileElements / nbrOfNeurons ) );
+
+    for( long c = 0; c < nbrOfSamples; c += tileCols )
+    {
+        const long nc = std::min( tileCols, nbrOfSamples - c );
+        Eigen::Block<Eigen::Map<NNMatrix>, Eigen::Dynamic, Eigen::Dynamic, true> zTile = z.middleCols( c, nc );
+        Eigen::Block<Eigen::Map<NNMatrix>, Eigen::Dynamic, Eigen::Dynamic, true> aTile = a.middleCols( c, nc );
+
+        zTile.colwise() = m_biasVector.col(0);
+        zTile.noalias() += m_weightMatrix * x_in.middleCols( c, nc );
+
+        if( m_layer_type == Sigmoid )
+        {
+            // compute sigmoid of weighted input matrix
+            Neuron::sigmoid( zTile, aTile );
+        }
+        else if( m_layer_type == Softmax )
+        {
+            // compute softmax of weighted input matrix
+            aTile = zTile.array().exp();
+            for( long n = 0; n < nc; n++ ) // each sample
+                aTile.col(n) /= aTile.col(n).sum();
+        }
     }
 
     return true;
 }
 
+void Layer::reserveWorkspace( const long& maxBatchSize )
+{
+    m_workspace.reserve( m_nbr_of_neurons, m_nbr_of_inputs, maxBatchSize );
+}
+
 
-bool Layer::setWeights( const vector<Eigen::VectorXd>& weights )
+bool Layer::setWeights( const vector<NNVector>& weights )
 {
     if( weights.size() != getNbrOfNeurons() )
     {
@@ -138,7 +167,7 @@ bool Layer::setWeights( const vector<Eigen::VectorXd>& weights )
     return true;
 }
 
-bool Layer::setWeights( const Eigen::MatrixXd& weights )
+bool Layer::setWeights( const NNMatrix& weights )
 {
     if( weights.rows() != m_weightMatrix.rows() || weights.cols() != m_weightMatrix.cols() )
     {
@@ -164,7 +193,7 @@ bool Layer::setBiases( const vector<double>& biases )
     return true;
 }
 
-bool Layer::setBiases( const Eigen::MatrixXd& biases )
+bool Layer::setBiases( const NNMatrix& biases )
 {
     if( biases.rows() != getNbrOfNeurons() || biases.cols() != 1 )
     {
@@ -179,7 +208,7 @@ bool Layer::setBiases( const Eigen::MatrixXd& biases )
 
 void Layer::setWeight( const double& weight )
 {
-    Eigen::VectorXd uniformWeight = Eigen::VectorXd::Constant(getNbrOfNeuronInputs(), weight);
+    NNVector uniformWeight = NNVector::Constant(getNbrOfNeuronInputs(), weight);
 
     for( unsigned int n = 0; n < getNbrOfNeurons(); n++ )
         m_weightMatrix.row(n) = uniformWeight.transpose();
@@ -188,7 +217,7 @@ void Layer::setWeight( const double& weight )
 
 void Layer::setBias(const double &bias )
 {
-    m_biasVector = Eigen::MatrixXd::Constant(getNbrOfNeurons(), 1, bias);
+    m_biasVector = NNMatrix::Constant(getNbrOfNeurons(), 1, bias);
 }
 
 void Layer::resetRandomlyWeightsAndBiases()
@@ -208,7 +237,7 @@ void Layer::resetRandomlyWeightsAndBiases()
         double b = biasDist(biasGenerator);
         m_biasVector(i,0) = b;
 
-        Eigen::VectorXd thisWeights = Eigen::VectorXd( getNbrOfNeuronInputs() );
+        NNVector thisWeights = NNVector( getNbrOfNeuronInputs() );
         for( unsigned int k = 0; k < getNbrOfNeuronInputs(); k++ )
             thisWeights(k) = weightDist(weightGenerator);
 
@@ -217,7 +246,12 @@ void Layer::resetRandomlyWeightsAndBiases()
 }
 
 
-bool Layer::setActivationOutput( const Eigen::MatrixXd& activation_out )
+bool Layer::setActivationOutput( const Eigen::Ref<const NNMatrix>& activation_out )
+{
+    return setActivationOutput( activation_out, m_workspace );
+}
+
+bool Layer::setActivationOutput( const Eigen::Ref<const NNMatrix>& activation_out, LayerWorkspace& ws ) const
 {
     if( activation_out.rows() != getNbrOfNeurons() )
     {
@@ -225,14 +259,23 @@ bool Layer::setActivationOutput( const Eigen::MatrixXd& activation_out )
         return false;
     }
 
-    m_activation_out = activation_out;
+    ws.reserve( m_nbr_of_neurons, m_nbr_of_inputs, activation_out.cols() );
+    ws.setBatchSize( activation_out.cols() );
+    ws.outputActivation() = activation_out;
     return true;
 }
 
-bool Layer::computeBackpropagationOutputLayerError(const Eigen::MatrixXd &expectedNetworkOutput )
+bool Layer::computeBackpropagationOutputLayerError( const Eigen::Ref<const NNMatrix>& expectedNetworkOutput )
 {
-    if( m_activation_out.rows() != expectedNetworkOutput.rows() ||
-            m_activation_out.cols() != expectedNetworkOutput.cols())
+    return computeBackpropagationOutputLayerError( expectedNetworkOutput, m_workspace );
+}
+
+bool Layer::computeBackpropagationOutputLayerError( const Eigen::Ref<const NNMatrix>& expectedNetworkOutput, LayerWorkspace& ws ) const
+{
+    const Eigen::Map<const NNMatrix> a = ws.getOutputActivation();
+
+    if( a.rows() != expectedNetworkOutput.rows() ||
+            a.cols() != expectedNetworkOutput.cols())
     {
         std::cout << "Error: Layer activation output to label mismatch" << std::endl;
         return false;
@@ -240,76 +283,109 @@ bool Layer::computeBackpropagationOutputLayerError(const Eigen::MatrixXd &expect
 
     if( m_layer_type == Sigmoid )
     {
-        m_backpropagationError = m_costFunction->delta(m_z_weighted_input, m_activation_out, expectedNetworkOutput);
+        m_costFunction->delta( ws.getWeightedInputZ(), a, expectedNetworkOutput, ws.backpropagationError() );
     }
     else if( m_layer_type == Softmax )
     {
-        m_backpropagationError = m_activation_out - expectedNetworkOutput;
+        ws.backpropagationError() = a - expectedNetworkOutput;
     }
 
     double regularizationCost = m_regularization->regularizationCost();
-    m_outputLayerCost = m_costFunction->cost( m_activation_out, expectedNetworkOutput ) + regularizationCost;
+    ws.m_outputLayerCost = m_costFunction->cost( a, expectedNetworkOutput ) + regularizationCost;
 
     return true;
 }
 
-bool Layer::computeBackprogationError(const Eigen::MatrixXd &errorNextLayer, const Eigen::MatrixXd& weightMatrixNextLayer )
+bool Layer::computeBackprogationError( const Eigen::Ref<const NNMatrix>& errorNextLayer, const Eigen::Ref<const NNMatrix>& weightMatrixNextLayer )
+{
+    return computeBackprogationError( errorNextLayer, weightMatrixNextLayer, m_workspace );
+}
+
+bool Layer::computeBackprogationError( const Eigen::Ref<const NNMatrix>& errorNextLayer, const Eigen::Ref<const NNMatrix>& weightMatrixNextLayer,
+                                       LayerWorkspace& ws ) const
 {
-    if( m_z_weighted_input.rows() != weightMatrixNextLayer.cols()  ||  errorNextLayer.rows() != weightMatrixNextLayer.rows() )
+    if( m_nbr_of_neurons != weightMatrixNextLayer.cols()  ||  errorNextLayer.rows() != weightMatrixNextLayer.rows() ||
+            errorNextLayer.cols() != ws.getBatchSize() )
     {
         std::cout << "Error: computeBackprogationError Layer dimension mismatch" << std::endl;
         return false;
     }
 
-    m_backpropagationError = ((weightMatrixNextLayer.transpose() * errorNextLayer).array() * Neuron::d_sigmoid( m_z_weighted_input ).array()).matrix();
+    // two steps: the product is evaluated directly into the error buffer.
+    // sigmoid'(z) = a * (1 - a) -> reuse the activation instead of recomputing exp(z)
+    Eigen::Map<NNMatrix> delta = ws.backpropagationError();
+    delta.noalias() = weightMatrixNextLayer.transpose() * errorNextLayer;
+    const Eigen::Map<const NNMatrix> a = ws.getOutputActivation();
+    delta.array() *= a.array() * (1.0 - a.array());
+
     return true;
 }
 
 void Layer::computePartialDerivatives()
 {
-    Eigen::MatrixXd delta = getBackpropagationError();
+    computePartialDerivatives( m_workspace );
+}
+
+void Layer::computePartialDerivatives( LayerWorkspace& ws ) const
+{
+    const Eigen::Map<const NNMatrix> delta = ws.getBackpropagationError();
+    const Eigen::Map<const NNMatrix> a_in = ws.getInputActivation();
 
-    m_bias_partialDerivatives.clear();
-    m_weight_partialDerivatives.clear();
+    // summed derivatives over all passed samples -> the weight derivative of the whole
+    // batch is one matrix product instead of one outer product per sample.
+    ws.m_bias_partialDerivativesSum.noalias() = delta.rowwise().sum();
+    ws.m_weight_partialDerivativesSum.noalias() = delta * a_in.transpose();
 
-    // compute derivatives for each passed sample
+    ws.m_bias_partialDerivatives.clear();
+    ws.m_weight_partialDerivatives.clear();
+
+    if( !m_perSampleDerivatives )
+        return;
+
+    // debug: compute derivatives for each passed sample
     for( unsigned int k = 0; k < delta.cols(); k++ )
     {
-        Eigen::MatrixXd thisDelta = delta.col(k);
-        m_bias_partialDerivatives.push_back( thisDelta );
+        NNMatrix thisDelta = delta.col(k);
+        ws.m_bias_partialDerivatives.push_back( thisDelta );
 
-        Eigen::MatrixXd thisInputActivation = getInputActivation().col(k);
-        m_weight_partialDerivatives.push_back( delta.col(k) * thisInputActivation.transpose() ); // This is different from the 4th-equation? Study!
+        NNMatrix thisInputActivation = a_in.col(k);
+        ws.m_weight_partialDerivatives.push_back( delta.col(k) * thisInputActivation.transpose() ); // This is different from the 4th-equation? Study!
     }
 }
 
 void Layer::updateWeightsAndBiases(const double &eta, const unsigned int& sampleIdx )
 {
-    updateWeightsAndBiases(eta * getPartialDerivativesBiases().at(sampleIdx), eta * getPartialDerivativesWeights().at(sampleIdx), eta );
+    if( m_perSampleDerivatives )
+        updateWeightsAndBiases(eta * getPartialDerivativesBiases().at(sampleIdx), eta * getPartialDerivativesWeights().at(sampleIdx), eta );
+    else
+        updateWeightsAndBiasesAveraged( m_workspace, eta, 1 );
 }
 
-void Layer::updateWeightsAndBiases(const Eigen::MatrixXd& deltaBias, const Eigen::MatrixXd& deltaWeight, const double& eta)
+void Layer::updateWeightsAndBiases( const Eigen::Ref<const NNMatrix>& deltaBias, const Eigen::Ref<const NNMatrix>& deltaWeight, const double& eta )
 {
+    m_biasVector -= deltaBias;
 
-    const Eigen::MatrixXd newBiases = getBiasVector() - deltaBias;
-    setBiases( newBiases );
+    if( getRegularizationMethod()->m_method == Regularization::RegularizationMethod::WeightDecay )
+        m_weightMatrix *= (1-getRegularizationMethod()->m_lamda * eta);
 
-    Eigen::MatrixXd newWeights;
-    switch( getRegularizationMethod()->m_method )
-    {
-        case Regularization::RegularizationMethod::WeightDecay:
-            newWeights = (1-getRegularizationMethod()->m_lamda * eta) * getWeightMatrix()  -   deltaWeight;
-            break;
+    m_weightMatrix -= deltaWeight;
+}
 
-        default:
-            newWeights = getWeightMatrix() - deltaWeight;
-    }
-    setWeights( newWeights );
+void Layer::updateWeightsAndBiasesAveraged( const LayerWorkspace& ws, const double& eta, const long& nbrOfSamples )
+{
+    const double factor = eta / double(nbrOfSamples);
+
+    m_biasVector -= factor * ws.getPartialDerivativesBiasesSum();
+
+    if( getRegularizationMethod()->m_method == Regularization::RegularizationMethod::WeightDecay )
+        m_weightMatrix *= (1-getRegularizationMethod()->m_lamda * eta);
+
+    m_weightMatrix -= factor * ws.getPartialDerivativesWeightsSum();
 }
 
 void Layer::print() const
 {
-    Eigen::VectorXd a;
+    NNVector a;
 
     Helpers::printVector(getBiasVector(),"Biases");
     Helpers::printMatrix(getWeightMatrix(),"Weights");
@@ -356,7 +432,7 @@ Layer* Layer::deserialize( const string& buffer )
 
     size_t offset = 3 * sizeof(unsigned int);
 
-    Eigen::MatrixXd weightMatrix = Eigen::MatrixXd( nbrOfNeurons , nbrOfInputs );
+    NNMatrix weightMatrix = NNMatrix( nbrOfNeurons , nbrOfInputs );
     const double* weightBuf = (const double*)((buf + offset));
     for( size_t m = 0; m < nbrOfNeurons; m++ )
         for( size_t n = 0; n < nbrOfInputs; n++ )
@@ -364,7 +440,7 @@ Layer* Layer::deserialize( const string& buffer )
 
     offset = offset + nbrOfNeurons*nbrOfInputs*sizeof(double);
 
-    Eigen::MatrixXd biasVector = Eigen::MatrixXd( nbrOfNeurons, 1 );
+    NNMatrix biasVector = NNMatrix( nbrOfNeurons, 1 );
     const double* biasBuf = (const double*)((buf + offset));
     for( size_t m = 0; m < nbrOfNeurons; m++ )
         biasVector( long(m), 0 ) = biasBuf[ m ];
@@ -31,18 +31,22 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <numeric>
+#include <chrono>
 #include <inc/network.h>
 
 using namespace std;
 
 Network::Network( const vector<unsigned int> networkStructure ) :
-    m_NetworkStructure( networkStructure ), m_oberserver( NULL ), m_asyncOperation{}, m_operationInProgress( false )
+    m_NetworkStructure( networkStructure ), m_nbrOfThreads( 1 ), m_oberserver( NULL ), m_executor( &Executor::global() ),
+    m_operationInProgress( false ), m_operationCounter( 0 ), m_runningOperation( 0 ), m_cancelledOperation( 0 )
 {
     initNetwork();
 }
 
 Network::Network( const Network& n ) :
-    m_NetworkStructure( n.getNetworkStructure() ), m_oberserver( n.m_oberserver ), m_asyncOperation{}, m_operationInProgress( false )
+    m_NetworkStructure( n.getNetworkStructure() ), m_nbrOfThreads( 1 ), m_oberserver( n.m_oberserver ), m_executor( n.m_executor ),
+    m_operationInProgress( false ), m_operationCounter( 0 ), m_runningOperation( 0 ), m_cancelledOperation( 0 )
 {
     // copy layers
     m_Layers.clear();
@@ -53,19 +57,28 @@ Network::Network( const Network& n ) :
         m_Layers.push_back( cp_layer );
     }
 
-    m_activation_out = Eigen::MatrixXd( 1, 1 ); // dimension will be updated based on nbr of input samples
+    m_shuffleGenerator.seed( std::random_device()() );
 
     getOutputLayer()->setCostFunction(n.getOutputLayer()->getCostFunction());
     setSoftmaxOutput(n.isSoftmaxOutputEnabled());
 
     setRegularizationMethod(n.getRegularizationMethod());
+
+    setNumberOfThreads(n.getNumberOfThreads());
+
+    m_batchTransform = n.m_batchTransform;
+    setBatchPrefetching(n.isBatchPrefetchingEnabled());
 }
 
 
 Network::~Network()
 {
-    if( m_asyncOperation.joinable() )
-        m_asyncOperation.detach();
+    // the queued or running operation refers to this network
+    if( m_asyncOperation.valid() )
+    {
+        cancelAsyncOperation();
+        m_asyncOperation.wait();
+    }
 }
 
 void Network::initNetwork()
@@ -78,31 +91,79 @@ void Network::initNetwork()
         nbrOfInputs = nbrOfNeuronsInLayer; // the next layer has same number of inputs as neurons in this layer.
     }
 
-    m_activation_out = Eigen::MatrixXd( 1, 1 ); // dimension will be updated based on nbr of input samples
+    m_shuffleGenerator.seed( std::random_device()() );
 
     m_regularization.reset( new Regularization(Regularization::RegularizationMethod::NoneRegularization, 1.0 ));
 }
 
-bool Network::feedForward( const Eigen::MatrixXd& x_in )
+bool Network::feedForward( const Eigen::Ref<const NNMatrix>& x_in )
+{
+    return doFeedForward( x_in, nullptr );
+}
+
+bool Network::feedForward( const Eigen::Ref<const NNMatrix>& x_in, NetworkWorkspace& ws ) const
+{
+    if( ws.size() != m_Layers.size() )
+        ws.resize( m_Layers.size() );
+
+    return feedForwardLayers( x_in, [&ws]( const unsigned int& k ) -> LayerWorkspace& { return ws.at(k); } );
+}
+
+NetworkWorkspace Network::createWorkspace( const long& maxBatchSize ) const
+{
+    NetworkWorkspace ws( m_Layers.size() );
+    for( unsigned int k = 0; k < m_Layers.size(); k++ )
+        ws.at(k).reserve( m_Layers[k]->getNbrOfNeurons(), m_Layers[k]->getNbrOfNeuronInputs(), maxBatchSize );
+
+    return ws;
+}
+
+LayerWorkspace& Network::getLayerWorkspace( const unsigned int& layerIdx, NetworkWorkspace* ws )
+{
+    if( ws == nullptr )
+        return m_Layers[layerIdx]->m_workspace;
+
+    return ws->at( layerIdx );
+}
+
+bool Network::doFeedForward( const Eigen::Ref<const NNMatrix>& x_in, NetworkWorkspace* ws )
+{
+    if( ws != nullptr )
+        return feedForward( x_in, *ws );
+
+    return feedForwardLayers( x_in, [this]( const unsigned int& k ) -> LayerWorkspace& { return m_Layers[k]->m_workspace; } );
+}
+
+template <typename WorkspaceOf>
+bool Network::feedForwardLayers( const Eigen::Ref<const NNMatrix>& x_in, WorkspaceOf workspaceOf ) const
 {
     // first layer does not perform any operation. It's activation output is just x_in.
-    if( ! getLayer(0)->setActivationOutput(x_in) )
+    if( ! m_Layers[0]->setActivationOutput( x_in, workspaceOf(0) ) )
         return false;
 
     for( unsigned int k = 1; k < m_Layers.size(); k++ )
     {
         // Pass output signal from former layer to next layer.
-        if( ! getLayer( k )->feedForward(  getLayer( k-1 )->getOutputActivation()  ) )
+        if( ! m_Layers[k]->feedForward( workspaceOf(k-1).getOutputActivation(), workspaceOf(k) ) )
         {
             cout << "Error: Outpt-Input signal size mismatch" << endl;
             return false;
         }
     }
 
+    return true;
+}
+
+Eigen::Map<const NNMatrix> Network::getOutputActivation() const
+{
     // network output signal is in the last layer
-    m_activation_out = m_Layers.back()->getOutputActivation();
+    return m_Layers.back()->getOutputActivation();
+}
 
-    return true;
+void Network::reserveWorkspace( const long& maxBatchSize )
+{
+    for( std::shared_ptr<Layer>& l : m_Layers )
+        l->reserveWorkspace( maxBatchSize );
 }
 
 unsigned int Network::getNumberOfLayer() const
@@ -132,8 +193,10 @@ shared_ptr<const Layer> Network::getLayer(const unsigned int &layerIdx ) const
     return m_Layers.at(layerIdx);
 }
 
-bool Network::gradientDescent( const Eigen::MatrixXd& x_in, const Eigen::MatrixXd& y_out, const double& eta )
+bool Network::gradientDescent( const Eigen::Ref<const NNMatrix>& x_in, const Eigen::Ref<const NNMatrix>& y_out, const double& eta )
 {
+    updateRegularization( x_in.cols() );
+
     if( ! doFeedforwardAndBackpropagation(x_in, y_out ) )
         return false;
 
@@ -145,102 +208,302 @@ bool Network::gradientDescent( const Eigen::MatrixXd& x_in, const Eigen::MatrixX
     return true;
 }
 
-bool Network::stochasticGradientDescentAsync(const std::vector<Eigen::MatrixXd> &samples, const std::vector<Eigen::MatrixXd> &lables,
+bool Network::stochasticGradientDescentAsync(const std::vector<NNMatrix> &samples, const std::vector<NNMatrix> &lables,
                                              const unsigned int& batchsize, const double& eta, const int& userId)
 {
-    if( !prepareForNextAsynchronousOperation() )
+    return submitAsynchronousOperation( userId, [this, samples, lables, batchsize, eta]() { stochasticGradientDescent( samples, lables, batchsize, eta ); } );
+}
+
+bool Network::stochasticGradientDescentAsync( std::shared_ptr<const std::vector<NNMatrix>> samples, std::shared_ptr<const std::vector<NNMatrix>> lables,
+                                              const unsigned int& batchsize, const double& eta, const int& userId )
+{
+    if( !samples || !lables )
+    {
+        cout << "Error: No samples or lables passed" << endl;
         return false;
+    }
 
-    m_userID = userId;
-    m_asyncOperation = std::thread(&Network::stochasticGradientDescent, this,  samples, lables, batchsize, eta);
-    return true;
+    return submitAsynchronousOperation( userId, [this, samples, lables, batchsize, eta]() { stochasticGradientDescent( *samples, *lables, batchsize, eta ); } );
+}
+
+bool Network::stochasticGradientDescentAsync( const Dataset& dataset, const unsigned int& batchsize, const double& eta, const int& userId )
+{
+    return submitAsynchronousOperation( userId, [this, dataset, batchsize, eta]() { stochasticGradientDescent( dataset, batchsize, eta ); } );
 }
 
-bool Network::stochasticGradientDescent(const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+bool Network::stochasticGradientDescent(const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
                                         const unsigned int& batchsize, const double& eta)
-{    
-    bool retValue = false;
-    size_t nbrOfSamples = samples.size();
+{
+    if( !checkTrainingSet( samples.size(), lables.size(), batchsize ) )
+    {
+        m_operationInProgress = false;
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpResultErr, 1.0);
+        return false;
+    }
 
-    if( samples.size() != lables.size() )
+    return doStochasticGradientDescent( samples.size(), batchsize, eta,
+        [&samples, &lables]( const size_t* sampleIdx, const unsigned int& count, NNMatrix& batch_in, NNMatrix& batch_out )
+        {
+            batch_in.resize( samples.at(0).rows(), count );
+            batch_out.resize( lables.at(0).rows(), count );
+            for( unsigned int b = 0; b < count; b++ )
+            {
+                batch_in.col(b) = samples.at( sampleIdx[b] );
+                batch_out.col(b) = lables.at( sampleIdx[b] );
+            }
+        } );
+}
+
+bool Network::stochasticGradientDescent( const Dataset& dataset, const unsigned int& batchsize, const double& eta )
+{
+    if( !checkTrainingSet( dataset.getNumberOfSamples(), dataset.getNumberOfSamples(), batchsize ) )
     {
-        cout << "Error: number of samples and lables mismatch" << endl;
+        m_operationInProgress = false;
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpResultErr, 1.0);
+        return false;
     }
-    else if( nbrOfSamples < batchsize )
+
+    return doStochasticGradientDescent( dataset.getNumberOfSamples(), batchsize, eta,
+        [&dataset]( const size_t* sampleIdx, const unsigned int& count, NNMatrix& batch_in, NNMatrix& batch_out )
+        {
+            dataset.gather( sampleIdx, count, batch_in, batch_out );
+        } );
+}
+
+bool Network::doStochasticGradientDescent( const size_t& nbrOfSamples, const unsigned int& batchsize, const double& eta, const BatchGatherer& gather )
+{
+    // one epoch
+    unsigned long nbrOfBatches = nbrOfSamples / batchsize;
+
+    shuffleSampleOrder( nbrOfSamples );
+
+    if( m_batchPrefetcher )
     {
-        cout << "Error: batchsize exceeds number of available smaples" << endl;
+        // the loader thread assembles batch k+1 while batch k is trained
+        const BatchPrefetcher::BatchLoader load = [&]( const size_t& batch, NNMatrix& batch_in, NNMatrix& batch_out )
+        {
+            gather( m_sampleOrder.data() + batch*batchsize, batchsize, batch_in, batch_out );
+            if( m_batchTransform )
+                m_batchTransform( batch_in, batch_out );
+        };
+
+        m_batchPrefetcher->start( nbrOfBatches, load );
+
+        for( unsigned int batch = 0; batch < nbrOfBatches && !isCancelRequested(); batch++ )
+        {
+            const NNMatrix* batch_in;
+            const NNMatrix* batch_out;
+            m_batchPrefetcher->next( batch_in, batch_out );
+
+            doStochasticGradientDescentBatch(*batch_in, *batch_out, eta);
+
+            sendProg2Obs( NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpInProgress, double(batch)/double(nbrOfBatches) );
+        }
+
+        m_batchPrefetcher->finish();
     }
     else
     {
-        // one epoch
-        unsigned long nbrOfBatches = nbrOfSamples / batchsize;
+        // batch buffers are kept -> no allocation when training repeatedly on the same data set.
+        for( unsigned int batch = 0; batch < nbrOfBatches && !isCancelRequested(); batch++ )
+        {
+            // generate a random sample set
+            gather( m_sampleOrder.data() + batch*batchsize, batchsize, m_batch_in, m_batch_out );
+            if( m_batchTransform )
+                m_batchTransform( m_batch_in, m_batch_out );
+
+            doStochasticGradientDescentBatch(m_batch_in, m_batch_out, eta);
 
-        std::vector<size_t> randIndices = randomIndices(nbrOfSamples);
+            sendProg2Obs( NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpInProgress, double(batch)/double(nbrOfBatches) );
+        }
+    }
 
-        Eigen::MatrixXd batch_in( samples.at(0).rows(), batchsize );
-        Eigen::MatrixXd batch_out( lables.at(0).rows(), batchsize );
+    m_operationInProgress = false;
 
-        for( unsigned int batch = 0; batch < nbrOfBatches; batch++ )
+    if( isCancelRequested() )
+    {
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpResultCancelled, 1.0);
+        return false;
+    }
+
+    sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpResultOk, 1.0);
+
+    return true;
+}
+
+bool Network::stochasticGradientDescentHogwild( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
+                                                const unsigned int& batchsize, const double& eta )
+{
+    if( !checkTrainingSet( samples.size(), lables.size(), batchsize ) )
+    {
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescentHogwild, NetworkOperationCallback::OpResultErr, 1.0);
+        return false;
+    }
+
+    return doStochasticGradientDescentHogwild( samples.size(), batchsize, eta,
+        [&samples, &lables]( const size_t* sampleIdx, const unsigned int& count, NNMatrix& batch_in, NNMatrix& batch_out )
         {
-            // generate a random sample set
-            for( unsigned int b = 0; b < batchsize; b++ )
+            batch_in.resize( samples[0].rows(), count );
+            batch_out.resize( lables[0].rows(), count );
+            for( unsigned int b = 0; b < count; b++ )
             {
-                size_t rIdx =  randIndices[batch*batchsize+b];
-                batch_in.col(b) = samples.at(rIdx);
-                batch_out.col(b) = lables.at(rIdx);
+                batch_in.col(b) = samples[ sampleIdx[b] ];
+                batch_out.col(b) = lables[ sampleIdx[b] ];
             }
+        } );
+}
 
-            doStochasticGradientDescentBatch(batch_in, batch_out, eta);
+bool Network::stochasticGradientDescentHogwild( const Dataset& dataset, const unsigned int& batchsize, const double& eta )
+{
+    if( !checkTrainingSet( dataset.getNumberOfSamples(), dataset.getNumberOfSamples(), batchsize ) )
+    {
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescentHogwild, NetworkOperationCallback::OpResultErr, 1.0);
+        return false;
+    }
 
-            sendProg2Obs( NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpInProgress, double(batch)/double(nbrOfBatches) );
+    return doStochasticGradientDescentHogwild( dataset.getNumberOfSamples(), batchsize, eta,
+        [&dataset]( const size_t* sampleIdx, const unsigned int& count, NNMatrix& batch_in, NNMatrix& batch_out )
+        {
+            dataset.gather( sampleIdx, count, batch_in, batch_out );
+        } );
+}
+
+bool Network::doStochasticGradientDescentHogwild( const size_t& nbrOfSamples, const unsigned int& batchsize, const double& eta,
+                                                  const BatchGatherer& gather )
+{
+    const unsigned long nbrOfBatches = nbrOfSamples / batchsize;
+    const unsigned int nbrOfWorkers = m_workerPool ? m_workerPool->getNbrOfWorkers() : 1;
+
+    // all workers draw their batches from the same permutation
+    shuffleSampleOrder( nbrOfSamples );
+    updateRegularization( batchsize );
+
+    prepareWorkerWorkspaces( nbrOfWorkers );
+    m_workerBatchIn.resize( nbrOfWorkers );
+    m_workerBatchOut.resize( nbrOfWorkers );
+    m_workerResults.assign( nbrOfWorkers, 1 );
+    m_workerThroughput.assign( nbrOfWorkers, 0.0 );
+
+    std::atomic<unsigned long> nextBatch( 0 );
+
+    std::function<void(const unsigned int&)> job = [&]( const unsigned int& w )
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        size_t nbrOfProcessedSamples = 0;
+
+        NetworkWorkspace* ws = w == 0 ? nullptr : &m_workerWorkspaces[w-1];
+        NNMatrix& batch_in = m_workerBatchIn[w];
+        NNMatrix& batch_out = m_workerBatchOut[w];
+
+        for(;;)
+        {
+            const unsigned long batch = nextBatch.fetch_add( 1, std::memory_order_relaxed );
+            if( batch >= nbrOfBatches )
+                break;
+
+            gather( m_sampleOrder.data() + batch*batchsize, batchsize, batch_in, batch_out );
+            if( m_batchTransform )
+                m_batchTransform( batch_in, batch_out );
+
+            if( !doFeedforwardAndBackpropagation( batch_in, batch_out, ws ) )
+            {
+                m_workerResults[w] = 0;
+                break;
+            }
+
+            // no locking: the shared weights and biases are updated while other workers read them
+            for( unsigned int k = 1; k < getNumberOfLayer(); k++ )
+                m_Layers[k]->updateWeightsAndBiasesAveraged( getLayerWorkspace(k, ws), eta, batchsize );
+
+            nbrOfProcessedSamples += batchsize;
+
+            // the observer is only informed by the calling thread
+            if( w == 0 )
+                sendProg2Obs( NetworkOperationCallback::OpStochasticGradientDescentHogwild, NetworkOperationCallback::OpInProgress,
+                              double(batch)/double(nbrOfBatches) );
         }
 
-        retValue = true;
-    }
+        const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        m_workerThroughput[w] = seconds > 0.0 ? double(nbrOfProcessedSamples) / seconds : 0.0;
+    };
 
-    m_operationInProgress = false;
+    if( m_workerPool )
+        m_workerPool->run( job );
+    else
+        job( 0 );
+
+    const bool retValue = std::all_of( m_workerResults.begin(), m_workerResults.end(), []( char r ) { return r != 0; } );
 
     if( retValue )
     {
-        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpResultOk, 1.0);
+        if( m_oberserver != NULL )
+            m_oberserver->networkWorkerThroughput( NetworkOperationCallback::OpStochasticGradientDescentHogwild, m_workerThroughput, m_userID );
+
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescentHogwild, NetworkOperationCallback::OpResultOk, 1.0);
     }
     else
     {
-        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescent, NetworkOperationCallback::OpResultErr, 1.0);
+        sendProg2Obs(NetworkOperationCallback::OpStochasticGradientDescentHogwild, NetworkOperationCallback::OpResultErr, 1.0);
     }
 
     return retValue;
 }
 
-bool Network::doStochasticGradientDescentBatch(const Eigen::MatrixXd& batch_in, const Eigen::MatrixXd& batch_out, const double& eta)
+bool Network::checkTrainingSet( const size_t& nbrOfSamples, const size_t& nbrOfLables, const unsigned int& batchsize ) const
 {
-    // this feedforwards the whole batch at once
-    if( !doFeedforwardAndBackpropagation( batch_in, batch_out ) )
+    if( nbrOfSamples != nbrOfLables )
+    {
+        cout << "Error: number of samples and lables mismatch" << endl;
         return false;
+    }
 
-    long batchsize = batch_in.cols();
-
-    // compute average partial derivatives over all samples in all layers
-    for( unsigned int j = 1; j < getNumberOfLayer(); j++ )
+    if( nbrOfSamples < batchsize || batchsize == 0 )
     {
-        const std::shared_ptr<Layer>& l = getLayer(j);
+        cout << "Error: batchsize exceeds number of available smaples" << endl;
+        return false;
+    }
+
+    return true;
+}
 
-        Eigen::MatrixXd biasSum = Eigen::MatrixXd::Constant( l->getNbrOfNeurons(), 1, 0.0 );
-        Eigen::MatrixXd weightSum = Eigen::MatrixXd::Constant( l->getNbrOfNeurons(), l->getNbrOfNeuronInputs(), 0.0 );
+void Network::shuffleSampleOrder( const size_t& nbrOfSamples )
+{
+    // the order vector is kept -> no allocation when training repeatedly on the same data set.
+    m_sampleOrder.resize( nbrOfSamples );
+    std::iota( m_sampleOrder.begin(), m_sampleOrder.end(), 0 );
+    std::shuffle( m_sampleOrder.begin(), m_sampleOrder.end(), m_shuffleGenerator );
+}
 
-        vector<Eigen::MatrixXd> pd_biases = l->getPartialDerivativesBiases();
-        vector<Eigen::MatrixXd> pd_weigths = l->getPartialDerivativesWeights();
+void Network::prepareWorkerWorkspaces( const unsigned int& nbrOfWorkers )
+{
+    if( m_workerWorkspaces.size() + 1 < nbrOfWorkers )
+        m_workerWorkspaces.resize( nbrOfWorkers - 1, NetworkWorkspace( m_Layers.size() ) );
+}
 
-        for( unsigned int k = 0; k < pd_biases.size(); k++ )
-        {
-            biasSum = biasSum + pd_biases.at(k);
-            weightSum = weightSum + pd_weigths.at(k);
-        }
+bool Network::doStochasticGradientDescentBatch( const Eigen::Ref<const NNMatrix>& batch_in, const Eigen::Ref<const NNMatrix>& batch_out, const double& eta )
+{
+    updateRegularization( batch_in.cols() );
+
+    // this feedforwards the whole batch at once
+    if( m_workerPool )
+    {
+        if( !doParallelFeedforwardAndBackpropagation( batch_in, batch_out ) )
+            return false;
+    }
+    else
+    {
+        if( !doFeedforwardAndBackpropagation( batch_in, batch_out ) )
+            return false;
+    }
+
+    long batchsize = batch_in.cols();
 
-        // update weights and biases in layer
-        Eigen::MatrixXd avgPDBias = biasSum * ( eta / double(batchsize) );
-        Eigen::MatrixXd avgPDWeights = weightSum * ( eta / double(batchsize) );
-        l->updateWeightsAndBiases(avgPDBias, avgPDWeights, eta);
+    // compute average partial derivatives over all samples in all layers
+    for( unsigned int j = 1; j < getNumberOfLayer(); j++ )
+    {
+        // the layer sums up the derivatives of the batch already
+        const std::shared_ptr<Layer>& l = m_Layers[j];
+        l->updateWeightsAndBiasesAveraged( l->getWorkspace(), eta, batchsize );
     }
 
     return true;
@@ -258,7 +521,7 @@ std::shared_ptr<const Layer> Network::getOutputLayer() const
 
 double Network::getNetworkErrorMagnitude() const
 {
-    Eigen::MatrixXd oErr =  getOutputLayer()->getBackpropagationError();
+    const Eigen::Map<const NNMatrix> oErr = getOutputLayer()->getBackpropagationError();
 
     size_t n = oErr.cols();
 
@@ -292,42 +555,103 @@ void Network::print()
     }
 }
 
-bool Network::doFeedforwardAndBackpropagation( const Eigen::MatrixXd& x_in, const Eigen::MatrixXd& y_out )
+void Network::updateRegularization( const long& nbrOfSamples )
 {
-    // updates output in all layers
-    if( ! feedForward(x_in) )
-        return false;
-
     if( m_regularization->m_method == Regularization::RegularizationMethod::WeightDecay )
     {
         getOutputLayer()->getRegularizationMethod()->m_weightSum = getSumOfWeighSquares();
-        getOutputLayer()->getRegularizationMethod()->m_nbrSamples = x_in.cols();
+        getOutputLayer()->getRegularizationMethod()->m_nbrSamples = size_t(nbrOfSamples);
     }
+}
+
+bool Network::doFeedforwardAndBackpropagation( const Eigen::Ref<const NNMatrix>& x_in, const Eigen::Ref<const NNMatrix>& y_out,
+                                               NetworkWorkspace* ws )
+{
+    // updates output in all layers
+    if( ! doFeedForward( x_in, ws ) )
+        return false;
+
+    const unsigned int outputLayerIdx = getNumberOfLayer() - 1;
 
-    if( getOutputActivation().rows() != y_out.rows() )
+    if( getLayerWorkspace(outputLayerIdx, ws).getOutputActivation().rows() != y_out.rows() )
     {
         cout << "Error: desired output signal mismatching dimension" << endl;
         return false;
     }
 
     // Compute output error in the last layer
-    std::shared_ptr<Layer> layerAfter = getOutputLayer();
-    layerAfter->computeBackpropagationOutputLayerError( y_out );
-    layerAfter->computePartialDerivatives();
+    const std::shared_ptr<Layer>& outputLayer = m_Layers[outputLayerIdx];
+    outputLayer->computeBackpropagationOutputLayerError( y_out, getLayerWorkspace(outputLayerIdx, ws) );
+    outputLayer->computePartialDerivatives( getLayerWorkspace(outputLayerIdx, ws) );
 
     // Compute error and partial derivatives in all remaining layers, but not input layer
-    for( int k = int(getNumberOfLayer()) - 2; k > 0; k-- )
+    for( int k = int(outputLayerIdx) - 1; k > 0; k-- )
     {
-        std::shared_ptr<Layer> thisLayer = getLayer( unsigned(k) );
-        thisLayer->computeBackprogationError( layerAfter->getBackpropagationError(), layerAfter->getWeightMatrix() );
-        thisLayer->computePartialDerivatives();
+        const std::shared_ptr<Layer>& thisLayer = m_Layers[k];
+        const std::shared_ptr<Layer>& layerAfter = m_Layers[k+1];
 
-        layerAfter = thisLayer;
+        thisLayer->computeBackprogationError( getLayerWorkspace(unsigned(k+1), ws).getBackpropagationError(), layerAfter->getWeightMatrix(),
+                                              getLayerWorkspace(unsigned(k), ws) );
+        thisLayer->computePartialDerivatives( getLayerWorkspace(unsigned(k), ws) );
     }
 
     return true;
 }
 
+bool Network::doParallelFeedforwardAndBackpropagation( const Eigen::Ref<const NNMatrix>& x_in, const Eigen::Ref<const NNMatrix>& y_out )
+{
+    const long nbrOfSamples = x_in.cols();
+    const unsigned int nbrOfShards = unsigned( std::min( long(m_workerPool->getNbrOfWorkers()), nbrOfSamples ) );
+    const long shardSize = nbrOfSamples / nbrOfShards;
+    const long shardRemainder = nbrOfSamples % nbrOfShards;
+
+    prepareWorkerWorkspaces( nbrOfShards );
+    m_workerResults.assign( m_workerPool->getNbrOfWorkers(), 1 );
+
+    // worker 0 computes in the layers' own workspaces
+    std::function<void(const unsigned int&)> job = [&]( const unsigned int& w )
+    {
+        if( w >= nbrOfShards )
+            return;
+
+        const long begin = long(w) * shardSize + std::min( long(w), shardRemainder );
+        const long size = shardSize + ( long(w) < shardRemainder ? 1 : 0 );
+        NetworkWorkspace* ws = w == 0 ? nullptr : &m_workerWorkspaces[w-1];
+
+        m_workerResults[w] = doFeedforwardAndBackpropagation( x_in.middleCols(begin, size), y_out.middleCols(begin, size), ws );
+    };
+
+    m_workerPool->run( job );
+
+    for( unsigned int w = 0; w < nbrOfShards; w++ )
+        if( !m_workerResults[w] )
+            return false;
+
+    // reduce the summed partial derivatives of all shards into the layers' own workspaces
+    for( unsigned int k = 1; k < getNumberOfLayer(); k++ )
+    {
+        LayerWorkspace& sum = m_Layers[k]->m_workspace;
+        for( unsigned int w = 1; w < nbrOfShards; w++ )
+        {
+            const LayerWorkspace& shard = m_workerWorkspaces[w-1].at(k);
+            sum.m_bias_partialDerivativesSum += shard.m_bias_partialDerivativesSum;
+            sum.m_weight_partialDerivativesSum += shard.m_weight_partialDerivativesSum;
+        }
+    }
+
+    // the cost of a shard is averaged over its samples -> weighted average
+    LayerWorkspace& outputWs = getOutputLayer()->m_workspace;
+    double cost = outputWs.m_outputLayerCost * double(outputWs.getBatchSize());
+    for( unsigned int w = 1; w < nbrOfShards; w++ )
+    {
+        const LayerWorkspace& shard = m_workerWorkspaces[w-1].at( getNumberOfLayer() - 1 );
+        cost += shard.m_outputLayerCost * double(shard.getBatchSize());
+    }
+    outputWs.m_outputLayerCost = cost / double(nbrOfSamples);
+
+    return true;
+}
+
 void Network::sendProg2Obs( const NetworkOperationCallback::NetworkOperationId& opId,
                                       const NetworkOperationCallback::NetworkOperationStatus& opStatus,
                                       const double& progress  )
@@ -336,7 +660,7 @@ void Network::sendProg2Obs( const NetworkOperationCallback::NetworkOperationId&
         m_oberserver->networkOperationProgress( opId, opStatus, progress, m_userID );
 }
 
-bool Network::prepareForNextAsynchronousOperation()
+bool Network::submitAsynchronousOperation( const int& userId, const Executor::Task& operation )
 {
     if( isOperationInProgress() )
     {
@@ -345,32 +669,108 @@ bool Network::prepareForNextAsynchronousOperation()
     }
 
     m_operationInProgress = true;
-    if( m_asyncOperation.joinable() ) // Join former thread if done yet
-        m_asyncOperation.join();
+    m_userID = userId;
+
+    const unsigned long operationId = ++m_operationCounter;
+    Executor::Task task = [this, operationId, op = operation]() mutable
+    {
+        m_runningOperation = operationId;
+        op();
+
+        // the future keeps the task alive -> release the captured data now
+        op = nullptr;
+
+        // a next operation may already run, if this one reported its end
+        unsigned long expected = operationId;
+        m_runningOperation.compare_exchange_strong( expected, 0 );
+    };
+
+    // back-pressure: rather fail than block the caller
+    if( !m_executor->trySubmit( task, m_asyncOperation ) )
+    {
+        cout << "Error: Too many asynchronous operations queued" << endl;
+        m_operationInProgress = false;
+        return false;
+    }
 
     return true;
 }
 
-bool Network::testNetworkAsync( const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+void Network::cancelAsyncOperation()
+{
+    if( isOperationInProgress() )
+        m_cancelledOperation = m_operationCounter.load();
+}
+
+bool Network::isCancelRequested() const
+{
+    const unsigned long running = m_runningOperation;
+    return running != 0 && running == m_cancelledOperation;
+}
+
+void Network::setExecutor( Executor* executor )
+{
+    if( isOperationInProgress() )
+    {
+        cout << "Error: Executor cannot be changed while an asynchronous operation is in progress" << endl;
+        return;
+    }
+
+    m_executor = executor != nullptr ? executor : &Executor::global();
+}
+
+bool Network::testNetworkAsync( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
                        const double& euclideanDistanceThreshold, const int& userId )
 {
-    if( !prepareForNextAsynchronousOperation() )
+    return submitAsynchronousOperation( userId, [this, samples, lables, euclideanDistanceThreshold]() { doTestAsync( samples, lables, euclideanDistanceThreshold ); } );
+}
+
+bool Network::testNetworkAsync( std::shared_ptr<const std::vector<NNMatrix>> samples, std::shared_ptr<const std::vector<NNMatrix>> lables,
+                                const double& euclideanDistanceThreshold, const int& userId )
+{
+    if( !samples || !lables )
+    {
+        cout << "Error: No samples or lables passed" << endl;
         return false;
+    }
 
-    m_userID = userId;
-    m_asyncOperation = std::thread(&Network::doTestAsync, this,  samples, lables, euclideanDistanceThreshold);
-    return true;
+    return submitAsynchronousOperation( userId, [this, samples, lables, euclideanDistanceThreshold]() { doTestAsync( *samples, *lables, euclideanDistanceThreshold ); } );
+}
+
+bool Network::testNetworkAsync( const Dataset& dataset, const double& euclideanDistanceThreshold, const int& userId )
+{
+    return submitAsynchronousOperation( userId, [this, dataset, euclideanDistanceThreshold]() { doTestAsync( dataset, euclideanDistanceThreshold ); } );
 }
 
 // this intermediate function is necessary because testNetwork results are passed by reference
-void Network::doTestAsync( const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+void Network::doTestAsync( const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
                            const double& euclideanDistanceThreshold )
 {
     double successRateEuclidean; double successRateMaxIdx; double avgCost; std::vector<size_t> failedSamples;
     bool res = testNetwork( samples, lables, euclideanDistanceThreshold, true, successRateEuclidean, successRateMaxIdx, avgCost, failedSamples );
 
+    sendTestResults2Obs( res, successRateEuclidean, successRateMaxIdx, avgCost, failedSamples );
+}
+
+void Network::doTestAsync( const Dataset& dataset, const double& euclideanDistanceThreshold )
+{
+    double successRateEuclidean; double successRateMaxIdx; double avgCost; std::vector<size_t> failedSamples;
+    bool res = testNetwork( dataset, euclideanDistanceThreshold, true, successRateEuclidean, successRateMaxIdx, avgCost, failedSamples );
+
+    sendTestResults2Obs( res, successRateEuclidean, successRateMaxIdx, avgCost, failedSamples );
+}
+
+void Network::sendTestResults2Obs( const bool& res, const double& successRateEuclidean, const double& successRateMaxIdx,
+                                   const double& avgCost, const std::vector<size_t>& failedSamples )
+{
     m_operationInProgress = false;
 
+    if( isCancelRequested() )
+    {
+        sendProg2Obs( NetworkOperationCallback::OpTestNetwork, NetworkOperationCallback::OpResultCancelled, 1.0 );
+        return;
+    }
+
     if( m_oberserver != NULL )
     {
         if( res )
@@ -385,7 +785,7 @@ void Network::doTestAsync( const std::vector<Eigen::MatrixXd>& samples, const st
     }
 }
 
-bool Network::testNetwork(  const std::vector<Eigen::MatrixXd>& samples, const std::vector<Eigen::MatrixXd>& lables,
+bool Network::testNetwork(  const std::vector<NNMatrix>& samples, const std::vector<NNMatrix>& lables,
                             const double& euclideanDistanceThreshold, bool doCallback, double& successRateEuclideanDistance,
                             double& successRateIdenticalMax, double& avgCost, std::vector<size_t>& failedSamplesIdx )
 {
@@ -395,45 +795,166 @@ bool Network::testNetwork(  const std::vector<Eigen::MatrixXd>& samples, const s
         return false;
     }
 
+    for( size_t t = 0; t < samples.size(); t++ )
+    {
+        if( samples[t].rows() != long(m_NetworkStructure.front()) || samples[t].cols() != 1 ||
+                lables[t].rows() != long(m_NetworkStructure.back()) || lables[t].cols() != 1 )
+        {
+            cout << "Error: Sample or lable " << t << " does not fit the network" << endl;
+            return false;
+        }
+    }
+
+    return doTestNetwork( samples.size(),
+                          [&samples, &lables]( const size_t& begin, const unsigned int& count, NNMatrix& buffer_in, NNMatrix& buffer_out,
+                                               const NNScalar*& batch_in, const NNScalar*& batch_out )
+                          {
+                              buffer_in.resize( samples[0].rows(), count );
+                              buffer_out.resize( lables[0].rows(), count );
+                              for( unsigned int b = 0; b < count; b++ )
+                              {
+                                  buffer_in.col(b) = samples[ begin + b ];
+                                  buffer_out.col(b) = lables[ begin + b ];
+                              }
+                              batch_in = buffer_in.data();
+                              batch_out = buffer_out.data();
+                          },
+                          euclideanDistanceThreshold, doCallback, successRateEuclideanDistance, successRateIdenticalMax, avgCost, failedSamplesIdx );
+}
+
+bool Network::testNetwork( const Dataset& dataset, const double& euclideanDistanceThreshold, bool doCallback, double& successRateEuclideanDistance,
+                           double& successRateIdenticalMax, double& avgCost, std::vector<size_t>& failedSamplesIdx )
+{
+    if( dataset.getInputSize() != long(m_NetworkStructure.front()) || dataset.getOutputSize() != long(m_NetworkStructure.back()) )
+    {
+        cout << "Error: Dataset does not fit the network" << endl;
+        return false;
+    }
+
+    return doTestNetwork( dataset.getNumberOfSamples(),
+                          [&dataset]( const size_t& begin, const unsigned int& count, NNMatrix&, NNMatrix&,
+                                      const NNScalar*& batch_in, const NNScalar*& batch_out )
+                          {
+                              // the samples are contiguous columns -> no copy
+                              batch_in = dataset.getInputs( begin, count ).data();
+                              batch_out = dataset.getOutputs( begin, count ).data();
+                          },
+                          euclideanDistanceThreshold, doCallback, successRateEuclideanDistance, successRateIdenticalMax, avgCost, failedSamplesIdx );
+}
+
+bool Network::doTestNetwork( const size_t& nbrOfTestSamples, const SampleRange& range,
+                             const double& euclideanDistanceThreshold, bool doCallback, double& successRateEuclideanDistance,
+                             double& successRateIdenticalMax, double& avgCost, std::vector<size_t>& failedSamplesIdx )
+{
     failedSamplesIdx.clear();
 
-    size_t nbrOfTestSamples = samples.size();
     successRateEuclideanDistance = 0.0; successRateIdenticalMax = 0.0; avgCost = 0.0;
 
-    for( size_t t = 0; t < nbrOfTestSamples; t++ )
+    const long inputSize = m_NetworkStructure.front();
+    const long outputSize = m_NetworkStructure.back();
+    const unsigned int outputLayerIdx = getNumberOfLayer() - 1;
+
+    const unsigned int nbrOfWorkers = m_workerPool ? m_workerPool->getNbrOfWorkers() : 1;
+    prepareWorkerWorkspaces( nbrOfWorkers );
+    m_workerBatchIn.resize( nbrOfWorkers );
+    m_workerBatchOut.resize( nbrOfWorkers );
+    m_workerResults.assign( nbrOfWorkers, 1 );
+
+    // per worker accumulators, merged at the end
+    struct TestAccumulator
     {
-        if( !feedForward(samples.at(t)) )
-            return false;
+        double nbrOfEuclideanSuccess = 0.0;
+        double nbrOfIdenticalMax = 0.0;
+        double costSum = 0.0;
+        std::vector<size_t> failedSamplesIdx;
+    };
+    std::vector<TestAccumulator> accumulators( nbrOfWorkers );
+
+    const size_t nbrOfBatches = ( nbrOfTestSamples + TestBatchSize - 1 ) / TestBatchSize;
+    std::atomic<size_t> nextBatch( 0 );
+    std::atomic<size_t> nbrOfTestedSamples( 0 );
+
+    std::function<void(const unsigned int&)> job = [&]( const unsigned int& w )
+    {
+        NetworkWorkspace* ws = w == 0 ? nullptr : &m_workerWorkspaces[w-1];
+        TestAccumulator& acc = accumulators[w];
+
+        for(;;)
+        {
+            const size_t batch = nextBatch.fetch_add( 1, std::memory_order_relaxed );
+            if( batch >= nbrOfBatches || isCancelRequested() )
+                break;
+
+            const size_t begin = batch * TestBatchSize;
+            const unsigned int count = unsigned( std::min( TestBatchSize, nbrOfTestSamples - begin ) );
+
+            const NNScalar* batchIn; const NNScalar* batchOut;
+            range( begin, count, m_workerBatchIn[w], m_workerBatchOut[w], batchIn, batchOut );
+            const Eigen::Map<const NNMatrix> x( batchIn, inputSize, count );
+            const Eigen::Map<const NNMatrix> y( batchOut, outputSize, count );
 
-        Eigen::MatrixXd outputSignal = getOutputActivation();
-        Eigen::MatrixXd expectedSignal = lables.at(t);
+            if( !doFeedForward( x, ws ) )
+            {
+                m_workerResults[w] = 0;
+                break;
+            }
+
+            LayerWorkspace& outputWs = getLayerWorkspace( outputLayerIdx, ws );
+            if( !m_Layers.back()->computeBackpropagationOutputLayerError( y, outputWs ) )
+            {
+                m_workerResults[w] = 0;
+                break;
+            }
 
-        getOutputLayer()->computeBackpropagationOutputLayerError( expectedSignal );
-        avgCost += getOutputLayer()->getCost();
+            // the cost is averaged over the batch
+            acc.costSum += outputWs.getCost() * double(count);
 
-        // Test Euclidean distance
-        double euclideanDistance = (outputSignal-expectedSignal).norm();
-        bool euclideanRequirement = euclideanDistance < euclideanDistanceThreshold;
-        if( euclideanRequirement )
-            successRateEuclideanDistance = successRateEuclideanDistance + 1.0;
+            const Eigen::Map<const NNMatrix> a = outputWs.getOutputActivation();
+            for( unsigned int n = 0; n < count; n++ )
+            {
+                // Test Euclidean distance
+                if( ( a.col(n) - y.col(n) ).norm() < euclideanDistanceThreshold )
+                    acc.nbrOfEuclideanSuccess += 1.0;
+
+                // Test max elements identical -> overall failed if classification failed
+                Eigen::Index outMax, expectedMax;
+                a.col(n).maxCoeff( &outMax );
+                y.col(n).maxCoeff( &expectedMax );
+                if( outMax == expectedMax )
+                    acc.nbrOfIdenticalMax += 1.0;
+                else
+                    acc.failedSamplesIdx.push_back( begin + n );
+            }
 
-        // Test max elements identical
-        unsigned long expected_m, expected_n, out_m, out_n; double maxElem;
-        Helpers::maxElement(expectedSignal, expected_m, expected_n, maxElem);
-        Helpers::maxElement(outputSignal, out_m, out_n, maxElem);
-        bool maxIdenticalRequirement = out_m == expected_m;
-        if( maxIdenticalRequirement ) // since vector, both n are anyway 0
-            successRateIdenticalMax = successRateIdenticalMax + 1.0;
+            const size_t nbrOfTested = nbrOfTestedSamples.fetch_add( count ) + count;
+            if( doCallback && w == 0 )
+                sendProg2Obs( NetworkOperationCallback::OpTestNetwork, NetworkOperationCallback::OpInProgress, double(nbrOfTested)/double(nbrOfTestSamples) );
+        }
+    };
 
-        // overall failed -> if classification failed
-        if( !maxIdenticalRequirement )
-            failedSamplesIdx.push_back( t );
+    if( m_workerPool )
+        m_workerPool->run( job );
+    else
+        job( 0 );
 
-        if(doCallback)
-            if( t % 10 == 0 ) // send progress only for every 10th sample
-                sendProg2Obs( NetworkOperationCallback::OpTestNetwork, NetworkOperationCallback::OpInProgress, double(t)/double(nbrOfTestSamples) );
+    if( isCancelRequested() )
+        return false;
+
+    for( unsigned int w = 0; w < nbrOfWorkers; w++ )
+    {
+        if( !m_workerResults[w] )
+            return false;
+
+        const TestAccumulator& acc = accumulators[w];
+        successRateEuclideanDistance += acc.nbrOfEuclideanSuccess;
+        successRateIdenticalMax += acc.nbrOfIdenticalMax;
+        avgCost += acc.costSum;
+        failedSamplesIdx.insert( failedSamplesIdx.end(), acc.failedSamplesIdx.begin(), acc.failedSamplesIdx.end() );
     }
 
+    // the workers claimed the batches in arbitrary order
+    std::sort( failedSamplesIdx.begin(), failedSamplesIdx.end() );
+
     avgCost = avgCost / double(nbrOfTestSamples);
 
     // normalise success rates
@@ -558,6 +1079,47 @@ bool Network::isSoftmaxOutputEnabled() const
     return getOutputLayer()->getLayerType() == Layer::Softmax;
 }
 
+void Network::setNumberOfThreads( const unsigned int& nbrOfThreads )
+{
+    unsigned int n = nbrOfThreads;
+    if( n == 0 )
+        n = std::max( std::thread::hardware_concurrency(), 1u );
+
+    if( n == m_nbrOfThreads )
+        return;
+
+    m_nbrOfThreads = n;
+
+    if( m_nbrOfThreads > 1 )
+        m_workerPool.reset( new WorkerPool( m_nbrOfThreads ) );
+    else
+        m_workerPool.reset();
+
+    m_workerWorkspaces.clear();
+}
+
+void Network::setBatchTransform( const BatchTransform& transform )
+{
+    m_batchTransform = transform;
+}
+
+void Network::setBatchPrefetching( const bool& enable )
+{
+    if( enable == isBatchPrefetchingEnabled() )
+        return;
+
+    if( enable )
+        m_batchPrefetcher.reset( new BatchPrefetcher() );
+    else
+        m_batchPrefetcher.reset();
+}
+
+void Network::setPerSampleDerivatives( const bool& enable )
+{
+    for( std::shared_ptr<Layer>& l : m_Layers )
+        l->setPerSampleDerivatives( enable );
+}
+
 std::vector<size_t> Network::randomIndices(size_t numberOfElements) const
 {
     std::vector<size_t> rInd(numberOfElements);
@@ -0,0 +1,117 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "networkstack.h"
+#include "network.h"
+#include "neuron.h"
+
+#include <iostream>
+
+NetworkStack::NetworkStack()
+{
+}
+
+NetworkStack::~NetworkStack()
+{
+}
+
+bool NetworkStack::isSameStructure( const Network& a, const Network& b )
+{
+    return Population::isSameStructure( a, b );
+}
+
+bool NetworkStack::setNetworks( const std::vector<const Network*>& networks )
+{
+    // the population is empty if the networks differ
+    const bool ok = m_population.setNetworks( networks );
+    reserveActivations();
+    return ok;
+}
+
+void NetworkStack::setPopulation( const Population& population, const std::vector<size_t>& idx )
+{
+    m_population.gather( population, idx );
+    reserveActivations();
+}
+
+void NetworkStack::reserveActivations()
+{
+    const long nbrOfNetworks = long( m_population.getNumberOfIndividuals() );
+
+    m_activations.resize( m_population.getNumberOfLayers() );
+    for( size_t l = 1; l <= m_population.getNumberOfLayers(); l++ )
+        m_activations[l - 1].resize( nbrOfNetworks, m_population.getNbrOfNeurons( l ) );
+
+    if( m_population.getNumberOfLayers() > 0 )
+    {
+        m_input.resize( nbrOfNetworks, getNetworkStructure().front() );
+        m_output.resize( getNetworkStructure().back(), nbrOfNetworks );
+    }
+}
+
+bool NetworkStack::feedForward( const Eigen::Ref<const NNMatrix>& x_in )
+{
+    const std::vector<unsigned int>& structure = getNetworkStructure();
+    if( m_activations.empty() || x_in.rows() != long(structure.front()) || x_in.cols() != long(getNumberOfNetworks()) )
+    {
+        std::cout << "Error: Input does not fit the network stack" << std::endl;
+        return false;
+    }
+
+    // networks along the rows -> every operation runs contiguously over all networks
+    m_input = x_in.transpose();
+
+    const NNMatrix* in = &m_input;
+    for( size_t l = 1; l <= m_population.getNumberOfLayers(); l++ )
+    {
+        const NNMatrix& weights = m_population.weights( l );
+        const NNMatrix& biases = m_population.biases( l );
+        const long nbrOfInputs = m_population.getNbrOfInputs( l );
+        NNMatrix& activation = m_activations[l - 1];
+
+        for( long j = 0; j < m_population.getNbrOfNeurons( l ); j++ )
+        {
+            auto z = activation.col(j);
+            z = biases.col(j);
+            for( long k = 0; k < nbrOfInputs; k++ )
+                z += weights.col( j * nbrOfInputs + k ).cwiseProduct( in->col(k) );
+        }
+
+        if( m_population.getLayerType( l ) == Layer::Sigmoid )
+        {
+            Neuron::sigmoid( activation, activation );
+        }
+        else
+        {
+            // softmax over the neurons of each network
+            activation = activation.array().exp();
+            activation.array().colwise() /= activation.rowwise().sum().array();
+        }
+
+        in = &activation;
+    }
+
+    m_output = in->transpose();
+
+    return true;
+}
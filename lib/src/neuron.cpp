@@ -34,12 +34,18 @@ double Neuron::d_sigmoid( const double& z )
     return sigmoid(z) * ( 1.0 - sigmoid(z) );
 }
 
-const Eigen::MatrixXd Neuron::d_sigmoid( const Eigen::MatrixXd& z )
+void Neuron::sigmoid( const Eigen::Ref<const NNMatrix>& z, Eigen::Ref<NNMatrix> a )
 {
-    Eigen::MatrixXd res = Eigen::MatrixXd( z.rows(), z.cols() );
-    for( unsigned int m = 0; m < z.rows(); m++ )
-        for( unsigned int n = 0; n < z.cols(); n++ )
-            res(m,n) = Neuron::d_sigmoid( z(m,n) );
+    // array expression -> Eigen evaluates exp() on SIMD packets
+    a = ( 1.0 + (-z.array()).exp() ).inverse().matrix();
+}
+
+const NNMatrix Neuron::d_sigmoid( const NNMatrix& z )
+{
+    // sigmoid'(z) = sigmoid(z) * (1 - sigmoid(z)) -> exp() only once per element
+    NNMatrix res( z.rows(), z.cols() );
+    sigmoid( z, res );
+    res.array() *= 1.0 - res.array();
 
     return res;
 }
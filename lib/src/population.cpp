@@ -0,0 +1,217 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "population.h"
+#include "network.h"
+
+#include <iostream>
+
+Population::Population() : m_nbrOfIndividuals( 0 )
+{
+}
+
+Population::~Population()
+{
+}
+
+bool Population::isSameStructure( const Network& a, const Network& b )
+{
+    if( a.getNetworkStructure() != b.getNetworkStructure() )
+        return false;
+
+    for( unsigned int l = 1; l < a.getNumberOfLayer(); l++ )
+        if( a.getLayer(l)->getLayerType() != b.getLayer(l)->getLayerType() )
+            return false;
+
+    return true;
+}
+
+void Population::setStructure( const Network& prototype )
+{
+    m_layers.clear();
+    m_structure = prototype.getNetworkStructure();
+    m_nbrOfIndividuals = 0;
+
+    for( unsigned int l = 1; l < prototype.getNumberOfLayer(); l++ )
+    {
+        LayerGenome lg;
+        lg.type = prototype.getLayer(l)->getLayerType();
+        lg.nbrOfNeurons = prototype.getLayer(l)->getNbrOfNeurons();
+        lg.nbrOfInputs = prototype.getLayer(l)->getNbrOfNeuronInputs();
+        lg.weights.resize( 0, lg.nbrOfNeurons * lg.nbrOfInputs );
+        lg.biases.resize( 0, lg.nbrOfNeurons );
+        m_layers.push_back( lg );
+    }
+}
+
+bool Population::setNetworks( const std::vector<const Network*>& networks )
+{
+    m_layers.clear();
+    m_structure.clear();
+    m_nbrOfIndividuals = 0;
+
+    if( networks.empty() )
+        return true;
+
+    for( const Network* n : networks )
+    {
+        if( !isSameStructure( *networks.front(), *n ) )
+        {
+            std::cout << "Error: Networks of population differ in structure" << std::endl;
+            return false;
+        }
+    }
+
+    setStructure( *networks.front() );
+    resize( networks.size() );
+    for( size_t i = 0; i < networks.size(); i++ )
+        setGenome( i, *networks[i] );
+
+    return true;
+}
+
+void Population::resize( const size_t& nbrOfIndividuals )
+{
+    for( LayerGenome& lg : m_layers )
+    {
+        lg.weights.conservativeResize( long( nbrOfIndividuals ), Eigen::NoChange );
+        lg.biases.conservativeResize( long( nbrOfIndividuals ), Eigen::NoChange );
+    }
+
+    m_nbrOfIndividuals = nbrOfIndividuals;
+}
+
+bool Population::hasNetworkStructure( const Network& network ) const
+{
+    return !m_structure.empty() && network.getNetworkStructure() == m_structure;
+}
+
+bool Population::setGenome( const size_t& idx, const Network& network )
+{
+    if( idx >= m_nbrOfIndividuals || !hasNetworkStructure( network ) )
+    {
+        std::cout << "Error: Network does not fit the population" << std::endl;
+        return false;
+    }
+
+    for( size_t l = 1; l <= m_layers.size(); l++ )
+    {
+        LayerGenome& lg = layer(l);
+        const std::shared_ptr<const Layer> nl = network.getLayer( (unsigned int) l );
+        const NNMatrix& w = nl->getWeightMatrix();
+
+        for( long j = 0; j < lg.nbrOfNeurons; j++ )
+            for( long k = 0; k < lg.nbrOfInputs; k++ )
+                lg.weights( long(idx), j * lg.nbrOfInputs + k ) = w( j, k );
+
+        lg.biases.row( long(idx) ) = nl->getBiasVector().transpose();
+    }
+
+    return true;
+}
+
+bool Population::getGenome( const size_t& idx, Network& network ) const
+{
+    if( idx >= m_nbrOfIndividuals || !hasNetworkStructure( network ) )
+    {
+        std::cout << "Error: Network does not fit the population" << std::endl;
+        return false;
+    }
+
+    for( size_t l = 1; l <= m_layers.size(); l++ )
+    {
+        const LayerGenome& lg = layer(l);
+        NNMatrix w( lg.nbrOfNeurons, lg.nbrOfInputs );
+
+        for( long j = 0; j < lg.nbrOfNeurons; j++ )
+            for( long k = 0; k < lg.nbrOfInputs; k++ )
+                w( j, k ) = lg.weights( long(idx), j * lg.nbrOfInputs + k );
+
+        std::shared_ptr<Layer> nl = network.getLayer( (unsigned int) l );
+        nl->setWeights( w );
+        nl->setBiases( NNMatrix( lg.biases.row( long(idx) ).transpose() ) );
+    }
+
+    return true;
+}
+
+std::shared_ptr<Network> Population::createNetwork( const size_t& idx ) const
+{
+    if( idx >= m_nbrOfIndividuals )
+    {
+        std::cout << "Error: Invalid individual" << std::endl;
+        return std::shared_ptr<Network>( nullptr );
+    }
+
+    std::shared_ptr<Network> network( new Network( m_structure ) );
+    for( size_t l = 1; l <= m_layers.size(); l++ )
+        network->getLayer( (unsigned int) l )->setLayerType( layer(l).type );
+
+    getGenome( idx, *network );
+
+    return network;
+}
+
+void Population::gather( const Population& src, const std::vector<size_t>& srcIdx )
+{
+    m_structure = src.m_structure;
+    m_layers.resize( src.m_layers.size() );
+    m_nbrOfIndividuals = srcIdx.size();
+
+    for( size_t l = 0; l < m_layers.size(); l++ )
+    {
+        const LayerGenome& s = src.m_layers[l];
+        LayerGenome& d = m_layers[l];
+        d.type = s.type;
+        d.nbrOfNeurons = s.nbrOfNeurons;
+        d.nbrOfInputs = s.nbrOfInputs;
+        d.weights.resize( long( srcIdx.size() ), s.weights.cols() );
+        d.biases.resize( long( srcIdx.size() ), s.biases.cols() );
+
+        // column by column -> contiguous writes
+        for( long c = 0; c < s.weights.cols(); c++ )
+            for( size_t i = 0; i < srcIdx.size(); i++ )
+                d.weights( long(i), c ) = s.weights( long( srcIdx[i] ), c );
+
+        for( long c = 0; c < s.biases.cols(); c++ )
+            for( size_t i = 0; i < srcIdx.size(); i++ )
+                d.biases( long(i), c ) = s.biases( long( srcIdx[i] ), c );
+    }
+}
+
+bool Population::copyGenome( const Population& src, const size_t& srcIdx, const size_t& dstIdx )
+{
+    if( src.m_structure != m_structure || srcIdx >= src.m_nbrOfIndividuals || dstIdx >= m_nbrOfIndividuals )
+    {
+        std::cout << "Error: Genome does not fit the population" << std::endl;
+        return false;
+    }
+
+    for( size_t l = 0; l < m_layers.size(); l++ )
+    {
+        m_layers[l].weights.row( long(dstIdx) ) = src.m_layers[l].weights.row( long(srcIdx) );
+        m_layers[l].biases.row( long(dstIdx) ) = src.m_layers[l].biases.row( long(srcIdx) );
+    }
+
+    return true;
+}
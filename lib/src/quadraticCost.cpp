@@ -34,14 +34,15 @@ QuadraticCost::~QuadraticCost()
 
 }
 
-Eigen::MatrixXd QuadraticCost::delta(const Eigen::MatrixXd &z_weightdInput, const Eigen::MatrixXd &a_activation,
-                                     const Eigen::MatrixXd &y_expected) const
+void QuadraticCost::delta( const Eigen::Ref<const NNMatrix>& /*z_weightdInput*/, const Eigen::Ref<const NNMatrix>& a_activation,
+                          const Eigen::Ref<const NNMatrix>& y_expected, Eigen::Ref<NNMatrix> delta ) const
 {
-    return ((a_activation - y_expected).array() * Neuron::d_sigmoid( z_weightdInput ).array()).matrix();
+    // sigmoid'(z) = a * (1 - a) -> no need to recompute the sigmoid of z
+    delta = ((a_activation - y_expected).array() * a_activation.array() * (1.0 - a_activation.array())).matrix();
 }
 
-double QuadraticCost::cost(const Eigen::MatrixXd &a_activation, const Eigen::MatrixXd &y_expected) const
+double QuadraticCost::cost( const Eigen::Ref<const NNMatrix>& a_activation, const Eigen::Ref<const NNMatrix>& y_expected ) const
 {
-    Eigen::MatrixXd sqn = (a_activation - y_expected).colwise().squaredNorm();
-    return 0.5 * sqn.sum() / double(sqn.cols());;
+    // sum of the squared norms of each sample, averaged over all samples
+    return 0.5 * (a_activation - y_expected).squaredNorm() / double(a_activation.cols());
 }
@@ -27,6 +27,9 @@
 #include "simulation.h"
 #include "genetic.h"
 
+#include <cmath>
+#include <algorithm>
+
 
 Simulation::Simulation()
 {
@@ -44,11 +47,41 @@ void Simulation::doStep()
     if( isAlive() )
     {
         update();
+        m_simulatedTime += m_fixedTimeStep;
         setLastUpdateTime(now());
     }
 }
 
 void Simulation::update()
+{
+    // Do override, or implement sense() and act()
+    if( supportsSenseAct() )
+    {
+        m_networkInput.resize( m_network->getNetworkStructure().front(), 1 );
+        sense( m_networkInput );
+        m_network->feedForward( m_networkInput, m_networkWorkspace );
+        actuate( m_networkWorkspace.getOutputActivation() );
+    }
+}
+
+bool Simulation::supportsSenseAct() const
+{
+    return false;
+}
+
+void Simulation::sense( Eigen::Ref<NNMatrix> /*input*/ )
+{
+    // Do override
+}
+
+void Simulation::act( const Eigen::Ref<const NNMatrix>& output )
+{
+    actuate( output );
+    m_simulatedTime += m_fixedTimeStep;
+    setLastUpdateTime(now());
+}
+
+void Simulation::actuate( const Eigen::Ref<const NNMatrix>& /*output*/ )
 {
     // Do override
 }
@@ -60,6 +93,9 @@ double Simulation::getFitness()
 
 std::chrono::milliseconds Simulation::now() const
 {
+    if( m_fixedTimeStep > 0.0 )
+        return m_creation + std::chrono::milliseconds( std::llround( m_simulatedTime * 1000.0 ) );
+
     return std::chrono::duration_cast< std::chrono::milliseconds >(
             std::chrono::system_clock::now().time_since_epoch());
 }
@@ -76,6 +112,9 @@ void Simulation::setLastUpdateTime(const std::chrono::milliseconds &lastUpdate)
 
 double Simulation::getTimeSinceLastUpdate() const
 {
+    if( m_fixedTimeStep > 0.0 )
+        return m_fixedTimeStep;
+
     return (now() - m_lastUpdate).count() / 1000.0;
 }
 
@@ -94,8 +133,24 @@ bool Simulation::isAlive() const
     return m_alive;
 }
 
+void Simulation::setFixedTimeStep( const double& dt )
+{
+    // continue from the time already passed
+    m_simulatedTime = getAge();
+    m_fixedTimeStep = std::max( dt, 0.0 );
+    setLastUpdateTime(now());
+}
+
+double Simulation::getFixedTimeStep() const
+{
+    return m_fixedTimeStep;
+}
+
 double Simulation::getAge() const
 {
+    if( m_fixedTimeStep > 0.0 )
+        return m_simulatedTime;
+
     return ((double)(m_lastUpdate - m_creation).count()) / 1000.0;
 }
 
@@ -128,6 +183,18 @@ SimulationPtr SimulationFactory::createCrossover( SimulationPtr a, SimulationPtr
     return crs;
 }
 
+SimulationPtr SimulationFactory::createFromGenome( Population& population, const size_t& idx )
+{
+    SimulationPtr crs = createRandomSimulation();
+    crs->setNetwork(population.createNetwork(idx));
+    return crs;
+}
+
+bool SimulationFactory::isThreadSafe() const
+{
+    return false;
+}
+
 SimulationPtr SimulationFactory::copy( SimulationPtr a )
 {
     SimulationPtr crs = createRandomSimulation();
@@ -0,0 +1,95 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "workerpool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool( const unsigned int& nbrOfWorkers ) :
+    m_nbrOfWorkers( std::max( nbrOfWorkers, 1u ) ),
+    m_job( nullptr ),
+    m_jobGeneration( 0 ),
+    m_nbrOfPendingWorkers( 0 ),
+    m_stop( false )
+{
+    // worker 0 is the calling thread
+    for( unsigned int w = 1; w < m_nbrOfWorkers; w++ )
+        m_threads.push_back( std::thread( &WorkerPool::workerLoop, this, w ) );
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for( std::thread& t : m_threads )
+        t.join();
+}
+
+void WorkerPool::run( const std::function<void(const unsigned int&)>& job )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_job = &job;
+        m_nbrOfPendingWorkers = m_nbrOfWorkers - 1;
+        m_jobGeneration++;
+    }
+    m_jobAvailable.notify_all();
+
+    job( 0 );
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_jobDone.wait( lock, [this]{ return m_nbrOfPendingWorkers == 0; } );
+    m_job = nullptr;
+}
+
+void WorkerPool::workerLoop( const unsigned int workerIdx )
+{
+    unsigned long lastGeneration = 0;
+
+    for(;;)
+    {
+        const std::function<void(const unsigned int&)>* job;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_jobAvailable.wait( lock, [this, lastGeneration]{ return m_stop || m_jobGeneration != lastGeneration; } );
+
+            if( m_stop )
+                return;
+
+            lastGeneration = m_jobGeneration;
+            job = m_job;
+        }
+
+        (*job)( workerIdx );
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_nbrOfPendingWorkers--;
+        }
+        m_jobDone.notify_one();
+    }
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+
+#include "workspace.h"
+
+#include <algorithm>
+#include <cassert>
+
+LayerWorkspace::LayerWorkspace() :
+    m_batchSize( 0 ),
+    m_outputLayerCost( 0.0 )
+{
+}
+
+LayerWorkspace::~LayerWorkspace()
+{
+}
+
+void LayerWorkspace::reserve( const unsigned int& nbrOfNeurons, const unsigned int& nbrOfInputs, const long& maxBatchSize )
+{
+    const bool dimensionChanged = m_activation_out.rows() != nbrOfNeurons || m_activation_in.rows() != nbrOfInputs;
+
+    if( dimensionChanged || m_activation_out.cols() < maxBatchSize )
+    {
+        const long cols = dimensionChanged ? maxBatchSize : std::max( maxBatchSize, long(m_activation_out.cols()) );
+
+        m_activation_in.resize( nbrOfInputs, cols );
+        m_activation_out.resize( nbrOfNeurons, cols );
+        m_z_weighted_input.resize( nbrOfNeurons, cols );
+        m_backpropagationError.resize( nbrOfNeurons, cols );
+    }
+
+    if( dimensionChanged )
+    {
+        m_bias_partialDerivativesSum = NNMatrix::Zero( nbrOfNeurons, 1 );
+        m_weight_partialDerivativesSum = NNMatrix::Zero( nbrOfNeurons, nbrOfInputs );
+        m_batchSize = 0;
+    }
+}
+
+void LayerWorkspace::setBatchSize( const long& batchSize )
+{
+    assert( batchSize <= getMaxBatchSize() );
+    m_batchSize = batchSize;
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include "xoshiro.h"
+
+#include <cmath>
+
+Xoshiro256::Xoshiro256( const uint64_t& seed )
+{
+    this->seed( seed );
+}
+
+void Xoshiro256::seed( const uint64_t& seed )
+{
+    // splitmix64, avoids the all zero state
+    uint64_t x = seed;
+    for( uint64_t& s : m_s )
+    {
+        uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+        z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+        s = z ^ ( z >> 31 );
+    }
+}
+
+void Xoshiro256::jump()
+{
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for( uint64_t j : JUMP )
+    {
+        for( int b = 0; b < 64; b++ )
+        {
+            if( j & ( uint64_t(1) << b ) )
+            {
+                s[0] ^= m_s[0];
+                s[1] ^= m_s[1];
+                s[2] ^= m_s[2];
+                s[3] ^= m_s[3];
+            }
+            (*this)();
+        }
+    }
+
+    m_s[0] = s[0];
+    m_s[1] = s[1];
+    m_s[2] = s[2];
+    m_s[3] = s[3];
+}
+
+double Xoshiro256::normal()
+{
+    // 1 - uniform() is in (0, 1] -> log is finite
+    const double u1 = 1.0 - uniform();
+    const double u2 = uniform();
+    return std::sqrt( -2.0 * std::log( u1 ) ) * std::cos( 6.283185307179586 * u2 );
+}
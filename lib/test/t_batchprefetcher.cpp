@@ -0,0 +1,108 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "batchprefetcher.h"
+
+TEST(BatchPrefetcherTest, AllBatchesInOrder)
+{
+    BatchPrefetcher prefetcher;
+
+    std::vector<size_t> loaded;
+    BatchPrefetcher::BatchLoader load = [&loaded]( const size_t& batchIdx, NNMatrix& batch_in, NNMatrix& batch_out )
+    {
+        loaded.push_back( batchIdx );
+        batch_in = NNMatrix::Constant( 3, 2, NNScalar(batchIdx) );
+        batch_out = NNMatrix::Constant( 1, 2, NNScalar(-1.0 * batchIdx) );
+    };
+
+    for( int epoch = 0; epoch < 3; epoch++ )
+    {
+        loaded.clear();
+        prefetcher.start( 10, load );
+
+        for( size_t k = 0; k < 10; k++ )
+        {
+            const NNMatrix* in; const NNMatrix* out;
+            prefetcher.next( in, out );
+            ASSERT_EQ( in->rows(), 3 );
+            ASSERT_TRUE( ( in->array() == NNScalar(k) ).all() );
+            ASSERT_TRUE( ( out->array() == NNScalar(-1.0 * k) ).all() );
+        }
+
+        prefetcher.finish();
+
+        ASSERT_EQ( loaded.size(), 10 );
+        for( size_t k = 0; k < 10; k++ )
+            ASSERT_EQ( loaded[k], k );
+    }
+}
+
+TEST(BatchPrefetcherTest, DoubleBufferReused)
+{
+    BatchPrefetcher prefetcher;
+    BatchPrefetcher::BatchLoader load = []( const size_t& batchIdx, NNMatrix& batch_in, NNMatrix& batch_out )
+    {
+        batch_in.resize( 4, 4 ); batch_in.setConstant( NNScalar(batchIdx) );
+        batch_out.resize( 1, 4 ); batch_out.setZero();
+    };
+
+    prefetcher.start( 6, load );
+    std::vector<const NNMatrix*> buffers;
+    for( size_t k = 0; k < 6; k++ )
+    {
+        const NNMatrix* in; const NNMatrix* out;
+        prefetcher.next( in, out );
+        buffers.push_back( in );
+    }
+    prefetcher.finish();
+
+    ASSERT_NE( buffers[0], buffers[1] );
+    for( size_t k = 2; k < 6; k++ )
+        ASSERT_EQ( buffers[k], buffers[k-2] );
+}
+
+TEST(BatchPrefetcherTest, FinishEarly)
+{
+    BatchPrefetcher prefetcher;
+    size_t nbrOfLoaded = 0;
+    BatchPrefetcher::BatchLoader load = [&nbrOfLoaded]( const size_t&, NNMatrix& batch_in, NNMatrix& batch_out )
+    {
+        nbrOfLoaded++;
+        batch_in.setZero( 2, 2 ); batch_out.setZero( 2, 2 );
+    };
+
+    prefetcher.start( 100, load );
+    const NNMatrix* in; const NNMatrix* out;
+    prefetcher.next( in, out );
+    prefetcher.finish();
+
+    // at most one batch ahead of the taken one
+    ASSERT_LE( nbrOfLoaded, 2 );
+
+    // restart works after cancelling
+    prefetcher.start( 1, load );
+    prefetcher.next( in, out );
+    prefetcher.finish();
+}
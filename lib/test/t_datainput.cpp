@@ -22,6 +22,10 @@
 *****************************************************************************/
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include "dataInput.h"
 
 TEST(DataInput, addClear)
@@ -212,3 +216,128 @@ TEST(DataInput, representation)
     ASSERT_FALSE(repAvailable);
     ASSERT_TRUE((vecOut - vec).isMuchSmallerThan(0.001));
 }
+
+TEST(DataInput, dataset)
+{
+    DataInput di;
+    for( int i = 0; i < 12; i++ )
+    {
+        Eigen::MatrixXd input = Eigen::MatrixXd::Random( 4, 1 );
+        di.addTrainingSample( input, i % 3 );
+        di.addTestSample( input * 2.0, i % 3 );
+    }
+    ASSERT_TRUE( di.generateFromLables() );
+
+    Dataset training = di.getTrainingDataset();
+    Dataset test = di.getTestDataset();
+    ASSERT_TRUE( training.hasLables() );
+    ASSERT_EQ( training.getNumberOfSamples(), 12 );
+    ASSERT_EQ( test.getNumberOfSamples(), 12 );
+    ASSERT_EQ( training.getInputSize(), 4 );
+    ASSERT_EQ( training.getOutputSize(), 3 );
+
+    for( int i = 0; i < 12; i++ )
+    {
+        ASSERT_TRUE( training.getInputs().col(i).isApprox( di.m_training.at(i).input ) );
+        ASSERT_TRUE( training.getOutputs().col(i).isApprox( di.m_training.at(i).output ) );
+        ASSERT_TRUE( test.getInputs().col(i).isApprox( di.m_test.at(i).input ) );
+        ASSERT_EQ( training.getLable(i), i % 3 );
+    }
+
+    // output missing -> empty
+    di.addTrainingSample( Eigen::MatrixXd::Random( 4, 1 ), 1 );
+    ASSERT_EQ( di.getTrainingDataset().getNumberOfSamples(), 0 );
+}
+
+TEST(DataInput, datasetFile)
+{
+    DataInput di;
+    for( int i = 0; i < 25; i++ )
+    {
+        di.addTrainingSample( Eigen::MatrixXd::Random( 7, 1 ), i % 4 );
+        if( i < 9 )
+            di.addTestSample( Eigen::MatrixXd::Random( 7, 1 ), i % 4 );
+    }
+    ASSERT_TRUE( di.generateFromLables() );
+
+    const std::string filePath = "datasetfile_test.eidnnds";
+    ASSERT_TRUE( di.saveDatasets( filePath ) );
+
+    Dataset training, test;
+    ASSERT_TRUE( DataInput::openDatasets( filePath, training, test ) );
+    ASSERT_EQ( training.getNumberOfSamples(), 25 );
+    ASSERT_EQ( test.getNumberOfSamples(), 9 );
+    ASSERT_EQ( training.getInputSize(), 7 );
+    ASSERT_EQ( test.getOutputSize(), 4 );
+    ASSERT_TRUE( training.hasLables() );
+
+    // mapped sections are aligned
+    ASSERT_EQ( reinterpret_cast<uintptr_t>( training.getInputs().data() ) % 64, 0 );
+    ASSERT_EQ( reinterpret_cast<uintptr_t>( test.getOutputs().data() ) % 64, 0 );
+
+    Dataset expectedTraining = di.getTrainingDataset();
+    Dataset expectedTest = di.getTestDataset();
+    ASSERT_TRUE( training.getInputs() == expectedTraining.getInputs() );
+    ASSERT_TRUE( training.getOutputs() == expectedTraining.getOutputs() );
+    ASSERT_TRUE( test.getInputs() == expectedTest.getInputs() );
+    ASSERT_TRUE( test.getOutputs() == expectedTest.getOutputs() );
+    for( size_t i = 0; i < training.getNumberOfSamples(); i++ )
+        ASSERT_EQ( training.getLable(i), expectedTraining.getLable(i) );
+
+    // the mapping outlives the file and the other dataset
+    std::remove( filePath.c_str() );
+    test = Dataset();
+    ASSERT_TRUE( training.getInputs() == expectedTraining.getInputs() );
+}
+
+TEST(DataInput, datasetFileInvalid)
+{
+    Dataset training, test;
+    ASSERT_FALSE( DataInput::openDatasets( "does_not_exist.eidnnds", training, test ) );
+
+    const std::string filePath = "datasetfile_invalid.eidnnds";
+    {
+        std::ofstream file( filePath, std::ios::binary );
+        file << "this is not a dataset file, but it is long enough to hold a header........";
+    }
+    ASSERT_FALSE( DataInput::openDatasets( filePath, training, test ) );
+
+    // truncated file
+    Dataset ds( Eigen::MatrixXd::Random( 10, 50 ), Eigen::MatrixXd::Random( 2, 50 ) );
+    ASSERT_TRUE( DataInput::saveDatasets( filePath, ds, Dataset() ) );
+    ASSERT_TRUE( DataInput::openDatasets( filePath, training, test ) );
+    ASSERT_EQ( training.getNumberOfSamples(), 50 );
+    ASSERT_EQ( test.getNumberOfSamples(), 0 );
+    ASSERT_FALSE( training.hasLables() );
+
+    // the file must not be changed while it is mapped
+    training = Dataset();
+
+    std::string content;
+    {
+        std::ifstream file( filePath, std::ios::binary );
+        content.assign( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+    }
+    {
+        std::ofstream file( filePath, std::ios::binary | std::ios::trunc );
+        file.write( content.data(), std::streamsize( content.size() / 2 ) );
+    }
+    ASSERT_FALSE( DataInput::openDatasets( filePath, training, test ) );
+
+    // section sizes in the header overflow -> would wrap below the file size
+    {
+        std::string corrupt = content;
+        const uint64_t nbrOfSamples = uint64_t(1) << 62;
+        const uint64_t inputSize = 4;
+        const uint64_t outputSize = 0;
+        std::memcpy( &corrupt[16], &nbrOfSamples, sizeof(uint64_t) );
+        std::memcpy( &corrupt[24], &inputSize, sizeof(uint64_t) );
+        std::memcpy( &corrupt[32], &outputSize, sizeof(uint64_t) );
+
+        std::ofstream file( filePath, std::ios::binary | std::ios::trunc );
+        file.write( corrupt.data(), std::streamsize( corrupt.size() ) );
+    }
+    ASSERT_FALSE( DataInput::openDatasets( filePath, training, test ) );
+
+    std::remove( filePath.c_str() );
+}
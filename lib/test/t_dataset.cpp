@@ -0,0 +1,95 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include "dataset.h"
+
+TEST(DatasetTest, ConstructFromSamples)
+{
+    std::vector<Eigen::MatrixXd> inputs; std::vector<Eigen::MatrixXd> outputs;
+    for( int k = 0; k < 10; k++ )
+    {
+        inputs.push_back( Eigen::MatrixXd::Random( 6, 1 ) );
+        outputs.push_back( Eigen::MatrixXd::Constant( 3, 1, double(k) ) );
+    }
+
+    Dataset ds( inputs, outputs );
+    ASSERT_EQ( ds.getNumberOfSamples(), 10 );
+    ASSERT_EQ( ds.getInputSize(), 6 );
+    ASSERT_EQ( ds.getOutputSize(), 3 );
+
+    for( int k = 0; k < 10; k++ )
+    {
+        ASSERT_TRUE( ds.getInputs().col(k).isApprox( inputs[k] ) );
+        ASSERT_TRUE( ds.getOutputs().col(k).isApprox( outputs[k] ) );
+    }
+
+    // mismatching number of samples or sample sizes -> empty dataset
+    outputs.pop_back();
+    ASSERT_EQ( Dataset( inputs, outputs ).getNumberOfSamples(), 0 );
+    outputs.push_back( Eigen::MatrixXd::Zero( 4, 1 ) );
+    ASSERT_EQ( Dataset( inputs, outputs ).getNumberOfSamples(), 0 );
+    ASSERT_EQ( Dataset( Eigen::MatrixXd::Zero( 6, 5 ), Eigen::MatrixXd::Zero( 3, 4 ) ).getNumberOfSamples(), 0 );
+}
+
+TEST(DatasetTest, ZeroCopyRangeAndSharedStorage)
+{
+    Eigen::MatrixXd in = Eigen::MatrixXd::Random( 5, 20 );
+    Eigen::MatrixXd out = Eigen::MatrixXd::Random( 2, 20 );
+    Dataset ds( in, out );
+
+    Eigen::Map<const Eigen::MatrixXd> inRange = ds.getInputs( 7, 4 );
+    ASSERT_EQ( inRange.cols(), 4 );
+    ASSERT_EQ( inRange.data(), ds.getInputs().data() + 7*5 );
+    ASSERT_TRUE( inRange.isApprox( in.middleCols( 7, 4 ) ) );
+    ASSERT_TRUE( ds.getOutputs( 19, 1 ).isApprox( out.col( 19 ) ) );
+
+    // copies share the storage
+    Dataset copy = ds;
+    ASSERT_EQ( copy.getInputs().data(), ds.getInputs().data() );
+    ASSERT_EQ( copy.getOutputs().data(), ds.getOutputs().data() );
+}
+
+TEST(DatasetTest, Gather)
+{
+    Eigen::MatrixXd in = Eigen::MatrixXd::Random( 5, 20 );
+    Eigen::MatrixXd out = Eigen::MatrixXd::Random( 2, 20 );
+    Dataset ds( in, out );
+
+    std::vector<size_t> idx = { 19, 0, 7, 7, 3 };
+    Eigen::MatrixXd batch_in, batch_out;
+    ds.gather( idx.data(), idx.size(), batch_in, batch_out );
+
+    ASSERT_EQ( batch_in.cols(), 5 );
+    ASSERT_EQ( batch_out.cols(), 5 );
+    for( size_t b = 0; b < idx.size(); b++ )
+    {
+        ASSERT_TRUE( batch_in.col( long(b) ).isApprox( in.col( long(idx[b]) ) ) );
+        ASSERT_TRUE( batch_out.col( long(b) ).isApprox( out.col( long(idx[b]) ) ) );
+    }
+
+    // the batch is resized to the number of gathered samples
+    ds.gather( idx.data() + 1, 2, batch_in, batch_out );
+    ASSERT_EQ( batch_in.cols(), 2 );
+    ASSERT_TRUE( batch_in.col(1).isApprox( in.col(7) ) );
+}
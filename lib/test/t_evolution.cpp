@@ -27,6 +27,8 @@
 #include "genetic.h"
 #include "helpers.h"
 #include <memory>
+#include <atomic>
+#include <algorithm>
 
 
 class OneStepSimulation: public Simulation
@@ -147,6 +149,105 @@ TEST(Evolution, MultiEpochs)
     delete e;
 }
 
+TEST(Evolution, BreedOnPopulation)
+{
+    std::shared_ptr<OneStepSimFactory> f(new OneStepSimFactory());
+
+    Evolution* e = new Evolution(20,30,f);
+    e->doEpoch();
+
+    std::vector<SimulationPtr> ord = e->getSimulationsOrderedByFitness();
+    NetworkPtr a = ord[0]->getNetwork();
+    NetworkPtr b = ord[1]->getNetwork();
+
+    e->breed();
+    e->doEpoch();
+
+    std::vector<SimulationPtr> next = e->getSimulationsOrderedByFitness();
+    ASSERT_EQ( next.size(), 32 );
+
+    // offspring created from the population store, each parameter from one of the parents
+    for( SimulationPtr s : next )
+    {
+        NetworkPtr c = s->getNetwork();
+        ASSERT_TRUE( c.get() != nullptr );
+        for( unsigned int l = 1; l < c->getNumberOfLayer(); l++ )
+        {
+            const NNMatrix& cw = c->getLayer(l)->getWeightMatrix();
+            const NNMatrix& aw = a->getLayer(l)->getWeightMatrix();
+            const NNMatrix& bw = b->getLayer(l)->getWeightMatrix();
+            ASSERT_EQ( ( (cw.array() == aw.array()) || (cw.array() == bw.array()) ).count(), cw.size() );
+
+            const NNMatrix& cb = c->getLayer(l)->getBiasVector();
+            const NNMatrix& ab = a->getLayer(l)->getBiasVector();
+            const NNMatrix& bb = b->getLayer(l)->getBiasVector();
+            ASSERT_EQ( ( (cb.array() == ab.array()) || (cb.array() == bb.array()) ).count(), cb.size() );
+        }
+    }
+
+    delete e;
+}
+
+class DeterministicSimFactory: public OneStepSimFactory
+{
+public:
+    DeterministicSimFactory( bool threadSafe ) : m_threadSafe( threadSafe ) {}
+
+    std::shared_ptr<Simulation> createRandomSimulation() override
+    {
+        std::shared_ptr<Simulation> s = OneStepSimFactory::createRandomSimulation();
+        const double v = 0.1 * double( m_created++ % 11 );
+        for( unsigned int l = 1; l < s->getNetwork()->getNumberOfLayer(); l++ )
+        {
+            s->getNetwork()->getLayer(l)->setWeight( v );
+            s->getNetwork()->getLayer(l)->setBias( -v );
+        }
+        return s;
+    }
+
+    bool isThreadSafe() const override { return m_threadSafe; }
+
+    std::atomic<size_t> m_created{0};
+    bool m_threadSafe;
+};
+
+TEST(Evolution, ParallelBreedDeterministic)
+{
+    std::vector<std::vector<NNMatrix>> results;
+
+    for( unsigned int nbrOfThreads : {1u, 3u, 4u} )
+    {
+        // the thread safe factory creates the offspring in the breed job
+        std::shared_ptr<DeterministicSimFactory> f( new DeterministicSimFactory( nbrOfThreads == 4 ) );
+        Evolution e( 30, 150, f, nbrOfThreads );
+        e.setSeed( 2024 );
+        e.setMutationRate( 0.05 );
+
+        e.doEpoch();
+        e.breed();
+        e.doEpoch();
+        e.breed();
+
+        // the order of the offspring is the order of the population store
+        e.doEpoch();
+        std::vector<NNMatrix> weights;
+        for( SimulationPtr s : e.getSimulationsOrderedByFitness() )
+            weights.push_back( s->getNetwork()->getLayer(1)->getWeightMatrix() );
+
+        std::sort( weights.begin(), weights.end(), []( const NNMatrix& a, const NNMatrix& b ) {
+            return std::lexicographical_compare( a.data(), a.data() + a.size(), b.data(), b.data() + b.size() ); } );
+
+        ASSERT_EQ( weights.size(), 152 );
+        results.push_back( weights );
+    }
+
+    for( size_t k = 0; k < results[0].size(); k++ )
+    {
+        ASSERT_TRUE( results[0][k] == results[1][k] );
+        ASSERT_TRUE( results[0][k] == results[2][k] );
+    }
+}
+
 TEST(Evolution, SaveAndLoad)
 {
     std::shared_ptr<OneStepSimFactory> f(new OneStepSimFactory());
@@ -181,4 +282,229 @@ TEST(Evolution, SaveAndLoad)
 
     delete e;
     delete q;
-}
\ No newline at end of file
+}
+
+// Lives a different number of steps, depending on its index.
+class CountingSimulation: public Simulation
+{
+public:
+
+    CountingSimulation( size_t lifetime ) : m_lifetime( lifetime ), m_steps( 0 )
+    {
+        std::vector<unsigned int> map = {2,3,2};
+        m_network = NetworkPtr( new Network(map) );
+    }
+
+    size_t m_lifetime;
+    std::atomic<size_t> m_steps;
+
+protected:
+
+    void update() override
+    {
+        m_steps++;
+        if( m_steps >= m_lifetime )
+            m_alive = false;
+    }
+};
+
+class CountingSimFactory: public SimulationFactory
+{
+public:
+    std::shared_ptr<Simulation> createRandomSimulation() override
+    {
+        return std::shared_ptr<CountingSimulation>( new CountingSimulation( 1 + (m_created++ % 37) ) );
+    }
+
+    size_t m_created = 0;
+};
+
+TEST(Evolution, UnbalancedStepsOnWorkerPool)
+{
+    for( unsigned int threads : {1u, 3u, 8u} )
+    {
+        std::shared_ptr<CountingSimFactory> f( new CountingSimFactory() );
+        Evolution* e = new Evolution( 101, 10, f, threads );
+
+        size_t nbrOfSteps = 0;
+        while( !e->isEpochOver() )
+        {
+            e->doStep();
+            nbrOfSteps++;
+        }
+
+        // the last simulation died in step 37, the next step finds no alive one
+        ASSERT_EQ( nbrOfSteps, 38 );
+        ASSERT_EQ( e->getNumberAliveAndDead().first, 0 );
+
+        // every simulation was stepped exactly until it died
+        for( SimulationPtr s : e->getSimulationsOrderedByFitness() )
+        {
+            CountingSimulation* c = dynamic_cast<CountingSimulation*>( s.get() );
+            ASSERT_TRUE( c != nullptr );
+            ASSERT_EQ( c->m_steps.load(), c->m_lifetime );
+        }
+
+        delete e;
+    }
+}
+
+// Deterministic sense -> act simulation: the network output moves a point.
+class PointSimulation: public Simulation
+{
+public:
+
+    PointSimulation( const std::vector<unsigned int>& map, size_t lifetime ) : m_lifetime( lifetime )
+    {
+        m_network = NetworkPtr( new Network(map) );
+        m_state = Eigen::MatrixXd::Random( map.front(), 1 );
+    }
+
+    bool supportsSenseAct() const override { return true; }
+
+    void sense( Eigen::Ref<NNMatrix> input ) override
+    {
+        input = m_state.array().sin().matrix();
+    }
+
+    Eigen::MatrixXd m_state;
+    size_t m_lifetime;
+    size_t m_steps = 0;
+
+protected:
+
+    void actuate( const Eigen::Ref<const NNMatrix>& output ) override
+    {
+        for( long k = 0; k < m_state.rows(); k++ )
+            m_state(k,0) += output( k % output.rows(), 0 ) - 0.5;
+
+        if( ++m_steps >= m_lifetime )
+            m_alive = false;
+    }
+};
+
+class PointSimFactory: public SimulationFactory
+{
+public:
+    std::shared_ptr<Simulation> createRandomSimulation() override
+    {
+        // every 5th simulation has another network structure
+        std::vector<unsigned int> map = ( m_created % 5 == 0 ) ? std::vector<unsigned int>{3,2,2} : std::vector<unsigned int>{3,4,2};
+        return std::shared_ptr<Simulation>( new PointSimulation( map, 5 + (m_created++ % 23) ) );
+    }
+
+    size_t m_created = 0;
+};
+
+TEST(Evolution, BatchedInference)
+{
+    std::shared_ptr<PointSimFactory> f( new PointSimFactory() );
+    Evolution* batched = new Evolution( 60, 10, f, 3 );
+    ASSERT_TRUE( batched->isBatchedInferenceEnabled() );
+
+    // identical copies, stepped one by one
+    std::vector<SimulationPtr> sims = batched->getSimulationsOrderedByFitness();
+    std::vector<std::shared_ptr<PointSimulation>> reference;
+    for( SimulationPtr s : sims )
+    {
+        PointSimulation* p = dynamic_cast<PointSimulation*>( s.get() );
+        std::shared_ptr<PointSimulation> r( new PointSimulation( p->getNetwork()->getNetworkStructure(), p->m_lifetime ) );
+        r->setNetwork( p->getNetwork() );
+        r->m_state = p->m_state;
+        reference.push_back( r );
+    }
+
+    batched->doEpoch();
+    for( std::shared_ptr<PointSimulation>& r : reference )
+        while( r->isAlive() )
+            r->doStep();
+
+    for( size_t k = 0; k < sims.size(); k++ )
+    {
+        PointSimulation* p = dynamic_cast<PointSimulation*>( sims[k].get() );
+        ASSERT_EQ( p->m_steps, reference[k]->m_steps );
+        ASSERT_TRUE( p->m_state.isApprox( reference[k]->m_state, 1e-9 ) );
+    }
+
+    batched->setBatchedInference( false );
+    ASSERT_FALSE( batched->isBatchedInferenceEnabled() );
+
+    delete batched;
+}
+
+// Moves with the time step and dies after 2 simulated seconds.
+class TimedSimulation: public Simulation
+{
+public:
+    TimedSimulation()
+    {
+        m_network = NetworkPtr( new Network( {2,3,1} ) );
+    }
+
+    double getFitness() override { return m_distance; }
+
+    double m_distance = 0.0;
+
+protected:
+    void update() override
+    {
+        NNMatrix x( 2, 1 );
+        x << NNScalar( getAge() ), NNScalar( 1.0 );
+        m_network->feedForward( x, m_networkWorkspace );
+        m_distance += getTimeSinceLastUpdate() * double( m_networkWorkspace.getOutputActivation()(0,0) );
+
+        if( getAge() + getTimeSinceLastUpdate() > 2.0 - 1e-9 )
+            m_alive = false;
+    }
+};
+
+class TimedSimFactory: public SimulationFactory
+{
+public:
+    SimulationPtr createRandomSimulation() override
+    {
+        std::shared_ptr<TimedSimulation> s( new TimedSimulation() );
+        s->getNetwork()->getLayer(1)->setWeight( 0.1 * double( m_created % 13 ) );
+        s->getNetwork()->getLayer(2)->setWeight( 0.3 - 0.1 * double( m_created++ % 7 ) );
+        s->getNetwork()->getLayer(1)->setBias( 0.0 );
+        s->getNetwork()->getLayer(2)->setBias( 0.0 );
+        return s;
+    }
+
+    size_t m_created = 0;
+};
+
+TEST(Evolution, FixedTimeStep)
+{
+    std::vector<std::vector<double>> fitness;
+
+    for( int run = 0; run < 2; run++ )
+    {
+        Evolution e( 40, 40, std::shared_ptr<TimedSimFactory>( new TimedSimFactory() ), 2 );
+        e.setFixedTimeStep( 0.05 );
+        e.setSeed( 11 );
+        e.setMutationRate( 0.1 );
+        ASSERT_DOUBLE_EQ( e.getFixedTimeStep(), 0.05 );
+
+        std::vector<double> f;
+        for( int epoch = 0; epoch < 3; epoch++ )
+        {
+            e.doEpoch();
+
+            // 40 steps of 0.05 simulated seconds, no waiting
+            ASSERT_NEAR( e.getSimulationsAverageAge(), 2.0, 1e-9 );
+
+            for( SimulationPtr s : e.getSimulationsOrderedByFitness() )
+            {
+                ASSERT_DOUBLE_EQ( s->getFixedTimeStep(), 0.05 );
+                f.push_back( s->getFitness() );
+            }
+
+            e.breed();
+        }
+
+        fitness.push_back( f );
+    }
+
+    ASSERT_EQ( fitness[0], fitness[1] );
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "executor.h"
+
+TEST(ExecutorTest, RunsAllTasks)
+{
+    Executor executor( 3, 100 );
+    ASSERT_EQ( executor.getNbrOfThreads(), 3 );
+
+    std::atomic<int> sum( 0 );
+    std::vector< std::shared_future<void> > futures;
+    for( int i = 1; i <= 100; i++ )
+        futures.push_back( executor.submit( [&sum, i]() { sum += i; } ) );
+
+    for( std::shared_future<void>& f : futures )
+        f.wait();
+
+    ASSERT_EQ( sum, 5050 );
+    ASSERT_EQ( executor.getNbrOfQueuedTasks(), 0 );
+}
+
+TEST(ExecutorTest, BoundedQueue)
+{
+    Executor executor( 1, 2 );
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::shared_future<void> blocker = executor.submit( [released]() { released.wait(); } );
+
+    // wait until the blocker runs -> the queue is empty
+    while( executor.getNbrOfQueuedTasks() > 0 )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+    int counter = 0;
+    std::shared_future<void> f1, f2, f3;
+    ASSERT_TRUE( executor.trySubmit( [&counter]() { counter++; }, f1 ) );
+    ASSERT_TRUE( executor.trySubmit( [&counter]() { counter++; }, f2 ) );
+    ASSERT_FALSE( executor.trySubmit( [&counter]() { counter++; }, f3 ) ); // full
+    ASSERT_FALSE( f3.valid() );
+    ASSERT_EQ( executor.getNbrOfQueuedTasks(), 2 );
+
+    release.set_value();
+    f1.wait(); f2.wait();
+    ASSERT_EQ( counter, 2 );
+    ASSERT_EQ( blocker.wait_for( std::chrono::seconds( 0 ) ), std::future_status::ready );
+}
+
+TEST(ExecutorTest, Global)
+{
+    Executor& executor = Executor::global();
+    ASSERT_GE( executor.getNbrOfThreads(), 2 );
+    ASSERT_EQ( &executor, &Executor::global() );
+
+    bool done = false;
+    executor.submit( [&done]() { done = true; } ).wait();
+    ASSERT_TRUE( done );
+}
@@ -178,4 +178,118 @@ TEST(Genetic, CrossoverMutation)
         ASSERT_FALSE((l_a->getBiasVector() - l_c->getBiasVector()).isMuchSmallerThan(0.00001));
         ASSERT_FALSE((l_a->getWeightMatrix() - l_c->getWeightMatrix()).isMuchSmallerThan(0.00001));
     }
-}
\ No newline at end of file
+}
+TEST(Genetic, PopulationCrossover)
+{
+    Network a({10,8,4});
+    Network b({10,8,4});
+    a.getLayer(1)->setWeight(1.0);
+    a.getLayer(1)->setBias(2.0);
+    a.getLayer(2)->setWeight(3.0);
+    a.getLayer(2)->setBias(4.0);
+    b.getLayer(1)->setWeight(5.0);
+    b.getLayer(1)->setBias(6.0);
+    b.getLayer(2)->setWeight(7.0);
+    b.getLayer(2)->setBias(8.0);
+
+    Population parents;
+    ASSERT_TRUE( parents.setNetworks( {&a, &b} ) );
+
+    Population offspring;
+    offspring.setStructure( a );
+    offspring.resize( 50 );
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, offspring, Genetic::Uniform ) );
+
+    for( size_t l = 1; l <= offspring.getNumberOfLayers(); l++ )
+    {
+        const NNMatrix& w = offspring.weights(l);
+        const size_t cntA = (w.array() == parents.weights(l)(0,0)).count();
+        const size_t cntB = (w.array() == parents.weights(l)(1,0)).count();
+        ASSERT_EQ( cntA + cntB, w.size() );
+        ASSERT_NEAR( double(cntB) / double(cntA), 1.0, 0.2 );
+
+        const NNMatrix& bi = offspring.biases(l);
+        ASSERT_EQ( (bi.array() == parents.biases(l)(0,0)).count() + (bi.array() == parents.biases(l)(1,0)).count(), bi.size() );
+    }
+
+    // mutation
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, offspring, Genetic::Uniform, 0.1 ) );
+    const NNMatrix& w = offspring.weights(1);
+    const double mutated = w.size() - (w.array() == 1.0).count() - (w.array() == 5.0).count();
+    ASSERT_NEAR( mutated / w.size(), 0.1, 0.03 );
+
+    // invalid parents or structure
+    ASSERT_FALSE( Genetic::crossover( parents, 0, 2, offspring, Genetic::Uniform ) );
+    Population other;
+    other.setStructure( Network({10,4}) );
+    other.resize( 2 );
+    ASSERT_FALSE( Genetic::crossover( parents, 0, 1, other, Genetic::Uniform ) );
+}
+
+TEST(Genetic, SeededPopulationCrossover)
+{
+    Network a({12,9,3});
+    Network b({12,9,3});
+
+    Population parents;
+    ASSERT_TRUE( parents.setNetworks( {&a, &b} ) );
+
+    Population o1, o2, o3;
+    for( Population* o : {&o1, &o2, &o3} )
+    {
+        o->setStructure( a );
+        o->resize( 70 );
+    }
+
+    Xoshiro256 r1( 123 ), r2( 123 ), r3( 124 );
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, o1, Genetic::Uniform, 0.05, r1 ) );
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, o2, Genetic::Uniform, 0.05, r2 ) );
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, o3, Genetic::Uniform, 0.05, r3 ) );
+
+    for( size_t l = 1; l <= o1.getNumberOfLayers(); l++ )
+    {
+        ASSERT_TRUE( o1.weights(l) == o2.weights(l) );
+        ASSERT_TRUE( o1.biases(l) == o2.biases(l) );
+        ASSERT_FALSE( o1.weights(l) == o3.weights(l) );
+    }
+
+    // the thread generator is seedable too
+    Genetic::setSeed( 5 );
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, o1, Genetic::Uniform, 0.05 ) );
+    Genetic::setSeed( 5 );
+    ASSERT_TRUE( Genetic::crossover( parents, 0, 1, o2, Genetic::Uniform, 0.05 ) );
+    ASSERT_TRUE( o1.weights(1) == o2.weights(1) );
+}
+
+TEST(Genetic, PopulationMutate)
+{
+    Network a({30,20,10});
+    a.getLayer(1)->setWeight(1000.0);
+    a.getLayer(1)->setBias(1000.0);
+    a.getLayer(2)->setWeight(1000.0);
+    a.getLayer(2)->setBias(1000.0);
+
+    Population p;
+    p.setStructure( a );
+    p.resize( 100 );
+    for( size_t i = 0; i < 100; i++ )
+        p.setGenome( i, a );
+
+    Xoshiro256 rng( 9 );
+    Genetic::mutate( p, 0.0, rng );
+    ASSERT_EQ( (p.weights(1).array() == 1000.0).count(), p.weights(1).size() );
+
+    Genetic::mutate( p, 0.02, rng );
+    double mutated = 0.0;
+    double size = 0.0;
+    for( size_t l = 1; l <= p.getNumberOfLayers(); l++ )
+    {
+        mutated += (p.weights(l).array() != 1000.0).count() + (p.biases(l).array() != 1000.0).count();
+        size += p.weights(l).size() + p.biases(l).size();
+    }
+    ASSERT_NEAR( mutated / size, 0.02, 0.003 );
+
+    Genetic::mutate( p, 1.0, rng );
+    ASSERT_EQ( (p.weights(2).array() == 1000.0).count(), 0 );
+    ASSERT_LT( p.weights(2).cwiseAbs().maxCoeff(), 10.0 );
+}
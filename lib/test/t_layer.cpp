@@ -55,6 +55,19 @@ TEST(LayerTest, CopyConstructor)
     delete lcopy;
 }
 
+TEST(LayerTest, SerializationFormatIsDouble)
+{
+    // the file format does not depend on the scalar type the library is built with
+    Layer l( 3, 5 );
+    std::string serializedBuf = l.serialize();
+    ASSERT_EQ( serializedBuf.size(), 3*sizeof(unsigned int) + (3*5 + 3)*sizeof(double) );
+
+    Layer* lcopy = Layer::deserialize( serializedBuf );
+    ASSERT_TRUE( lcopy->getWeightMatrix().isApprox( l.getWeightMatrix() ) );
+    ASSERT_TRUE( lcopy->getBiasVector().isApprox( l.getBiasVector() ) );
+    delete lcopy;
+}
+
 TEST(LayerTest, Serialization)
 {
     Layer* l = new Layer(2,2,Layer::Softmax);
@@ -415,3 +428,75 @@ TEST(LayerTest, Regularization)
     delete l2;
 }
 
+
+TEST(LayerTest, PartialDerivativesSum)
+{
+    Layer* l = new Layer(3,4);
+
+    Eigen::MatrixXd x = Eigen::MatrixXd::Random(4,5);
+    Eigen::MatrixXd y = Eigen::MatrixXd::Random(3,5);
+
+    // default: only summed derivatives
+    ASSERT_FALSE( l->isPerSampleDerivativesEnabled() );
+    l->feedForward( x );
+    l->computeBackpropagationOutputLayerError( y );
+    l->computePartialDerivatives();
+    ASSERT_EQ( l->getPartialDerivativesBiases().size(), 0 );
+    ASSERT_EQ( l->getPartialDerivativesWeights().size(), 0 );
+
+    Eigen::MatrixXd biasSum = l->getPartialDerivativesBiasesSum();
+    Eigen::MatrixXd weightSum = l->getPartialDerivativesWeightsSum();
+    ASSERT_EQ( biasSum.rows(), 3 ); ASSERT_EQ( biasSum.cols(), 1 );
+    ASSERT_EQ( weightSum.rows(), 3 ); ASSERT_EQ( weightSum.cols(), 4 );
+
+    // debug: per sample derivatives sum up to the batched ones
+    l->setPerSampleDerivatives( true );
+    l->computePartialDerivatives();
+    ASSERT_EQ( l->getPartialDerivativesBiases().size(), 5 );
+    ASSERT_EQ( l->getPartialDerivativesWeights().size(), 5 );
+
+    Eigen::MatrixXd biasAccum = Eigen::MatrixXd::Zero(3,1);
+    Eigen::MatrixXd weightAccum = Eigen::MatrixXd::Zero(3,4);
+    for( size_t k = 0; k < 5; k++ )
+    {
+        biasAccum += l->getPartialDerivativesBiases().at(k);
+        weightAccum += l->getPartialDerivativesWeights().at(k);
+    }
+
+    ASSERT_TRUE( biasAccum.isApprox( biasSum, 0.000001 ) );
+    ASSERT_TRUE( weightAccum.isApprox( weightSum, 0.000001 ) );
+
+    delete l;
+}
+
+TEST(LayerTest, FusedFeedForwardTiles)
+{
+    // batches within one tile, over several tiles with a partial tile at the border, and empty
+    for( Layer::LayerOutputType type : { Layer::Sigmoid, Layer::Softmax } )
+    {
+        for( long nbrOfSamples : { 0, 1, 37, 300, 2500 } )
+        {
+            Layer* l = new Layer( 150, 70, type );
+            Eigen::MatrixXd x = Eigen::MatrixXd::Random( 70, nbrOfSamples );
+
+            ASSERT_TRUE( l->feedForward( x ) );
+
+            // reference: separate passes over the whole output
+            Eigen::MatrixXd z = l->getWeightMatrix() * x + l->getBiasVector().replicate( 1, nbrOfSamples );
+            Eigen::MatrixXd a( z.rows(), z.cols() );
+            for( long n = 0; n < z.cols(); n++ )
+            {
+                for( long m = 0; m < z.rows(); m++ )
+                    a(m,n) = type == Layer::Sigmoid ? Neuron::sigmoid( z(m,n) ) : std::exp( z(m,n) );
+
+                if( type == Layer::Softmax )
+                    a.col(n) /= a.col(n).sum();
+            }
+
+            ASSERT_TRUE( l->getWeightedInputZ().isApprox( z, 1e-12 ) );
+            ASSERT_TRUE( l->getOutputActivation().isApprox( a, 1e-12 ) );
+
+            delete l;
+        }
+    }
+}
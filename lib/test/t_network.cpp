@@ -23,6 +23,9 @@
 
 #include <random>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <cstdio>
 #include <unordered_set>
 
@@ -167,11 +170,11 @@ TEST(NetworkTest, Backpropagation_input)
         for( unsigned int q = 0; q < err.rows(); q++ )
             ASSERT_NEAR( err(q),  0.0, 0.0001 );
 
-        Eigen::VectorXd pd_biases = ll->getPartialDerivativesBiases().at(0);
+        Eigen::VectorXd pd_biases = ll->getPartialDerivativesBiasesSum();
         for( unsigned int q = 0; q < pd_biases.rows(); q++ )
             ASSERT_NEAR( pd_biases(q),  0.0, 0.0001 );
 
-        Eigen::MatrixXd pd_weights = ll->getPartialDerivativesWeights().at(0);
+        Eigen::MatrixXd pd_weights = ll->getPartialDerivativesWeightsSum();
         for( unsigned int q = 0; q < pd_weights.rows(); q++ )
             for( unsigned int p = 0; p < pd_weights.cols(); p++ )
                 ASSERT_NEAR( pd_weights(q,p),  0.0, 0.0001 );
@@ -208,10 +211,10 @@ TEST(NetworkTest, Backpropagation_Errors)
     ASSERT_NEAR( net->getNetworkErrorMagnitude(), 0.0, 0.00001 );
 
     // partial derivatives are [0.0, 0.0]
-    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesWeights().at(0)(0,0), 0.0, 0.0001 );
-    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesWeights().at(0)(1,0), 0.0, 0.0001 );
-    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesBiases().at(0)(0,0), 0.0, 0.0001 );
-    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesBiases().at(0)(1,0), 0.0, 0.0001 );
+    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesWeightsSum()(0,0), 0.0, 0.0001 );
+    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesWeightsSum()(1,0), 0.0, 0.0001 );
+    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesBiasesSum()(0,0), 0.0, 0.0001 );
+    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesBiasesSum()(1,0), 0.0, 0.0001 );
 
 
 
@@ -230,8 +233,8 @@ TEST(NetworkTest, Backpropagation_Errors)
     // expected errors and derivatives for neuron 0 is 0.0
     Eigen::VectorXd kx = net->getOutputLayer()->getBackpropagationError();
     ASSERT_NEAR( net->getOutputLayer()->getBackpropagationError()(0,0), 0.0, 0.0001 );
-    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesWeights().at(0)(0,0), 0.0, 0.0001 );
-    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesBiases().at(0)(0,0), 0.0, 0.0001 );
+    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesWeightsSum()(0,0), 0.0, 0.0001 );
+    ASSERT_NEAR( net->getOutputLayer()->getPartialDerivativesBiasesSum()(0,0), 0.0, 0.0001 );
 
     delete net;
 }
@@ -582,16 +585,24 @@ TEST(NetworkTest, Backpropagate_StochasticGD_Async)
     TestCallback2* tb = new TestCallback2();
     net->setObserver( tb );
 
+    // the executor is blocked until the first operation was checked to be in progress
+    Executor executor( 1, 4 );
+    net->setExecutor( &executor );
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    executor.submit( [released]() { released.wait(); } );
+
     ASSERT_TRUE( net->stochasticGradientDescentAsync( xin, yout, 100, 0.1, 1234 ) );
     ASSERT_FALSE( net->stochasticGradientDescentAsync( xin, yout, 100, 0.1, 1234 ) ); // since already async operation in progress;
     ASSERT_TRUE( net->isOperationInProgress() );
+    release.set_value();
 
-    net->getCurrentAsyncOperation().join(); // waits till thread ends
+    net->getCurrentAsyncOperation().wait(); // waits till operation ends
 
     ASSERT_EQ(tb->m_lastUserId, 1234);
 
     ASSERT_TRUE(net->stochasticGradientDescentAsync( xin, yout, 100, 0.1, 4321 ) ); // call a third time, now it should work again
-    net->getCurrentAsyncOperation().join(); // waits till thread ends
+    net->getCurrentAsyncOperation().wait(); // waits till operation ends
     ASSERT_EQ(tb->m_lastUserId, 4321);
 
     ASSERT_FALSE( net->isOperationInProgress() );
@@ -810,3 +821,455 @@ TEST(NetworkTest, UserID)
 
     delete net;
 }
+
+TEST(NetworkTest, MultiThreadedStochasticGD)
+{
+    std::vector<unsigned int> map = {8,12,6,4};
+    Network* serial = new Network(map);
+    serial->setRegularizationMethod( std::shared_ptr<Regularization>( new Regularization(Regularization::RegularizationMethod::WeightDecay, 0.1 )) );
+
+    Network* parallel = new Network( *serial );
+    ASSERT_EQ( parallel->getNumberOfThreads(), 1 );
+    parallel->setNumberOfThreads( 4 );
+    ASSERT_EQ( parallel->getNumberOfThreads(), 4 );
+
+    std::vector<Eigen::MatrixXd> samples; std::vector<Eigen::MatrixXd> lables;
+    for( int k = 0; k < 37; k++ )
+    {
+        samples.push_back( Eigen::MatrixXd::Random(8,1) );
+        lables.push_back( (Eigen::MatrixXd::Random(4,1).array() + 1.0) * 0.5 );
+    }
+
+    // The whole data set is one batch -> the shuffling only changes the summation order
+    for( int epoch = 0; epoch < 5; epoch++ )
+    {
+        ASSERT_TRUE( serial->stochasticGradientDescent( samples, lables, 37, 1.0 ) );
+        ASSERT_TRUE( parallel->stochasticGradientDescent( samples, lables, 37, 1.0 ) );
+
+        ASSERT_NEAR( serial->getNetworkCost(), parallel->getNetworkCost(), 1e-9 );
+    }
+
+    for( unsigned int k = 1; k < serial->getNumberOfLayer(); k++ )
+    {
+        ASSERT_TRUE( serial->getLayer(k)->getWeightMatrix().isApprox( parallel->getLayer(k)->getWeightMatrix(), 1e-9 ) );
+        ASSERT_TRUE( serial->getLayer(k)->getBiasVector().isApprox( parallel->getLayer(k)->getBiasVector(), 1e-9 ) );
+    }
+
+    // more threads than samples in a batch
+    parallel->setNumberOfThreads( 6 );
+    ASSERT_TRUE( parallel->stochasticGradientDescent( samples, lables, 3, 1.0 ) );
+
+    // copy keeps thread count
+    Network* copy = new Network( *parallel );
+    ASSERT_EQ( copy->getNumberOfThreads(), 6 );
+
+    delete serial;
+    delete parallel;
+    delete copy;
+}
+
+TEST(NetworkTest, DatasetStochasticGDAndTest)
+{
+    std::vector<unsigned int> map = {8,12,4};
+    Network* fromVectors = new Network(map);
+    Network* fromDataset = new Network( *fromVectors );
+
+    std::vector<Eigen::MatrixXd> samples; std::vector<Eigen::MatrixXd> lables;
+    for( int k = 0; k < 29; k++ )
+    {
+        samples.push_back( Eigen::MatrixXd::Random(8,1) );
+        lables.push_back( (Eigen::MatrixXd::Random(4,1).array() + 1.0) * 0.5 );
+    }
+    Dataset dataset( samples, lables );
+
+    // The whole data set is one batch -> the shuffling only changes the summation order
+    for( int epoch = 0; epoch < 5; epoch++ )
+    {
+        ASSERT_TRUE( fromVectors->stochasticGradientDescent( samples, lables, 29, 1.0 ) );
+        ASSERT_TRUE( fromDataset->stochasticGradientDescent( dataset, 29, 1.0 ) );
+        ASSERT_NEAR( fromVectors->getNetworkCost(), fromDataset->getNetworkCost(), 1e-9 );
+    }
+
+    for( unsigned int k = 1; k < fromVectors->getNumberOfLayer(); k++ )
+        ASSERT_TRUE( fromVectors->getLayer(k)->getWeightMatrix().isApprox( fromDataset->getLayer(k)->getWeightMatrix(), 1e-9 ) );
+
+    double rateEuclidean, rateMax, cost; std::vector<size_t> failed;
+    double rateEuclideanDs, rateMaxDs, costDs; std::vector<size_t> failedDs;
+    ASSERT_TRUE( fromVectors->testNetwork( samples, lables, 0.5, false, rateEuclidean, rateMax, cost, failed ) );
+    ASSERT_TRUE( fromVectors->testNetwork( dataset, 0.5, false, rateEuclideanDs, rateMaxDs, costDs, failedDs ) );
+    ASSERT_DOUBLE_EQ( rateEuclidean, rateEuclideanDs );
+    ASSERT_DOUBLE_EQ( rateMax, rateMaxDs );
+    ASSERT_NEAR( cost, costDs, 1e-12 );
+    ASSERT_EQ( failed, failedDs );
+
+    // batch size exceeds the number of samples
+    ASSERT_FALSE( fromDataset->stochasticGradientDescent( dataset, 30, 1.0 ) );
+    ASSERT_FALSE( fromDataset->stochasticGradientDescentHogwild( dataset, 0, 1.0 ) );
+    ASSERT_TRUE( fromDataset->stochasticGradientDescentHogwild( dataset, 5, 1.0 ) );
+
+    // asynchronous, the dataset storage is shared
+    ASSERT_TRUE( fromDataset->stochasticGradientDescentAsync( dataset, 5, 1.0, 7 ) );
+    fromDataset->getCurrentAsyncOperation().wait();
+    ASSERT_TRUE( fromDataset->testNetworkAsync( dataset, 0.5, 7 ) );
+    fromDataset->getCurrentAsyncOperation().wait();
+
+    delete fromVectors;
+    delete fromDataset;
+}
+
+class ThroughputCallback: public NetworkOperationCallback
+{
+public:
+    void networkOperationProgress( const NetworkOperationId& opId, const NetworkOperationStatus& status,
+                                   const double&, const int& ) override
+    {
+        m_lastOpId = opId;
+        m_lastStatus = status;
+    }
+
+    void networkTestResults( const double&, const double&, const double&, const std::vector<std::size_t>&, const int& ) override {}
+
+    void networkWorkerThroughput( const NetworkOperationId& opId, const std::vector<double>& samplesPerSecond, const int& ) override
+    {
+        m_throughputOpId = opId;
+        m_samplesPerSecond = samplesPerSecond;
+    }
+
+    NetworkOperationId m_lastOpId;
+    NetworkOperationStatus m_lastStatus;
+    NetworkOperationId m_throughputOpId;
+    std::vector<double> m_samplesPerSecond;
+};
+
+TEST(NetworkTest, Hogwild_StochasticGD)
+{
+    // recognize positive numbers and negative numbers with lock-free asynchronous updates
+    std::random_device rd;
+    std::mt19937 e2(rd());
+    std::uniform_real_distribution<> dist(-1, +1);
+
+    std::vector<Eigen::MatrixXd> xin;
+    std::vector<Eigen::MatrixXd> yout;
+    for( uint k = 0; k < 2000; k++ )
+    {
+        double value = dist(e2);
+        Eigen::MatrixXd thisSample(1,1);
+        Eigen::MatrixXd thisLable(2,1);
+
+        thisSample(0,0) = value;
+
+        if( value > 0 )
+            thisLable << 1.0, 0.0;
+        else
+            thisLable << 0.0, 1.0;
+
+        xin.push_back( thisSample );
+        yout.push_back( thisLable );
+    }
+
+    std::vector<unsigned int> map = {1,5,2};
+    Network* net = new Network(map);
+    net->setNumberOfThreads( 4 );
+
+    ThroughputCallback* tb = new ThroughputCallback();
+    net->setObserver( tb );
+
+    double bestResult = -1.0;
+    for( unsigned int epoch = 0; epoch < 30; epoch++ )
+    {
+        ASSERT_TRUE( net->stochasticGradientDescentHogwild( xin, yout, 10, 0.5 ) );
+
+        double successRateEuc; double successRateMaxIdx; double avgCost; std::vector<size_t> failedSamples;
+        net->testNetwork( xin, yout, 0.1, false, successRateEuc, successRateMaxIdx, avgCost, failedSamples );
+        bestResult = std::max( bestResult, successRateMaxIdx );
+    }
+
+    std::cout << "Best Result =  " << bestResult * 100 <<  "%" << std::endl;
+    ASSERT_GT( bestResult, 0.9 );
+
+    ASSERT_EQ( tb->m_lastOpId, NetworkOperationCallback::OpStochasticGradientDescentHogwild );
+    ASSERT_EQ( tb->m_lastStatus, NetworkOperationCallback::OpResultOk );
+    ASSERT_EQ( tb->m_throughputOpId, NetworkOperationCallback::OpStochasticGradientDescentHogwild );
+    ASSERT_EQ( tb->m_samplesPerSecond.size(), 4 );
+
+    double totalThroughput = 0.0;
+    for( double t : tb->m_samplesPerSecond )
+        totalThroughput += t;
+    ASSERT_GT( totalThroughput, 0.0 );
+
+    // wrong batch size
+    ASSERT_FALSE( net->stochasticGradientDescentHogwild( xin, yout, 3000, 0.5 ) );
+    ASSERT_EQ( tb->m_lastStatus, NetworkOperationCallback::OpResultErr );
+
+    delete net;
+    delete tb;
+}
+
+TEST(NetworkTest, ConstFeedForwardConcurrent)
+{
+    std::vector<unsigned int> map = {6,10,4};
+    Network* net = new Network(map);
+    net->setSoftmaxOutput( true );
+
+    const unsigned int nbrOfThreads = 4;
+    std::vector<Eigen::MatrixXd> inputs;
+    std::vector<Eigen::MatrixXd> expected;
+    for( unsigned int t = 0; t < nbrOfThreads; t++ )
+    {
+        inputs.push_back( Eigen::MatrixXd::Random(6, t+1) );
+        ASSERT_TRUE( net->feedForward( inputs.back() ) );
+        expected.push_back( net->getOutputActivation() );
+    }
+
+    // own state of the network stays untouched by the const feedforward
+    const Eigen::MatrixXd lastOwnOutput = net->getOutputActivation();
+
+    const Network& constNet = *net;
+    std::vector<bool> success( nbrOfThreads, true );
+    std::vector<std::thread> threads;
+    for( unsigned int t = 0; t < nbrOfThreads; t++ )
+    {
+        threads.push_back( std::thread( [&constNet, &inputs, &expected, &success, t]()
+        {
+            NetworkWorkspace ws = constNet.createWorkspace( long(t+1) );
+            for( int i = 0; i < 200; i++ )
+            {
+                if( !constNet.feedForward( inputs[t], ws ) || !ws.getOutputActivation().isApprox( expected[t] ) )
+                    success[t] = false;
+            }
+        } ) );
+    }
+
+    for( std::thread& th : threads )
+        th.join();
+
+    for( unsigned int t = 0; t < nbrOfThreads; t++ )
+        ASSERT_TRUE( success[t] );
+
+    ASSERT_TRUE( net->getOutputActivation().isApprox( lastOwnOutput ) );
+
+    // input size mismatch
+    NetworkWorkspace ws;
+    ASSERT_FALSE( constNet.feedForward( Eigen::MatrixXd::Random(5,1), ws ) );
+
+    delete net;
+}
+
+TEST(NetworkTest, BatchPrefetchingAndTransform)
+{
+    std::vector<unsigned int> map = {6,10,3};
+    Network* serial = new Network(map);
+    Network* prefetched = new Network( *serial );
+    prefetched->setBatchPrefetching( true );
+    ASSERT_TRUE( prefetched->isBatchPrefetchingEnabled() );
+    ASSERT_FALSE( serial->isBatchPrefetchingEnabled() );
+
+    std::vector<Eigen::MatrixXd> samples; std::vector<Eigen::MatrixXd> lables;
+    for( int k = 0; k < 24; k++ )
+    {
+        samples.push_back( Eigen::MatrixXd::Random(6,1) * 4.0 );
+        lables.push_back( (Eigen::MatrixXd::Random(3,1).array() + 1.0) * 0.5 );
+    }
+    Dataset dataset( samples, lables );
+
+    // normalization, counts the transformed batches
+    std::atomic<int> nbrOfTransforms( 0 );
+    Network::BatchTransform scale = [&nbrOfTransforms]( NNMatrix& batch_in, NNMatrix& )
+    {
+        batch_in *= 0.25;
+        nbrOfTransforms++;
+    };
+    serial->setBatchTransform( scale );
+    prefetched->setBatchTransform( scale );
+
+    // The whole data set is one batch -> the shuffling only changes the summation order
+    for( int epoch = 0; epoch < 5; epoch++ )
+    {
+        ASSERT_TRUE( serial->stochasticGradientDescent( dataset, 24, 1.0 ) );
+        ASSERT_TRUE( prefetched->stochasticGradientDescent( dataset, 24, 1.0 ) );
+    }
+    ASSERT_EQ( nbrOfTransforms, 10 );
+
+    for( unsigned int k = 1; k < serial->getNumberOfLayer(); k++ )
+        ASSERT_TRUE( serial->getLayer(k)->getWeightMatrix().isApprox( prefetched->getLayer(k)->getWeightMatrix(), 1e-9 ) );
+
+    // the transform was applied: the input activation of the last batch is scaled
+    ASSERT_LE( prefetched->getLayer(1)->getInputActivation().cwiseAbs().maxCoeff(), 1.0 + 1e-12 );
+
+    // several batches per epoch, the copy keeps the settings
+    Network* copy = new Network( *prefetched );
+    ASSERT_TRUE( copy->isBatchPrefetchingEnabled() );
+    nbrOfTransforms = 0;
+    ASSERT_TRUE( copy->stochasticGradientDescent( samples, lables, 5, 1.0 ) );
+    ASSERT_EQ( nbrOfTransforms, 4 );
+
+    // transform in the Hogwild! workers
+    nbrOfTransforms = 0;
+    copy->setNumberOfThreads( 2 );
+    ASSERT_TRUE( copy->stochasticGradientDescentHogwild( dataset, 6, 1.0 ) );
+    ASSERT_EQ( nbrOfTransforms, 4 );
+
+    delete serial;
+    delete prefetched;
+    delete copy;
+}
+
+TEST(NetworkTest, AsyncSharedSamples)
+{
+    std::vector<unsigned int> map = {5,7,2};
+    Network* net = new Network(map);
+    Network* reference = new Network( *net );
+
+    std::shared_ptr<std::vector<Eigen::MatrixXd>> samples = std::make_shared<std::vector<Eigen::MatrixXd>>();
+    std::shared_ptr<std::vector<Eigen::MatrixXd>> lables = std::make_shared<std::vector<Eigen::MatrixXd>>();
+    for( int k = 0; k < 12; k++ )
+    {
+        samples->push_back( Eigen::MatrixXd::Random(5,1) );
+        lables->push_back( (Eigen::MatrixXd::Random(2,1).array() + 1.0) * 0.5 );
+    }
+
+    // one batch -> same result as the synchronous call
+    ASSERT_TRUE( net->stochasticGradientDescentAsync( samples, lables, 12, 1.0, 3 ) );
+    net->getCurrentAsyncOperation().wait();
+    ASSERT_TRUE( reference->stochasticGradientDescent( *samples, *lables, 12, 1.0 ) );
+
+    for( unsigned int k = 1; k < net->getNumberOfLayer(); k++ )
+        ASSERT_TRUE( net->getLayer(k)->getWeightMatrix().isApprox( reference->getLayer(k)->getWeightMatrix(), 1e-9 ) );
+
+    ASSERT_TRUE( net->testNetworkAsync( samples, lables, 0.5, 3 ) );
+    net->getCurrentAsyncOperation().wait();
+
+    // the computation thread released the shared samples, nothing was copied
+    ASSERT_EQ( samples.use_count(), 1 );
+    ASSERT_EQ( lables.use_count(), 1 );
+
+    ASSERT_FALSE( net->testNetworkAsync( nullptr, lables, 0.5, 3 ) );
+
+    delete net;
+    delete reference;
+}
+
+TEST(NetworkTest, AsyncCancelAndBackPressure)
+{
+    std::vector<unsigned int> map = {4,6,2};
+    Network* net = new Network(map);
+    const Eigen::MatrixXd weightsBefore = net->getLayer(1)->getWeightMatrix();
+
+    TestCallback2* tb = new TestCallback2();
+    net->setObserver( tb );
+
+    Dataset dataset( Eigen::MatrixXd::Random(4, 50), ( Eigen::MatrixXd::Random(2, 50).array() + 1.0 ) * 0.5 );
+
+    // one thread, which is blocked -> the network operation stays queued
+    Executor executor( 1, 1 );
+    net->setExecutor( &executor );
+    ASSERT_EQ( net->getExecutor(), &executor );
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    executor.submit( [released]() { released.wait(); } );
+    while( executor.getNbrOfQueuedTasks() > 0 )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+    ASSERT_TRUE( net->stochasticGradientDescentAsync( dataset, 5, 1.0, 11 ) );
+    ASSERT_TRUE( net->isOperationInProgress() );
+
+    // queue is full -> another network is refused
+    Network* other = new Network( *net );
+    ASSERT_FALSE( other->testNetworkAsync( dataset, 0.5, 12 ) );
+    ASSERT_FALSE( other->isOperationInProgress() );
+
+    // cancelled before it started
+    net->cancelAsyncOperation();
+    release.set_value();
+    net->getCurrentAsyncOperation().wait();
+
+    ASSERT_FALSE( net->isOperationInProgress() );
+    ASSERT_EQ( tb->m_lastStatus, NetworkOperationCallback::OpResultCancelled );
+    ASSERT_TRUE( net->getLayer(1)->getWeightMatrix().isApprox( weightsBefore ) );
+
+    // the next operation is not affected by the former cancel request
+    ASSERT_TRUE( net->stochasticGradientDescentAsync( dataset, 5, 1.0, 11 ) );
+    net->getCurrentAsyncOperation().wait();
+    ASSERT_EQ( tb->m_lastStatus, NetworkOperationCallback::OpResultOk );
+    ASSERT_FALSE( net->getLayer(1)->getWeightMatrix().isApprox( weightsBefore ) );
+
+    ASSERT_TRUE( other->testNetworkAsync( dataset, 0.5, 12 ) );
+    other->getCurrentAsyncOperation().wait();
+    ASSERT_TRUE( net->stochasticGradientDescent( dataset, 5, 1.0 ) );
+
+    // the destructor cancels and waits
+    ASSERT_TRUE( net->stochasticGradientDescentAsync( dataset, 1, 1.0, 11 ) );
+    delete net;
+    delete other;
+    delete tb;
+}
+
+TEST(NetworkTest, BatchedParallelTestNetwork)
+{
+    std::vector<unsigned int> map = {6,9,4};
+    Network* net = new Network(map);
+    net->setCostFunction( Network::CrossEntropy );
+
+    // not a multiple of the test batch size
+    std::vector<Eigen::MatrixXd> samples; std::vector<Eigen::MatrixXd> lables;
+    for( int k = 0; k < 1000; k++ )
+    {
+        samples.push_back( Eigen::MatrixXd::Random(6,1) * 3.0 );
+        Eigen::MatrixXd l = Eigen::MatrixXd::Zero(4,1);
+        l( k % 4, 0 ) = 1.0;
+        lables.push_back( l );
+    }
+    Dataset dataset( samples, lables );
+
+    // per sample reference
+    double refEuclidean = 0.0, refMax = 0.0, refCost = 0.0; std::vector<size_t> refFailed;
+    Network* ref = new Network( *net );
+    for( size_t t = 0; t < samples.size(); t++ )
+    {
+        ASSERT_TRUE( ref->feedForward( samples[t] ) );
+        ref->getOutputLayer()->computeBackpropagationOutputLayerError( lables[t] );
+        refCost += ref->getOutputLayer()->getCost();
+
+        Eigen::MatrixXd out = ref->getOutputActivation();
+        if( (out - lables[t]).norm() < 0.7 )
+            refEuclidean += 1.0;
+
+        unsigned long out_m, exp_m, n; double maxElem;
+        Helpers::maxElement( out, out_m, n, maxElem );
+        Helpers::maxElement( lables[t], exp_m, n, maxElem );
+        if( out_m == exp_m )
+            refMax += 1.0;
+        else
+            refFailed.push_back( t );
+    }
+    refEuclidean /= 1000.0; refMax /= 1000.0; refCost /= 1000.0;
+
+    for( unsigned int threads : {1u, 3u} )
+    {
+        net->setNumberOfThreads( threads );
+
+        double rateEuclidean, rateMax, cost; std::vector<size_t> failed;
+        ASSERT_TRUE( net->testNetwork( samples, lables, 0.7, false, rateEuclidean, rateMax, cost, failed ) );
+        ASSERT_DOUBLE_EQ( rateEuclidean, refEuclidean );
+        ASSERT_DOUBLE_EQ( rateMax, refMax );
+        ASSERT_NEAR( cost, refCost, 1e-9 );
+        ASSERT_EQ( failed, refFailed );
+
+        ASSERT_TRUE( net->testNetwork( dataset, 0.7, false, rateEuclidean, rateMax, cost, failed ) );
+        ASSERT_DOUBLE_EQ( rateEuclidean, refEuclidean );
+        ASSERT_DOUBLE_EQ( rateMax, refMax );
+        ASSERT_NEAR( cost, refCost, 1e-9 );
+        ASSERT_EQ( failed, refFailed );
+    }
+
+    // dimension mismatch
+    double rateEuclidean, rateMax, cost; std::vector<size_t> failed;
+    samples[17] = Eigen::MatrixXd::Random(5,1);
+    ASSERT_FALSE( net->testNetwork( samples, lables, 0.7, false, rateEuclidean, rateMax, cost, failed ) );
+    ASSERT_FALSE( net->testNetwork( Dataset( Eigen::MatrixXd::Random(5,10), Eigen::MatrixXd::Random(4,10) ), 0.7, false,
+                                    rateEuclidean, rateMax, cost, failed ) );
+
+    delete net;
+    delete ref;
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <memory>
+#include "networkstack.h"
+#include "network.h"
+
+TEST(NetworkStackTest, EqualsSeparateFeedForward)
+{
+    for( bool softmax : {false, true} )
+    {
+        std::vector<std::shared_ptr<Network>> nets;
+        std::vector<const Network*> netPtrs;
+        for( int i = 0; i < 37; i++ )
+        {
+            nets.push_back( std::shared_ptr<Network>( new Network( {8,5,3} ) ) );
+            nets.back()->setSoftmaxOutput( softmax );
+            netPtrs.push_back( nets.back().get() );
+        }
+
+        NetworkStack stack;
+        ASSERT_TRUE( stack.setNetworks( netPtrs ) );
+        ASSERT_EQ( stack.getNumberOfNetworks(), 37 );
+        ASSERT_EQ( stack.getNetworkStructure(), nets[0]->getNetworkStructure() );
+
+        Eigen::MatrixXd x = Eigen::MatrixXd::Random( 8, 37 );
+        ASSERT_TRUE( stack.feedForward( x ) );
+        ASSERT_EQ( stack.getOutputActivation().rows(), 3 );
+        ASSERT_EQ( stack.getOutputActivation().cols(), 37 );
+
+        for( int i = 0; i < 37; i++ )
+        {
+            ASSERT_TRUE( nets[i]->feedForward( x.col(i) ) );
+            ASSERT_TRUE( stack.getOutputActivation().col(i).isApprox( nets[i]->getOutputActivation(), 1e-12 ) );
+        }
+
+        // wrong number of columns
+        ASSERT_FALSE( stack.feedForward( Eigen::MatrixXd::Random( 8, 36 ) ) );
+    }
+}
+
+TEST(NetworkStackTest, StructureMismatch)
+{
+    Network a( {4,3,2} );
+    Network b( {4,2,2} );
+    Network c( {4,3,2} );
+    c.setSoftmaxOutput( true );
+
+    ASSERT_FALSE( NetworkStack::isSameStructure( a, b ) );
+    ASSERT_FALSE( NetworkStack::isSameStructure( a, c ) );
+
+    NetworkStack stack;
+    ASSERT_FALSE( stack.setNetworks( { &a, &b } ) );
+    ASSERT_EQ( stack.getNumberOfNetworks(), 0 );
+    ASSERT_FALSE( stack.feedForward( Eigen::MatrixXd::Random( 4, 2 ) ) );
+
+    ASSERT_TRUE( stack.setNetworks( {} ) );
+    ASSERT_EQ( stack.getNumberOfNetworks(), 0 );
+}
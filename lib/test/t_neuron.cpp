@@ -49,3 +49,27 @@ TEST(NeuronTest, D_Sigmoid)
     ASSERT_NEAR( f(2), 0.0, 0.0001 );
 }
 
+
+TEST(NeuronTest, SigmoidMatrix)
+{
+    Eigen::MatrixXd z = Eigen::MatrixXd::Random(7, 5) * 20.0;
+    z(0,0) = -800.0; z(1,0) = 800.0; // exp overflow
+
+    Eigen::MatrixXd a( z.rows(), z.cols() );
+    Neuron::sigmoid( z, a );
+
+    for( long m = 0; m < z.rows(); m++ )
+        for( long n = 0; n < z.cols(); n++ )
+            ASSERT_NEAR( a(m,n), Neuron::sigmoid( z(m,n) ), 1e-12 );
+
+    // in place
+    Neuron::sigmoid( z, z );
+    ASSERT_TRUE( z.isApprox( a ) );
+
+    // derivative from vectorized sigmoid matches the scalar one
+    Eigen::MatrixXd x = Eigen::MatrixXd::Random(4, 3) * 5.0;
+    Eigen::MatrixXd d = Neuron::d_sigmoid( x );
+    for( long m = 0; m < x.rows(); m++ )
+        for( long n = 0; n < x.cols(); n++ )
+            ASSERT_NEAR( d(m,n), Neuron::d_sigmoid( x(m,n) ), 1e-12 );
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <memory>
+#include "population.h"
+#include "network.h"
+
+TEST(PopulationTest, SetAndCreateNetworks)
+{
+    std::vector<std::shared_ptr<Network>> nets;
+    std::vector<const Network*> netPtrs;
+    for( int i = 0; i < 5; i++ )
+    {
+        nets.push_back( std::shared_ptr<Network>( new Network( {6,4,3} ) ) );
+        nets.back()->setSoftmaxOutput( true );
+        netPtrs.push_back( nets.back().get() );
+    }
+
+    Population p;
+    ASSERT_TRUE( p.setNetworks( netPtrs ) );
+    ASSERT_EQ( p.getNumberOfIndividuals(), 5 );
+    ASSERT_EQ( p.getNumberOfLayers(), 2 );
+    ASSERT_EQ( p.getNetworkStructure(), nets[0]->getNetworkStructure() );
+    ASSERT_EQ( p.weights(1).rows(), 5 );
+    ASSERT_EQ( p.weights(1).cols(), 6*4 );
+    ASSERT_EQ( p.biases(2).cols(), 3 );
+    ASSERT_EQ( p.getLayerType(2), Layer::Softmax );
+
+    // weight (j,k) in column j * nbrOfInputs + k
+    ASSERT_EQ( p.weights(1)(3, 2*6+5), nets[3]->getLayer(1)->getWeightMatrix()(2,5) );
+    ASSERT_EQ( p.biases(2)(4, 1), nets[4]->getLayer(2)->getBiasVector()(1) );
+
+    for( size_t i = 0; i < 5; i++ )
+    {
+        NetworkPtr n = p.createNetwork( i );
+        ASSERT_TRUE( n->isSoftmaxOutputEnabled() );
+        for( unsigned int l = 1; l < n->getNumberOfLayer(); l++ )
+        {
+            ASSERT_TRUE( n->getLayer(l)->getWeightMatrix() == nets[i]->getLayer(l)->getWeightMatrix() );
+            ASSERT_TRUE( n->getLayer(l)->getBiasVector() == nets[i]->getLayer(l)->getBiasVector() );
+        }
+    }
+
+    ASSERT_TRUE( p.createNetwork( 5 ).get() == nullptr );
+
+    // mismatching networks
+    Network other( {6,5,3} );
+    ASSERT_FALSE( p.setGenome( 0, other ) );
+    ASSERT_FALSE( p.setNetworks( { netPtrs[0], &other } ) );
+    ASSERT_EQ( p.getNumberOfIndividuals(), 0 );
+}
+
+TEST(PopulationTest, GatherCopyResize)
+{
+    std::vector<std::shared_ptr<Network>> nets;
+    std::vector<const Network*> netPtrs;
+    for( int i = 0; i < 4; i++ )
+    {
+        nets.push_back( std::shared_ptr<Network>( new Network( {3,2} ) ) );
+        netPtrs.push_back( nets.back().get() );
+    }
+
+    Population p;
+    ASSERT_TRUE( p.setNetworks( netPtrs ) );
+
+    Population g;
+    g.gather( p, {3, 1, 3} );
+    ASSERT_EQ( g.getNumberOfIndividuals(), 3 );
+    ASSERT_TRUE( g.weights(1).row(0) == p.weights(1).row(3) );
+    ASSERT_TRUE( g.weights(1).row(1) == p.weights(1).row(1) );
+    ASSERT_TRUE( g.biases(1).row(2) == p.biases(1).row(3) );
+
+    g.resize( 5 );
+    ASSERT_EQ( g.getNumberOfIndividuals(), 5 );
+    ASSERT_TRUE( g.weights(1).row(1) == p.weights(1).row(1) );
+    ASSERT_TRUE( g.copyGenome( p, 2, 4 ) );
+    ASSERT_TRUE( g.weights(1).row(4) == p.weights(1).row(2) );
+    ASSERT_FALSE( g.copyGenome( p, 4, 0 ) );
+
+    Network n( {3,2} );
+    ASSERT_TRUE( g.getGenome( 4, n ) );
+    ASSERT_TRUE( n.getLayer(1)->getWeightMatrix() == nets[2]->getLayer(1)->getWeightMatrix() );
+}
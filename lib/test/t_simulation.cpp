@@ -45,3 +45,26 @@ TEST(Simulation, TimeElapsed)
 }
 
 
+
+TEST(Simulation, FixedTimeStep)
+{
+    auto s = new Simulation();
+    s->setFixedTimeStep(0.01);
+    ASSERT_DOUBLE_EQ(s->getFixedTimeStep(), 0.01);
+
+    // independent of the wall clock
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_DOUBLE_EQ(s->getTimeSinceLastUpdate(), 0.01);
+
+    for(int k = 0; k < 1000; k++ )
+        s->doStep();
+
+    ASSERT_NEAR(s->getAge(), 10.0, 1e-9);
+    ASSERT_DOUBLE_EQ(s->getTimeSinceLastUpdate(), 0.01);
+
+    // back to the wall clock
+    s->setFixedTimeStep(0.0);
+    ASSERT_NEAR(s->getTimeSinceLastUpdate(), 0.0, 0.05);
+
+    delete s;
+}
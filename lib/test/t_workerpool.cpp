@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "workerpool.h"
+
+TEST(WorkerPoolTest, RunOnAllWorkers)
+{
+    WorkerPool pool( 4 );
+    ASSERT_EQ( pool.getNbrOfWorkers(), 4 );
+
+    std::vector<int> calls( 4, 0 );
+    std::function<void(const unsigned int&)> job = [&calls]( const unsigned int& w ) { calls[w]++; };
+
+    for( int i = 0; i < 100; i++ )
+        pool.run( job );
+
+    for( int c : calls )
+        ASSERT_EQ( c, 100 );
+}
+
+TEST(WorkerPoolTest, RunBlocksUntilDone)
+{
+    WorkerPool pool( 3 );
+    std::atomic<long> sum( 0 );
+
+    for( long i = 1; i <= 50; i++ )
+    {
+        pool.run( [&sum, i]( const unsigned int& w ) { sum += i * long(w+1); } );
+        ASSERT_EQ( sum, 6 * i * (i+1) / 2 ); // (1+2+3) * i
+    }
+}
+
+TEST(WorkerPoolTest, SingleWorker)
+{
+    WorkerPool pool( 0 ); // at least the calling thread
+    ASSERT_EQ( pool.getNbrOfWorkers(), 1 );
+
+    int calls = 0;
+    pool.run( [&calls]( const unsigned int& w ) { calls++; ASSERT_EQ( w, 0 ); } );
+    ASSERT_EQ( calls, 1 );
+}
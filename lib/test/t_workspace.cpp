@@ -0,0 +1,222 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <atomic>
+#include "network.h"
+#include "layer.h"
+#include "workspace.h"
+
+// Counts heap allocations by interposing malloc. Eigen allocates its
+// dynamic matrices with malloc, so does operator new in libstdc++.
+// Sanitizers intercept malloc themselves, so counting is disabled then.
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define EIDNN_SANITIZER_BUILD
+#endif
+
+#if defined(__GLIBC__) && !defined(EIDNN_SANITIZER_BUILD)
+
+extern "C" void* __libc_malloc( size_t size );
+extern "C" void* __libc_calloc( size_t n, size_t size );
+extern "C" void* __libc_realloc( void* ptr, size_t size );
+
+static std::atomic<bool> s_countAllocations( false );
+static std::atomic<size_t> s_nbrOfAllocations( 0 );
+
+extern "C" void* malloc( size_t size )
+{
+    if( s_countAllocations )
+        s_nbrOfAllocations++;
+    return __libc_malloc( size );
+}
+
+extern "C" void* calloc( size_t n, size_t size )
+{
+    if( s_countAllocations )
+        s_nbrOfAllocations++;
+    return __libc_calloc( n, size );
+}
+
+extern "C" void* realloc( void* ptr, size_t size )
+{
+    if( s_countAllocations )
+        s_nbrOfAllocations++;
+    return __libc_realloc( ptr, size );
+}
+
+#define ALLOCATION_COUNTING_AVAILABLE
+#endif
+
+static void startCountingAllocations()
+{
+#ifdef ALLOCATION_COUNTING_AVAILABLE
+    s_nbrOfAllocations = 0;
+    s_countAllocations = true;
+#endif
+}
+
+static size_t stopCountingAllocations()
+{
+#ifdef ALLOCATION_COUNTING_AVAILABLE
+    s_countAllocations = false;
+    return s_nbrOfAllocations;
+#else
+    return 0;
+#endif
+}
+
+
+TEST(WorkspaceTest, ReserveAndBatchSize)
+{
+    LayerWorkspace ws;
+    ws.reserve( 3, 2, 10 );
+    ASSERT_EQ( ws.getMaxBatchSize(), 10 );
+
+    ws.setBatchSize( 4 );
+    ASSERT_EQ( ws.getBatchSize(), 4 );
+    ASSERT_EQ( ws.getOutputActivation().rows(), 3 );
+    ASSERT_EQ( ws.getOutputActivation().cols(), 4 );
+    ASSERT_EQ( ws.getInputActivation().rows(), 2 );
+
+    // reserving less keeps the buffers
+    ws.reserve( 3, 2, 5 );
+    ASSERT_EQ( ws.getMaxBatchSize(), 10 );
+    ASSERT_EQ( ws.getBatchSize(), 4 );
+
+    ws.reserve( 3, 2, 20 );
+    ASSERT_EQ( ws.getMaxBatchSize(), 20 );
+
+    // layer dimension changed
+    ws.reserve( 4, 2, 5 );
+    ASSERT_EQ( ws.getMaxBatchSize(), 5 );
+    ASSERT_EQ( ws.getPartialDerivativesWeightsSum().rows(), 4 );
+    ASSERT_EQ( ws.getPartialDerivativesWeightsSum().cols(), 2 );
+}
+
+TEST(WorkspaceTest, LayerFeedForwardExternalWorkspace)
+{
+    Layer* l = new Layer( 3, 2 );
+    Eigen::MatrixXd x = Eigen::MatrixXd::Random( 2, 5 );
+
+    ASSERT_TRUE( l->feedForward( x ) );
+    const Eigen::MatrixXd own = l->getOutputActivation();
+
+    // external workspace gives same result and does not touch layer's own
+    LayerWorkspace ws;
+    ASSERT_TRUE( l->feedForward( x.leftCols(3), ws ) );
+    ASSERT_TRUE( ws.getOutputActivation().isApprox( own.leftCols(3) ) );
+    ASSERT_EQ( l->getOutputActivation().cols(), 5 );
+
+    delete l;
+}
+
+TEST(WorkspaceTest, AllocationCounter)
+{
+#ifndef ALLOCATION_COUNTING_AVAILABLE
+    GTEST_SKIP() << "Allocation counting requires glibc";
+#endif
+
+    startCountingAllocations();
+    Eigen::MatrixXd m = Eigen::MatrixXd::Random( 20, 20 );
+    size_t nbrOfAllocations = stopCountingAllocations();
+
+    ASSERT_GT( nbrOfAllocations, 0 );
+    ASSERT_GT( m.size(), 0 );
+}
+
+TEST(WorkspaceTest, NoAllocationFeedForwardAndBackprop)
+{
+#ifndef ALLOCATION_COUNTING_AVAILABLE
+    GTEST_SKIP() << "Allocation counting requires glibc";
+#endif
+
+    std::vector<unsigned int> map = { 64, 32, 16, 10 };
+
+    for( bool softmax : { false, true } )
+    {
+        Network* net = new Network( map );
+        net->setSoftmaxOutput( softmax );
+        net->setCostFunction( softmax ? Network::CrossEntropy : Network::Quadratic );
+
+        const long maxBatchSize = 32;
+        net->reserveWorkspace( maxBatchSize );
+
+        Eigen::MatrixXd x = Eigen::MatrixXd::Random( 64, maxBatchSize );
+        Eigen::MatrixXd y = Eigen::MatrixXd::Constant( 10, maxBatchSize, 0.1 );
+
+        startCountingAllocations();
+
+        for( int i = 0; i < 5; i++ )
+        {
+            // batch sizes within the reserved size
+            ASSERT_TRUE( net->gradientDescent( x, y, 0.1 ) );
+            ASSERT_TRUE( net->gradientDescent( x.leftCols(7), y.leftCols(7), 0.1 ) );
+            ASSERT_TRUE( net->feedForward( x.col(i) ) );
+            ASSERT_TRUE( net->feedForward( x ) );
+        }
+
+        size_t nbrOfAllocations = stopCountingAllocations();
+        ASSERT_EQ( nbrOfAllocations, 0 );
+
+        delete net;
+    }
+}
+
+TEST(WorkspaceTest, NoAllocationStochasticGradientDescent)
+{
+#ifndef ALLOCATION_COUNTING_AVAILABLE
+    GTEST_SKIP() << "Allocation counting requires glibc";
+#endif
+
+    std::vector<unsigned int> map = { 20, 15, 5 };
+    Network* net = new Network( map );
+
+    std::vector<Eigen::MatrixXd> samples; std::vector<Eigen::MatrixXd> lables;
+    for( int k = 0; k < 100; k++ )
+    {
+        samples.push_back( Eigen::MatrixXd::Random( 20, 1 ) );
+        lables.push_back( Eigen::MatrixXd::Constant( 5, 1, 0.5 ) );
+    }
+
+    // first epoch allocates the sample order and batch buffers
+    ASSERT_TRUE( net->stochasticGradientDescent( samples, lables, 10, 0.5 ) );
+
+    startCountingAllocations();
+    for( int epoch = 0; epoch < 3; epoch++ )
+        ASSERT_TRUE( net->stochasticGradientDescent( samples, lables, 10, 0.5 ) );
+    size_t nbrOfAllocations = stopCountingAllocations();
+
+    ASSERT_EQ( nbrOfAllocations, 0 );
+
+    // same with a contiguous dataset
+    Dataset dataset( samples, lables );
+    startCountingAllocations();
+    for( int epoch = 0; epoch < 3; epoch++ )
+        ASSERT_TRUE( net->stochasticGradientDescent( dataset, 10, 0.5 ) );
+    nbrOfAllocations = stopCountingAllocations();
+
+    ASSERT_EQ( nbrOfAllocations, 0 );
+
+    delete net;
+}
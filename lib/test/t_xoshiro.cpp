@@ -0,0 +1,87 @@
+/****************************************************************************
+** Copyright (c) 2017 Adrian Schneider
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+**
+*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <random>
+#include "xoshiro.h"
+
+TEST(XoshiroTest, Reproducible)
+{
+    Xoshiro256 a( 42 );
+    Xoshiro256 b( 42 );
+    Xoshiro256 c( 43 );
+
+    bool differs = false;
+    for( int i = 0; i < 100; i++ )
+    {
+        const uint64_t x = a();
+        ASSERT_EQ( x, b() );
+        differs |= x != c();
+    }
+    ASSERT_TRUE( differs );
+
+    a.seed( 7 );
+    b.seed( 7 );
+    ASSERT_EQ( a(), b() );
+
+    // jumped stream differs
+    b.jump();
+    ASSERT_NE( a(), b() );
+}
+
+TEST(XoshiroTest, Distributions)
+{
+    Xoshiro256 rng( 1 );
+    const int n = 200000;
+
+    double sumU = 0.0;
+    double sumN = 0.0;
+    double sumN2 = 0.0;
+    size_t ones = 0;
+    for( int i = 0; i < n; i++ )
+    {
+        const double u = rng.uniform();
+        ASSERT_GE( u, 0.0 );
+        ASSERT_LT( u, 1.0 );
+        sumU += u;
+
+        const double z = rng.normal();
+        sumN += z;
+        sumN2 += z * z;
+
+        ones += __builtin_popcountll( rng() );
+    }
+
+    ASSERT_NEAR( sumU / n, 0.5, 0.01 );
+    ASSERT_NEAR( sumN / n, 0.0, 0.01 );
+    ASSERT_NEAR( sumN2 / n, 1.0, 0.02 );
+    ASSERT_NEAR( double(ones) / (64.0 * n), 0.5, 0.001 );
+
+    // usable with <random>
+    std::uniform_int_distribution<int> dist( 0, 9 );
+    for( int i = 0; i < 100; i++ )
+    {
+        const int v = dist( rng );
+        ASSERT_TRUE( v >= 0 && v <= 9 );
+    }
+}